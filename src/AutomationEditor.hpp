@@ -0,0 +1,382 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef AUTOMATIONEDITOR_HPP_
+#define AUTOMATIONEDITOR_HPP_
+
+#include "definitions.h"
+#include "AutomationLane.hpp"
+#include "BWidgets/Widget.hpp"
+#include "BWidgets/ValueWidget.hpp"
+#include "BWidgets/Label.hpp"
+#include "BWidgets/PopupListBox.hpp"
+#include "BWidgets/TextButton.hpp"
+#include "BWidgets/DrawingSurface.hpp"
+
+#ifdef LOCALEFILE
+#include LOCALEFILE
+#else
+#include "Locale_EN.hpp"
+#endif
+
+/*
+ * Popup editor for the automation lane of a sequencer channel. Left click
+ * or drag on the value surface sets step nodes, right click removes them.
+ * Value is set to 1.0 on apply and to -1.0 on cancel before the editor
+ * posts its close request.
+ */
+class AutomationEditor : public BWidgets::ValueWidget
+{
+public:
+	AutomationEditor ();
+	AutomationEditor (const double x, const double y, const double width, const double height,
+			  const std::string& name, const int ch, const int nrSteps, const AutomationLane& lane);
+
+	virtual void resize (double width, double height) override;
+	void setLane (const AutomationLane& lane);
+	AutomationLane getLane () const;
+	int getChannel () const;
+
+protected:
+	void szAutomationEditor ();
+	void drawValues ();
+	void updateWidgets ();
+	static void listboxValueChangedCallback (BEvents::Event* event);
+	static void buttonClickCallback (BEvents::Event* event);
+	static void valuesClickCallback (BEvents::Event* event);
+
+	BWidgets::Label titleLabel;
+	BWidgets::Label typeLabel;
+	BWidgets::PopupListBox typeListBox;
+	BWidgets::PopupListBox controllerListBox;
+	BWidgets::Label interpolationLabel;
+	BWidgets::PopupListBox interpolationListBox;
+	BWidgets::Label rateLabel;
+	BWidgets::PopupListBox rateListBox;
+	BWidgets::DrawingSurface valueSurface;
+	BWidgets::TextButton cancelButton;
+	BWidgets::TextButton applyButton;
+
+	int ch;
+	int nrSteps;
+	AutomationLane lane;
+
+	double sz;
+
+	BColors::Color ink = {0.0, 0.75, 0.2, 1.0};
+	BColors::ColorSet txColors = {{{0.0, 1.0, 0.4, 1.0}, {1.0, 1.0, 1.0, 1.0}, {0.0, 0.5, 0.0, 1.0}, {0.0, 0.0, 0.0, 0.0}}};
+	BColors::ColorSet bgColors = {{{0.15, 0.15, 0.15, 1.0}, {0.3, 0.3, 0.3, 1.0}, {0.05, 0.05, 0.05, 1.0}, {0.0, 0.0, 0.0, 1.0}}};
+	BStyles::Border border = {{ink, 1.0}, 0.0, 2.0, 0.0};
+	BStyles::Border menuBorder = {{BColors::darkgrey, 1.0}, 0.0, 0.0, 0.0};
+	BStyles::Border labelborder = {BStyles::noLine, 4.0, 0.0, 0.0};
+	BStyles::Fill editorBg = BStyles::Fill (BColors::Color (0.0, 0.0, 0.0, 0.9));
+	BStyles::Fill screenBg = BStyles::Fill (BColors::Color (0.0, 0.0, 0.0, 0.8));
+	BStyles::Fill menuBg = BStyles::Fill (BColors::Color (0.0, 0.0, 0.05, 1.0));
+	BStyles::Font ctLabelFont = BStyles::Font ("Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL, 12.0,
+						   BStyles::TEXT_ALIGN_CENTER, BStyles::TEXT_VALIGN_MIDDLE);
+	BStyles::Font lfLabelFont = BStyles::Font ("Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL, 12.0,
+						   BStyles::TEXT_ALIGN_LEFT, BStyles::TEXT_VALIGN_MIDDLE);
+	BStyles::StyleSet defaultStyles = {"default", {{"background", STYLEPTR (&BStyles::noFill)},
+					  {"border", STYLEPTR (&BStyles::noBorder)}}};
+	BStyles::StyleSet labelStyles = {"labels", {{"background", STYLEPTR (&BStyles::noFill)},
+						   {"border", STYLEPTR (&BStyles::noBorder)},
+						   {"textcolors", STYLEPTR (&txColors)},
+						   {"font", STYLEPTR (&ctLabelFont)}}};
+
+	BStyles::Theme theme = BStyles::Theme ({
+		defaultStyles,
+		{"automationeditor", 	{{"background", STYLEPTR (&editorBg)},
+					{"border", STYLEPTR (&border)}}},
+		{"widget", 		{{"uses", STYLEPTR (&defaultStyles)}}},
+		{"screen", 		{{"background", STYLEPTR (&screenBg)},
+					{"border", STYLEPTR (&menuBorder)}}},
+		{"ctlabel",	 	{{"uses", STYLEPTR (&labelStyles)},
+					 {"font", STYLEPTR (&ctLabelFont)}}},
+		{"lflabel",	 	{{"uses", STYLEPTR (&labelStyles)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"button", 		{{"font", STYLEPTR (&ctLabelFont)}}},
+		{"menu",	 	{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)}}},
+		{"menu/item",	 	{{"uses", STYLEPTR (&defaultStyles)},
+					 {"border", STYLEPTR (&labelborder)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"menu/button",	 	{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)},
+					 {"bgcolors", STYLEPTR (&bgColors)}}},
+		{"menu/listbox",	{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)}}},
+		{"menu/listbox/item",	{{"uses", STYLEPTR (&defaultStyles)},
+					 {"border", STYLEPTR (&labelborder)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"menu/listbox//button",{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)},
+					 {"bgcolors", STYLEPTR (&bgColors)}}}
+	});
+
+};
+
+AutomationEditor::AutomationEditor() : AutomationEditor (0, 0, 0, 0, "editor", 0, MAXSTEPS, AutomationLane ()) {}
+
+AutomationEditor::AutomationEditor (const double x, const double y, const double width, const double height,
+				    const std::string& name, const int ch, const int nrSteps, const AutomationLane& lane) :
+		BWidgets::ValueWidget (x, y, width, height, name, 0.0),
+		titleLabel (20, 10, 320, 20, "ctlabel", BSEQUENCER_LABEL_AUTOMATION " " BSEQUENCER_LABEL_CHANNEL " " + std::to_string (ch + 1)),
+		typeLabel (20, 40, 100, 20, "lflabel", BSEQUENCER_LABEL_TYPE),
+		typeListBox (120, 40, 120, 20, 120, 80, "menu",
+			     BItems::ItemList ({{AUTOMATION_OFF, BSEQUENCER_LABEL_OFF}, {AUTOMATION_CC, BSEQUENCER_LABEL_CC},
+						{AUTOMATION_PITCH_BEND, BSEQUENCER_LABEL_PITCH_BEND}, {AUTOMATION_AFTERTOUCH, BSEQUENCER_LABEL_AFTERTOUCH}}),
+			     AUTOMATION_OFF),
+		controllerListBox (),
+		interpolationLabel (20, 70, 100, 20, "lflabel", BSEQUENCER_LABEL_INTERPOLATION),
+		interpolationListBox (120, 70, 120, 20, 120, 60, "menu",
+				      BItems::ItemList ({{INTERPOLATION_STEP, BSEQUENCER_LABEL_STEP}, {INTERPOLATION_LINEAR, BSEQUENCER_LABEL_LINEAR},
+							 {INTERPOLATION_EXP, BSEQUENCER_LABEL_EXPONENTIAL}}),
+				      INTERPOLATION_LINEAR),
+		rateLabel (20, 100, 100, 20, "lflabel", BSEQUENCER_LABEL_RATE),
+		rateListBox (120, 100, 120, 20, 120, 140, "menu",
+			     BItems::ItemList ({{10, "10 Hz"}, {25, "25 Hz"}, {50, "50 Hz"}, {100, "100 Hz"}, {200, "200 Hz"}, {500, "500 Hz"}, {1000, "1000 Hz"}}),
+			     100),
+		valueSurface (20, 130, 320, 120, "screen"),
+		cancelButton (60, 265, 60, 20, "button", BSEQUENCER_LABEL_CANCEL),
+		applyButton (240, 265, 60, 20, "button", BSEQUENCER_LABEL_APPLY),
+		ch (ch), nrSteps (LIMIT (nrSteps, 1, MAXSTEPS)), lane (lane),
+		sz (width / 360 < height / 300 ? width / 360 : height / 300)
+
+{
+	setDraggable (true);
+	setFocusable (true);	// Only to block underlying pads callback
+	setStacking (BWidgets::STACKING_CATCH);
+
+	// Init controller list box
+	BItems::ItemList ccItems;
+	for (int i = 0; i < 128; ++i) ccItems.push_back (BItems::Item (i, "CC " + std::to_string (i)));
+	controllerListBox = BWidgets::PopupListBox (250, 40, 90, 20, 90, 240, "menu", ccItems, 1);
+	controllerListBox.rename ("menu");
+
+	typeListBox.setCallbackFunction (BEvents::VALUE_CHANGED_EVENT, listboxValueChangedCallback);
+	controllerListBox.setCallbackFunction (BEvents::VALUE_CHANGED_EVENT, listboxValueChangedCallback);
+	interpolationListBox.setCallbackFunction (BEvents::VALUE_CHANGED_EVENT, listboxValueChangedCallback);
+	rateListBox.setCallbackFunction (BEvents::VALUE_CHANGED_EVENT, listboxValueChangedCallback);
+	cancelButton.setCallbackFunction (BEvents::BUTTON_CLICK_EVENT, buttonClickCallback);
+	applyButton.setCallbackFunction (BEvents::BUTTON_CLICK_EVENT, buttonClickCallback);
+	valueSurface.setDraggable (true);
+	valueSurface.setCallbackFunction (BEvents::BUTTON_PRESS_EVENT, valuesClickCallback);
+	valueSurface.setCallbackFunction (BEvents::POINTER_DRAG_EVENT, valuesClickCallback);
+
+	titleLabel.applyTheme (theme);
+	typeLabel.applyTheme (theme);
+	typeListBox.applyTheme (theme);
+	controllerListBox.applyTheme (theme);
+	interpolationLabel.applyTheme (theme);
+	interpolationListBox.applyTheme (theme);
+	rateLabel.applyTheme (theme);
+	rateListBox.applyTheme (theme);
+	valueSurface.applyTheme (theme);
+	cancelButton.applyTheme (theme);
+	applyButton.applyTheme (theme);
+	applyTheme (theme);
+
+	add (titleLabel);
+	add (typeLabel);
+	add (typeListBox);
+	add (controllerListBox);
+	add (interpolationLabel);
+	add (interpolationListBox);
+	add (rateLabel);
+	add (rateListBox);
+	add (valueSurface);
+	add (cancelButton);
+	add (applyButton);
+
+	setLane (lane);
+
+	if (sz != 1.0) szAutomationEditor();
+}
+
+void AutomationEditor::resize (double width, double height)
+{
+	double wf = width / 360;
+	double hf = height / 300;
+	double newsz = (wf < hf ? wf : hf);
+	if (sz != newsz)
+	{
+		sz = newsz;
+		szAutomationEditor ();
+	}
+}
+
+void AutomationEditor::szAutomationEditor ()
+{
+	// Scale Fonts
+	ctLabelFont.setFontSize (12 * sz);
+	lfLabelFont.setFontSize (12 * sz);
+
+	titleLabel.moveTo (20 * sz, 10 * sz); titleLabel.resize (320 * sz, 20 * sz);
+	typeLabel.moveTo (20 * sz, 40 * sz); typeLabel.resize (100 * sz, 20 * sz);
+	typeListBox.moveTo (120 * sz, 40 * sz); typeListBox.resize (120 * sz, 20 * sz);
+	typeListBox.resizeListBox (BUtilities::Point (120 * sz, 80 * sz));
+	typeListBox.resizeListBoxItems (BUtilities::Point (120 * sz, 20 * sz));
+	controllerListBox.moveTo (250 * sz, 40 * sz); controllerListBox.resize (90 * sz, 20 * sz);
+	controllerListBox.resizeListBox (BUtilities::Point (90 * sz, 240 * sz));
+	controllerListBox.resizeListBoxItems (BUtilities::Point (90 * sz, 20 * sz));
+	interpolationLabel.moveTo (20 * sz, 70 * sz); interpolationLabel.resize (100 * sz, 20 * sz);
+	interpolationListBox.moveTo (120 * sz, 70 * sz); interpolationListBox.resize (120 * sz, 20 * sz);
+	interpolationListBox.resizeListBox (BUtilities::Point (120 * sz, 60 * sz));
+	interpolationListBox.resizeListBoxItems (BUtilities::Point (120 * sz, 20 * sz));
+	rateLabel.moveTo (20 * sz, 100 * sz); rateLabel.resize (100 * sz, 20 * sz);
+	rateListBox.moveTo (120 * sz, 100 * sz); rateListBox.resize (120 * sz, 20 * sz);
+	rateListBox.resizeListBox (BUtilities::Point (120 * sz, 140 * sz));
+	rateListBox.resizeListBoxItems (BUtilities::Point (120 * sz, 20 * sz));
+	valueSurface.moveTo (20 * sz, 130 * sz); valueSurface.resize (320 * sz, 120 * sz);
+	cancelButton.moveTo (60 * sz, 265 * sz); cancelButton.resize (60 * sz, 20 * sz);
+	applyButton.moveTo (240 * sz, 265 * sz); applyButton.resize (60 * sz, 20 * sz);
+
+	titleLabel.applyTheme (theme);
+	typeLabel.applyTheme (theme);
+	typeListBox.applyTheme (theme);
+	controllerListBox.applyTheme (theme);
+	interpolationLabel.applyTheme (theme);
+	interpolationListBox.applyTheme (theme);
+	rateLabel.applyTheme (theme);
+	rateListBox.applyTheme (theme);
+	valueSurface.applyTheme (theme);
+	cancelButton.applyTheme (theme);
+	applyButton.applyTheme (theme);
+
+	applyTheme (theme);
+	Widget::resize (360 * sz, 300 * sz);
+	drawValues ();
+}
+
+void AutomationEditor::setLane (const AutomationLane& lane)
+{
+	this->lane = lane;
+	typeListBox.setValue (lane.type);
+	controllerListBox.setValue (lane.controller);
+	interpolationListBox.setValue (lane.interpolation);
+	rateListBox.setValue (lane.rate);
+	updateWidgets ();
+	drawValues ();
+}
+
+AutomationLane AutomationEditor::getLane () const {return lane;}
+
+int AutomationEditor::getChannel () const {return ch;}
+
+void AutomationEditor::updateWidgets ()
+{
+	if (lane.type == AUTOMATION_CC) controllerListBox.show ();
+	else controllerListBox.hide ();
+}
+
+void AutomationEditor::drawValues ()
+{
+	cairo_surface_t* surface = valueSurface.getDrawingSurface();
+	cairo_surface_clear (surface);
+	const double x0 = valueSurface.getXOffset ();
+	const double y0 = valueSurface.getYOffset ();
+	const double width = valueSurface.getEffectiveWidth ();
+	const double height = valueSurface.getEffectiveHeight ();
+	const double w = width / nrSteps;
+	cairo_t* cr = cairo_create (surface);
+
+	// Step grid
+	cairo_set_line_width (cr, 1.0);
+	cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 0.1);
+	for (int i = 1; i < nrSteps; ++i)
+	{
+		cairo_move_to (cr, x0 + i * w, y0);
+		cairo_line_to (cr, x0 + i * w, y0 + height);
+	}
+	cairo_stroke (cr);
+
+	// Nodes
+	cairo_set_source_rgba (cr, CAIRO_RGBA (ink));
+	for (int i = 0; i < nrSteps; ++i)
+	{
+		if (lane.values[i] == NO_AUTOMATION_VALUE) continue;
+		const double h = lane.values[i] * height;
+		cairo_rectangle (cr, x0 + i * w + 1, y0 + height - h, w - 2, (h > 1 ? h : 1));
+	}
+	cairo_fill (cr);
+
+	cairo_destroy (cr);
+	valueSurface.update ();
+}
+
+void AutomationEditor::listboxValueChangedCallback (BEvents::Event* event)
+{
+	if ((!event) || (!event->getWidget()) || (!event->getWidget()->getParent())) return;
+
+	BWidgets::PopupListBox* listbox = (BWidgets::PopupListBox*)(event->getWidget());
+	AutomationEditor* editor = (AutomationEditor*)(listbox->getParent());
+	float value = ((BEvents::ValueChangedEvent*)event)->getValue ();
+
+	if (listbox == &editor->typeListBox) editor->lane.type = value;
+	else if (listbox == &editor->controllerListBox) editor->lane.controller = value;
+	else if (listbox == &editor->interpolationListBox) editor->lane.interpolation = value;
+	else if (listbox == &editor->rateListBox) editor->lane.rate = value;
+	editor->updateWidgets ();
+}
+
+void AutomationEditor::buttonClickCallback (BEvents::Event* event)
+{
+	if ((event) && (event->getEventType() == BEvents::BUTTON_CLICK_EVENT) && (event->getWidget()))
+	{
+		BWidgets::TextButton* button = (BWidgets::TextButton*) event->getWidget();
+		if (button->getParent())
+		{
+			AutomationEditor* editor = (AutomationEditor*)(button->getParent());
+
+			if (button == &(editor->cancelButton)) editor->setValue (-1.0);
+			else if (button == &(editor->applyButton)) editor->setValue (1.0);
+			editor->postCloseRequest ();
+		}
+	}
+}
+
+void AutomationEditor::valuesClickCallback (BEvents::Event* event)
+{
+	if ((!event) || (!event->getWidget()) || (!event->getWidget()->getParent())) return;
+
+	BWidgets::DrawingSurface* widget = (BWidgets::DrawingSurface*) event->getWidget ();
+	AutomationEditor* editor = (AutomationEditor*)(widget->getParent());
+	BEvents::PointerEvent* pointerEvent = (BEvents::PointerEvent*) event;
+
+	const double width = widget->getEffectiveWidth ();
+	const double height = widget->getEffectiveHeight ();
+	if ((width <= 0) || (height <= 0)) return;
+
+	int step = (pointerEvent->getPosition ().x - widget->getXOffset()) / (width / editor->nrSteps);
+	if ((step < 0) || (step >= editor->nrSteps)) return;
+
+	if (pointerEvent->getButton() == BDevices::LEFT_BUTTON)
+	{
+		double value = 1.0 - (pointerEvent->getPosition ().y - widget->getYOffset()) / height;
+		editor->lane.values[step] = LIMIT (value, 0.0, 1.0);
+	}
+	else if (pointerEvent->getButton() == BDevices::RIGHT_BUTTON) editor->lane.values[step] = NO_AUTOMATION_VALUE;
+
+	editor->drawValues ();
+}
+
+#endif /* AUTOMATIONEDITOR_HPP_ */
@@ -0,0 +1,61 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef AUTOMATIONLANE_HPP_
+#define AUTOMATIONLANE_HPP_
+
+#include "definitions.h"
+
+/*
+ * Automation lane of a sequencer channel: One node value (0..1) or
+ * NO_AUTOMATION_VALUE for each step. Values between the nodes are
+ * interpolated and sent rate times per second as CC, pitch bend or
+ * channel aftertouch messages.
+ */
+struct AutomationLane
+{
+	AutomationLane () : AutomationLane (AUTOMATION_OFF, 1, INTERPOLATION_LINEAR, 100) {}
+
+	AutomationLane (float type, float controller, float interpolation, float rate) :
+		type (type), controller (controller), interpolation (interpolation), rate (rate)
+	{
+		for (int i = 0; i < MAXSTEPS; ++i) values[i] = NO_AUTOMATION_VALUE;
+	}
+
+	bool operator== (const AutomationLane& that)
+	{
+		if ((type != that.type) || (controller != that.controller) || (interpolation != that.interpolation) || (rate != that.rate)) return false;
+		for (int i = 0; i < MAXSTEPS; ++i)
+		{
+			if (values[i] != that.values[i]) return false;
+		}
+		return true;
+	}
+
+	bool operator!= (const AutomationLane& that) {return (!operator== (that));}
+
+	float type;			// AutomationIndex
+	float controller;		// CC number (0..127), only used for AUTOMATION_CC
+	float interpolation;		// InterpolationIndex
+	float rate;			// Output messages per second (MIN_AUTOMATION_RATE..MAX_AUTOMATION_RATE)
+	float values[MAXSTEPS];		// Node values (0..1) or NO_AUTOMATION_VALUE
+};
+
+#endif /* AUTOMATIONLANE_HPP_ */
@@ -0,0 +1,37 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef AUTOMATIONMESSAGE_HPP_
+#define AUTOMATIONMESSAGE_HPP_
+
+#include "AutomationLane.hpp"
+
+struct AutomationMessage : AutomationLane
+{
+	AutomationMessage () : AutomationMessage (-1, AutomationLane ()) {}
+
+	AutomationMessage (float ch, AutomationLane lane) :
+		AutomationLane (lane), ch (ch)
+	{}
+
+	float ch;
+};
+
+#endif /* AUTOMATIONMESSAGE_HPP_ */
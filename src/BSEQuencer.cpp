@@ -23,23 +23,34 @@
 #include <ctime>
 #include "BUtilities/stof.hpp"
 
-BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features) :
-	map (NULL), unmap (NULL), inputPort (NULL), outputPort (NULL),
-	output_forge (), output_frame (),
-	new_controllers {nullptr}, controllers {0},
+#ifdef PRESETBANKFILE
+#include PRESETBANKFILE
+#endif
+
+BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features, const bool multiOut) :
+	map (NULL), unmap (NULL), inputPort (NULL), outputPort (NULL), notifyPort (NULL),
+	output_forge (), output_frame (), notify_forge (), notify_frame (),
+	multiOut (multiOut), midiOutputPorts {nullptr}, midi_forge (), midi_frame (),
+	controllerPorts {nullptr}, new_controllers {nullptr}, controllers {0},
+	patternCompiled {false}, pads (patterns[0]), padStarts (patternPadStarts[0]), padEnds (patternPadEnds[0]),
+	rows (patternRows[0]), activePattern (0),
+	pendingPattern (NO_PATTERN), pendingPatternPos (0.0), pendingPatternCut (false),
 	rate (samplerate), bpm (120.0f), beatsPerBar (4.0f), speed (0.0f),
 	outCapacity (0), position (0.0),
-	ui_on (false), scheduleNotifyPadsToGui (false), scheduleNotifyStatusToGui (false),
-	scheduleNotifyScaleMapsToGui (true),
+	ui_on (false), scheduleNotifyPadsToGui (false), scheduleNotifyRowsToGui (false), scheduleNotifyChainToGui (false),
+	scheduleNotifyAutomationToGui (false), scheduleNotifyStatusToGui (false),
+	scheduleNotifyScaleMapsToGui (true), scheduleNotifyControllersToGui (false),
 	defaultKey (), scale (60, defaultScale),
+	presetBank (), userBank (nullptr), userBankPath {0}, workerSchedule (nullptr),
 	distUni (0.0, 1.0), distBi (-1.0, 1.0)
 
 {
 	rnd.seed (time(0));
 
-	//Scan host features for URID map
+	//Scan host features for URID map and options
 	LV2_URID_Map* m = NULL;
 	LV2_URID_Unmap* u = NULL;
+	const LV2_Options_Option* options = NULL;
 	for (int i = 0; features[i]; ++i)
 	{
 		if (strcmp (features[i]->URI, LV2_URID__map) == 0)
@@ -50,6 +61,14 @@ BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features) :
 		{
 			u = (LV2_URID_Unmap*) features[i]->data;
 		}
+		else if (strcmp (features[i]->URI, LV2_OPTIONS__options) == 0)
+		{
+			options = (const LV2_Options_Option*) features[i]->data;
+		}
+		else if (strcmp (features[i]->URI, LV2_WORKER__schedule) == 0)
+		{
+			workerSchedule = (LV2_Worker_Schedule*) features[i]->data;
+		}
 	}
 
 	if (!m)
@@ -66,6 +85,8 @@ BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features) :
 
 	// Initialize notify
 	lv2_atom_forge_init (&output_forge, map);
+	lv2_atom_forge_init (&notify_forge, map);
+	for (int i = 0; i < NR_SEQUENCER_CHS; ++i) lv2_atom_forge_init (&midi_forge[i], map);
 
 	// Init scale maps
 	for (int scaleNr = 0; scaleNr < NR_SYSTEM_SCALES + NR_USER_SCALES; ++scaleNr)
@@ -73,15 +94,68 @@ BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features) :
 		rtScaleMaps[scaleNr] = defaultScaleMaps[scaleNr];
 	}
 
+	// Init built-in preset bank
+	for (int i = 0; i < KNOBS_SIZE; ++i)
+	{
+		bankControllers[i] = 0.0f;
+		controllerOverride[i] = false;
+		controllerOverrideBase[i] = 0.0f;
+	}
+#ifdef PRESETBANKFILE
+	presetBank.setData (presetBankData, sizeof (presetBankData));
+#endif
+
 	// Initialize padMessageBuffer
 	padMessageBuffer[0] = PadMessage (ENDPADMESSAGE);
+	padMessageCursor = 0;
+	padSyncPending = false;
+	padSyncRunning = false;
+
+	// Pad message payload per cycle from the host options (if set)
+	padMessageBytesPerCycle = PADMESSAGE_BYTES_PER_CYCLE;
+	if (options)
+	{
+		const LV2_URID key = map->map (map->handle, PADMESSAGE_BYTES_PER_CYCLE_OPTION);
+		for (int i = 0; options[i].key; ++i)
+		{
+			if ((options[i].key == key) && (options[i].type == uris.atom_Int))
+			{
+				const int32_t bytes = *((const int32_t*) options[i].value);
+				if (bytes > 0) padMessageBytesPerCycle = bytes;
+			}
+		}
+	}
+
+	// Init pattern chain: Each pattern repeats itself
+	for (int i = 0; i < NR_PATTERNS; ++i) patternChain[i] = NO_PATTERN;
+
+	// Init live recording
+	clearRecordedNotes ();
+
+	// Init automation output
+	for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
+	{
+		automationFrames[i] = 0;
+		automationValues[i] = -1;
+	}
+	invalidateAutomation ();
+
+	// Init groove: Straight timing
+	userGroove = defaultGrooves[GROOVE_USER];
+	controllers[SWING] = 50;
+	controllers[GROOVE] = GROOVE_OFF;
+	updateGroove ();
 
-	// Init defaultKey
+	// Init defaultKey: All rows start with the first step of the key
 	defaultKey.stepNr = -1;
+	defaultKey.ticks = TICKS_PER_STEP;
+	defaultKey.loop = 0;
+	defaultKey.conditionBits = getConditionBits (0);
 	for (int i = 0; i < MAXSTEPS; ++i)
 	{
 		defaultKey.output[i].direction = 1;
-		defaultKey.output[i].stepOffset = 0;
+		defaultKey.output[i].stepNr = -1;
+		defaultKey.output[i].ticks = TICKS_PER_STEP;
 	}
 
 
@@ -94,6 +168,11 @@ BSEQuencer::BSEQuencer (double samplerate, const LV2_Feature* const* features) :
 
 }
 
+BSEQuencer::~BSEQuencer ()
+{
+	if (userBank) delete userBank;
+}
+
 void BSEQuencer::connect_port (uint32_t port, void *data)
 {
 	switch (port) {
@@ -103,9 +182,19 @@ void BSEQuencer::connect_port (uint32_t port, void *data)
 	case OUTPUT:
 		outputPort = (LV2_Atom_Sequence*) data;
 		break;
+	case NOTIFY:
+		notifyPort = (LV2_Atom_Sequence*) data;
+		break;
 	default:
 		// Connect controllers
-		if ((port >= KNOBS) && (port < KNOBS + KNOBS_SIZE)) new_controllers[port - KNOBS] = (float*) data;
+		if ((port >= KNOBS) && (port < KNOBS + KNOBS_SIZE))
+		{
+			controllerPorts[port - KNOBS] = (float*) data;
+			if (!controllerOverride[port - KNOBS]) new_controllers[port - KNOBS] = (float*) data;
+		}
+
+		// Connect MIDI outputs (MultiOut variant)
+		else if (multiOut && (port >= MIDI_OUT) && (port < MIDI_OUT + NR_SEQUENCER_CHS)) midiOutputPorts[port - MIDI_OUT] = (LV2_Atom_Sequence*) data;
 	}
 }
 
@@ -155,8 +244,14 @@ void BSEQuencer::startMidiOut (const int64_t frames, const int key, const int ro
 		// Set sequencer channel
 		o.ch = (uint8_t (o.pad.ch) & 0x0F) - 1;
 
-		// Set / randomize gate
-		o.gate = (distUni (rnd) < o.pad.randGate);
+		// Set / randomize gate. Conditional and probability pads (except
+		// pre / not pre) store if they fired for the following pre
+		// conditions of the row.
+		const bool randGate = (distUni (rnd) < o.pad.randGate);
+		const bool condition = checkCondition (key, row);
+		o.gate = randGate && condition;
+		const int cond = LIMIT (int (o.pad.condition), 0, NR_CONDITIONS - 1);
+		if ((cond != COND_PRE) && (cond != COND_NOT_PRE) && ((cond != COND_NONE) || (o.pad.randGate < 1.0f))) o.preCondition = o.gate;
 
 		// Set / randomize note
 		int scaleNr = controllers[SCALE];
@@ -181,7 +276,7 @@ void BSEQuencer::startMidiOut (const int64_t frames, const int key, const int ro
 
 		// Set / randomize velocity
 		float padVelocity = o.pad.velocity + round (distBi (rnd) * o.pad.randVelocity);
-		float outVelocity = float (inKeys[key].velocity) * padVelocity * controllers[CH + o.ch * CH_SIZE + VELOCITY];
+		float outVelocity = float (inKeys[key].velocity) * padVelocity * controllers[CH + o.ch * CH_SIZE + VELOCITY] * grooveVelocityFactor (o.startPos);
 
 		o.velocity = LIMIT (outVelocity, 0, 127);
 
@@ -192,11 +287,70 @@ void BSEQuencer::startMidiOut (const int64_t frames, const int key, const int ro
 		float duration = o.pad.duration * (1 + distUni (rnd) * rd / dm);
 		o.duration = LIMIT (duration, 0.0, 32.0);
 
+		// Ratchets: Calculate the start positions of all sub-step notes
+		// (and the step end) once at the step start. Only for pads not
+		// extending to the next step.
+		o.ratchets = (o.duration <= 1.0f ? LIMIT (int (o.pad.ratchet), 1, MAX_RATCHETS) : 1);
+		o.ratchetNr = 0;
+		if (o.ratchets > 1)
+		{
+			const double stepSize = double (getRowTicks (row)) / (STEPS_PER_BEAT * TICKS_PER_STEP);
+			const double exponent = exp (LIMIT (o.pad.ratchetCurve, -1.0f, 1.0f));
+			for (int i = 0; i <= o.ratchets; ++i) o.ratchetPos[i] = o.startPos + stepSize * pow (double (i) / double (o.ratchets), exponent);
+		}
+
 		if (o.gate) midiStack.append (frames, o.ch, LV2_MIDI_MSG_NOTE_ON, o.note, o.velocity);
 		o.playing = true;
 	}
 }
 
+/*
+ * Restarts the actual note of a ratchet pad for the next sub-step
+ */
+void BSEQuencer::retriggerMidiOut (const int64_t frames, const int key, const int row)
+{
+	if ((key < 0) || (key >= ((int) inKeys.size))) return;
+
+	Output& o = inKeys[key].output[row];
+	if (o.playing) return;
+
+	if (o.gate) midiStack.append (frames, o.ch, LV2_MIDI_MSG_NOTE_ON, o.note, o.velocity);
+	o.playing = true;
+}
+
+/*
+ * Precalculates the loop dependent trig conditions as a bitmask (one bit
+ * per ConditionIndex). Called once per pattern loop of an inKey.
+ * @param loop	Loop counter (starting with 0)
+ * @return	Bitmask of all fulfilled loop conditions
+ */
+uint64_t BSEQuencer::getConditionBits (const int loop)
+{
+	uint64_t bits = (loop == 0 ? COND_BIT (COND_FIRST) : COND_BIT (COND_NOT_FIRST));
+	for (int b = 2; b <= MAX_CONDITION_LOOPS; ++b) bits |= COND_BIT (COND_LOOP ((loop % b) + 1, b));
+	return bits;
+}
+
+/*
+ * Checks the trig condition of the actual pad of an output. Loop conditions
+ * are taken from the precalculated inKey bitmask, fill and previous
+ * conditions are added.
+ * @return	True if the pad condition is fulfilled
+ */
+bool BSEQuencer::checkCondition (const int key, const int row)
+{
+	Key& k = inKeys[key];
+	Output& o = k.output[row];
+	const int cond = LIMIT (int (o.pad.condition), 0, NR_CONDITIONS - 1);
+	if (cond == COND_NONE) return true;
+
+	const uint64_t bits =
+		k.conditionBits |
+		(controllers[FILL] ? COND_BIT (COND_FILL) : COND_BIT (COND_NOT_FILL)) |
+		(o.preCondition ? COND_BIT (COND_PRE) : COND_BIT (COND_NOT_PRE));
+	return bits & COND_BIT (cond);
+}
+
 /*
  * Removes halted inKeys
  */
@@ -211,7 +365,7 @@ void BSEQuencer::cleanupInKeys ()
 			bool halted = true;
 			for (int row = 0; row < ROWS; ++row)
 			{
-				if ((**it).output[row].stepOffset < MAXSTEPS)
+				if ((**it).output[row].stepNr != HALT_STEP)
 				{
 					halted = false;
 					break;
@@ -252,7 +406,7 @@ void BSEQuencer::makeAutoKey (const uint64_t last_t)
 	if (inKeys[0].note != controllers[ROOT] + controllers[SIGNATURE] + (controllers[OCTAVE] + 1) * 12)
 	{
 		stopMidiOut (last_t, 0, ALL_CH);
-		inKeys[0] = defaultKey; // stepNr = -1; direction = 1; output.pads, output.playing and jumpOff ()-initialized
+		inKeys[0] = defaultKey; // output.stepNr = -1; direction = 1; output.pads, output.playing and jumpOff ()-initialized
 		inKeys[0].note = controllers[ROOT] + controllers[SIGNATURE] + (controllers[OCTAVE] + 1) * 12;
 		inKeys[0].velocity = 64;
 		inKeys[0].startPos = position + double (last_t) / FRAMES_PER_BEAT - (1 / STEPS_PER_BEAT);
@@ -270,225 +424,253 @@ void BSEQuencer::stopAutoKey (const uint64_t act_t)
 
 bool BSEQuencer::padHasAntecessor (const int row, const int step)
 {
-	return
-	(
-		(step > 0) &&
-		((int (pads[row][step].ch) & 0x0f) == (int (pads[row][step - 1].ch) & 0x0f)) &&
-		(pads[row][step - 1].duration > 1.0f)
-	);
+	return (padStarts[row][step] < step);
 }
 
 bool BSEQuencer::padHasSuccessor (const int row, const int step)
 {
-	return
-	(
-		(step < int (controllers[NR_OF_STEPS]) - 1) &&
-		((int (pads[row][step].ch) & 0x0f) == (int (pads[row][step + 1].ch) & 0x0f)) &&
-		(pads[row][step].duration > 1.0f)
-	);
+	return ((step < getRowLength (row) - 1) && (padEnds[row][step] > step));
 }
 
 int BSEQuencer::getPadStart (const int row, const int step)
 {
-	int s = step;
-	while (padHasAntecessor (row, s)) --s;
-	return s;
+	return padStarts[row][step];
 }
 
 int BSEQuencer::getNextPadStart (const int key, const int row, const int step)
 {
-	int nrsteps = controllers[NR_OF_STEPS];
+	int nrsteps = getRowLength (row);
 	int stepNr = step;
 
 	if (inKeys[key].output[row].direction < 0)
 	{
-		while (padHasAntecessor (row, stepNr)) --stepNr;
+		stepNr = padStarts[row][stepNr];
 		stepNr = (nrsteps + stepNr - 1) % nrsteps;
-		while (padHasAntecessor (row, stepNr)) --stepNr;
+		stepNr = padStarts[row][stepNr];
 	}
 
 	else
 	{
-		while (padHasSuccessor (row, stepNr)) ++stepNr;
+		// Tied pads end at the end of the row at the latest
+		if (stepNr < nrsteps - 1) stepNr = std::min (int (padEnds[row][stepNr]), nrsteps - 1);
 		stepNr = (stepNr + 1) % nrsteps;
 	}
 
 	return stepNr;
 }
 
+/*
+ * Precompiles the tied pad groups of a pattern for playback. A pad is tied
+ * to its successor if both use the same channel and its duration is longer
+ * than one step.
+ */
+void BSEQuencer::compilePattern (const int pattern)
+{
+	Pad (*p) [MAXSTEPS] = patterns[pattern];
+
+	for (int row = 0; row < ROWS; ++row)
+	{
+		uint8_t* starts = patternPadStarts[pattern][row];
+		uint8_t* ends = patternPadEnds[pattern][row];
+
+		starts[0] = 0;
+		for (int step = 1; step < MAXSTEPS; ++step)
+		{
+			const bool tied = ((int (p[row][step].ch) & 0x0f) == (int (p[row][step - 1].ch) & 0x0f)) && (p[row][step - 1].duration > 1.0f);
+			starts[step] = (tied ? starts[step - 1] : step);
+		}
+
+		ends[MAXSTEPS - 1] = MAXSTEPS - 1;
+		for (int step = MAXSTEPS - 2; step >= 0; --step)
+		{
+			ends[step] = (starts[step + 1] <= step ? ends[step + 1] : step);
+		}
+	}
+
+	patternCompiled[pattern] = true;
+}
+
+/*
+ * Marks all patterns to be precompiled again before they are played. Call
+ * after each change of the pads.
+ */
+void BSEQuencer::invalidatePatterns ()
+{
+	for (int p = 0; p < NR_PATTERNS; ++p) patternCompiled[p] = false;
+}
+
 int BSEQuencer::getNextStep (const int key, const int row, const int step)
 {
-	if (padHasSuccessor (row, step)) return (step + 1) % int (controllers[NR_OF_STEPS]);
+	if (padHasSuccessor (row, step)) return (step + 1) % getRowLength (row);
 	return getNextPadStart (key, row, step);
 }
 
 /*
- * Calculates a new position in steps from a starting position in steps and
- * position in beats relative to the starting position. Controls are not
- * interpreted.
- * @param key		Number of the respective inKey
- * @param relpos	Position relative to the inKey's startPos
- * @return			Returns the distance in steps relative to startPos
+ * Gets the effective number of steps of a row. Rows without an own length
+ * and rows longer than NR_OF_STEPS use NR_OF_STEPS.
  */
-double BSEQuencer::getStep (const int key, const double relpos)
+int BSEQuencer::getRowLength (const int row)
 {
-	double startStep = inKeys[key].stepNr;
-	double rawstep = startStep + STEPS_PER_BEAT * relpos;
+	int nrsteps = controllers[NR_OF_STEPS];
+	int length = rows[row].length;
+	return ((length >= 1) && (length < nrsteps) ? length : nrsteps);
+}
 
-	// Return "raw" negative step position for before-start events
-	if (rawstep <= 0.0) return rawstep;
-	else return fmod (rawstep, int (controllers[NR_OF_STEPS]));
+/*
+ * Gets the duration of a single step of a row in ticks
+ * (TICKS_PER_STEP ticks = one step of the sequencer clock).
+ */
+int BSEQuencer::getRowTicks (const int row)
+{
+	return TICKS_PER_STEP * int (rows[row].divider) / int (rows[row].multiplier);
 }
 
 /*
- * Once stepped, this method should be called. This method interprets the
- * controls and returns whether the controls additionally changed the step
- * position.
+ * Once a row is stepped, this method should be called. This method
+ * interprets the controls of the actual row step and returns the next step
+ * of the row.
  * @param key 		Number of the respective inKey
  * @param row		Number of the respective row
- * @return			Returns the change in steps as result of interpretation of
- * 					the controls.
+ * @return			Returns the next step number of the row.
  * 					Returns HALT_STEP if stepping is halted by the HALT
  * 					control.
  */
-int BSEQuencer::getStepOffset (const int key, const int row, const int relStep)
+int BSEQuencer::getNextRowStep (const int key, const int row)
 {
-	if (relStep <= 0) return 0;
+	Output& o = inKeys[key].output[row];
+	if (o.stepNr == HALT_STEP) return HALT_STEP;
+	if (o.stepNr < 0) return 0; // Always forward to the first step if not started yet
 
-	int nrsteps = controllers[NR_OF_STEPS];
-	int startStepNr = (inKeys[key].stepNr + inKeys[key].output[row].stepOffset) % nrsteps;
-	int endStepNr = startStepNr + relStep;
+	int nrsteps = getRowLength (row);
+	int stepNr = (o.stepNr < nrsteps ? o.stepNr : nrsteps - 1);
 
-	int stepNr = startStepNr;
-	for (int it = startStepNr; it < endStepNr; )
+	for (int i = 0; i <= nrsteps; ++i)
 	{
-		if (stepNr < 0)
-		{
-			++it;
-			++stepNr; // Always forward if stepNr negative
-		}
+		// 1. This step interpretation: At the end of each step, calculate the next step to jump to
 
-		else
-		{
-			// 1. This step interpretation: At the end of each step, calculate the next step to jump to
+		int stepctrl = int (pads[row][stepNr].ch) & 0xF0;
+		bool stepped = false;
 
-			int stepctrl = int (pads[row][stepNr].ch) & 0xF0;
-
-			if
+		if
+		(
+			(stepctrl != CTRL_STOP) &&
+			(stepctrl != CTRL_SKIP)
+		)
+		{
+			int padctrl =
 			(
-				(stepctrl != CTRL_STOP) &&
-				(stepctrl != CTRL_SKIP)
-			)
-			{
-				int padctrl =
-				(
-					padHasSuccessor (row, stepNr) ?
-					NO_CTRL :
-					int (pads[row][getPadStart (row, stepNr)].ch) & 0xF0
-				);
+				padHasSuccessor (row, stepNr) ?
+				NO_CTRL :
+				int (pads[row][getPadStart (row, stepNr)].ch) & 0xF0
+			);
 
-				if (padctrl == CTRL_JUMP_FWD)
+			if (padctrl == CTRL_JUMP_FWD)
+			{
+				if (!o.jumpOff[stepNr])
 				{
-					if (!inKeys[key].output[row].jumpOff[stepNr])
+					o.jumpOff[stepNr] = true;
+					stepNr = getPadStart (row, stepNr);
+					int newStepNr = stepNr;
+					for (int i = 1, jumpbackCount = 1; i < nrsteps; ++i)
 					{
-						inKeys[key].output[row].jumpOff[stepNr] = true;
-						stepNr = getPadStart (row, stepNr);
-						int newStepNr = stepNr;
-						for (int i = 1, jumpbackCount = 1; i < nrsteps; ++i)
+						newStepNr = (stepNr + i) % nrsteps;
+						int ch = int (pads[row][newStepNr].ch) & 0xF0;
+						if (ch == CTRL_JUMP_FWD) ++jumpbackCount;
+						if (ch == CTRL_ALL_MARK) break;
+						if (ch == CTRL_MARK)
 						{
-							newStepNr = (stepNr + i) % nrsteps;
-							int ch = int (pads[row][newStepNr].ch) & 0xF0;
-							if (ch == CTRL_JUMP_FWD) ++jumpbackCount;
-							if (ch == CTRL_ALL_MARK) break;
-							if (ch == CTRL_MARK)
-							{
-								--jumpbackCount;
-								if (jumpbackCount <= 0) break;
-							}
+							--jumpbackCount;
+							if (jumpbackCount <= 0) break;
 						}
-						stepNr = newStepNr;
 					}
-					else
-					{
-						inKeys[key].output[row].jumpOff[stepNr] = false;
-						stepNr = getNextStep (key, row, stepNr);
-					}
-					++it;
+					stepNr = newStepNr;
 				}
+				else
+				{
+					o.jumpOff[stepNr] = false;
+					stepNr = getNextStep (key, row, stepNr);
+				}
+			}
 
-				else if (padctrl == CTRL_JUMP_BACK)
+			else if (padctrl == CTRL_JUMP_BACK)
+			{
+				if (!o.jumpOff[stepNr])
 				{
-					if (!inKeys[key].output[row].jumpOff[stepNr])
+					o.jumpOff[stepNr] = true;
+					stepNr = getPadStart (row, stepNr);
+					int newStepNr = stepNr;
+					for (int i = 1, jumpbackCount = 1; i < nrsteps; ++i)
 					{
-						inKeys[key].output[row].jumpOff[stepNr] = true;
-						stepNr = getPadStart (row, stepNr);
-						int newStepNr = stepNr;
-						for (int i = 1, jumpbackCount = 1; i < nrsteps; ++i)
+						newStepNr = (i <= stepNr ? stepNr - i : stepNr + nrsteps - i);
+						int ch = int (pads[row][newStepNr].ch) & 0xF0;
+						if (ch == CTRL_JUMP_BACK) ++jumpbackCount;
+						if (ch == CTRL_ALL_MARK) break;
+						if (ch == CTRL_MARK)
 						{
-							newStepNr = (i <= stepNr ? stepNr - i : stepNr + nrsteps - i);
-							int ch = int (pads[row][newStepNr].ch) & 0xF0;
-							if (ch == CTRL_JUMP_BACK) ++jumpbackCount;
-							if (ch == CTRL_ALL_MARK) break;
-							if (ch == CTRL_MARK)
-							{
-								--jumpbackCount;
-								if (jumpbackCount <= 0) break;
-							}
+							--jumpbackCount;
+							if (jumpbackCount <= 0) break;
 						}
-						stepNr = newStepNr;
-					}
-					else
-					{
-						inKeys[key].output[row].jumpOff[stepNr] = false;
-						stepNr = getNextStep (key, row, stepNr);
 					}
-					++it;
+					stepNr = newStepNr;
 				}
-
 				else
 				{
-					if (padctrl ==CTRL_PLAY_FWD) inKeys[key].output[row].direction = 1;
-					else if (padctrl == CTRL_PLAY_REW) inKeys[key].output[row].direction = -1;
-
+					o.jumpOff[stepNr] = false;
 					stepNr = getNextStep (key, row, stepNr);
-					++it;
 				}
 			}
 
-			// 2. Next step interpretation: SKIP and HALT controls that need to be
-			// handled already at the begin of the next step.
-
-			// Update stepctrl as stepNr may be changed
-			stepctrl = int (pads[row][stepNr].ch) & 0xF0;
-
-			// CTRL_SKIP
-			for
-			(
-				int i = 0;
-				(i <= nrsteps) && ((int (pads[row][getPadStart (row, stepNr)].ch) & 0xF0) == CTRL_SKIP);
-				++i,
-				stepNr = getNextPadStart (key, row, stepNr)
-			)
+			else
 			{
-				// A whole loop of SKIPs => STOP
-				if (i == nrsteps) return HALT_STEP;
-			}
+				if (padctrl ==CTRL_PLAY_FWD) o.direction = 1;
+				else if (padctrl == CTRL_PLAY_REW) o.direction = -1;
 
-			// CTRL_STOP
-			if (stepctrl == CTRL_STOP)
-			{
-				return HALT_STEP;
+				stepNr = getNextStep (key, row, stepNr);
 			}
+
+			stepped = true;
+		}
+
+		// 2. Next step interpretation: SKIP and HALT controls that need to be
+		// handled already at the begin of the next step.
+
+		// Update stepctrl as stepNr may be changed
+		stepctrl = int (pads[row][stepNr].ch) & 0xF0;
+
+		// CTRL_SKIP
+		for
+		(
+			int i = 0;
+			(i <= nrsteps) && ((int (pads[row][getPadStart (row, stepNr)].ch) & 0xF0) == CTRL_SKIP);
+			++i,
+			stepNr = getNextPadStart (key, row, stepNr)
+		)
+		{
+			// A whole loop of SKIPs => STOP
+			if (i == nrsteps) return HALT_STEP;
+		}
+
+		// CTRL_STOP
+		if (stepctrl == CTRL_STOP)
+		{
+			return HALT_STEP;
 		}
+
+		if (stepped) return stepNr;
 	}
-	return stepNr - startStepNr - relStep;
-}
 
+	return HALT_STEP;
+}
 
 /* Core method for handling step sequencer
  * @param startpos: position (beat number) at @param start
  * @param start: start frame
  * @param end: end frame
+ *
+ * Positions are rounded to the nearest frame and an event belongs to this
+ * block only if its frame is before end. Thus events at block borders don't
+ * depend on the rounding errors of the block positions and the output is
+ * independent of the block size.
  */
 void BSEQuencer::runSequencer (const double startpos, const uint32_t start, const uint32_t end)
 {
@@ -498,143 +680,719 @@ void BSEQuencer::runSequencer (const double startpos, const uint32_t start, cons
 	if (VALUE_BPM > 0)
 	{
 		cleanupInKeys ();
-		double endpos = startpos + double (end - start) / FRAMES_PER_BEAT;
+		if (!patternCompiled[activePattern]) compilePattern (activePattern);
+		double ticksPerBeat = STEPS_PER_BEAT * TICKS_PER_STEP;
+
+		// Chain: Switch to the next pattern at the end of the actual pattern
+		int nextPattern = patternChain[activePattern];
+		if ((pendingPattern == NO_PATTERN) && (nextPattern != NO_PATTERN) && (nextPattern != activePattern) && (!inKeys.empty ()))
+		{
+			double chainpos = getPatternEndPos ();
+			if (getFrames (groovePos (chainpos), startpos, start) < end)
+			{
+				pendingPattern = nextPattern;
+				pendingPatternPos = chainpos;
+				pendingPatternCut = false;
+			}
+		}
+
+		// Pattern switch within this block: Split the block at the switch position
+		if ((pendingPattern != NO_PATTERN) && (getFrames (groovePos (pendingPatternPos), startpos, start) < end))
+		{
+			int64_t switchframes = getFrames (groovePos (pendingPatternPos), startpos, start);
+
+			// Switch position not after start (e.g., shifted backwards by
+			// a negative groove offset): Switch immediately, don't split
+			if (switchframes <= int64_t (start)) switchPattern (pendingPattern, start, pendingPatternPos, pendingPatternCut);
+
+			else
+			{
+				runSequencer (startpos, start, switchframes);
+				switchPattern (pendingPattern, switchframes, pendingPatternPos, pendingPatternCut);
+				runSequencer (startpos + double (switchframes - start) / FRAMES_PER_BEAT, switchframes, end);
+				return;
+			}
+		}
 
 		// Internal keyboard
 		for (int key = 0; key < int (inKeys.size); ++key)
 		{
-			double nextpos = endpos;
-			double lastpos = startpos;
+			Key& k = inKeys[key];
 
-			for (double actpos = startpos; actpos <= endpos; actpos = nextpos)
+			while (true)
 			{
-				int64_t actframes = LIMIT (start + (actpos - startpos) * FRAMES_PER_BEAT, start, end);
-				double actstep = getStep (key, actpos - inKeys[key].startPos);
-				int actStepNr = LIMIT (int (floor (actstep)), 0, int (controllers[NR_OF_STEPS]) - 1);
-				int oldStepNr = inKeys[key].stepNr;
-				double actStepFrac = actstep - actStepNr;
-
-				// Only present events
-				if (actstep >= 0)
+				// Find the next row clock tick or key step, skip halted rows
+				int nextTicks = k.ticks;
+				for (int row = 0; row < ROWS; ++row)
+				{
+					int ticks = k.output[row].ticks;
+					if ((k.output[row].stepNr != HALT_STEP) && (ticks < nextTicks)) nextTicks = ticks;
+				}
+
+				// Resync keys lagging behind (e.g., after a pause)
+				double nextpos = k.startPos + double (nextTicks) / ticksPerBeat;
+				if ((nextTicks != 0) && (startpos - nextpos > 1.0 / STEPS_PER_BEAT))
 				{
-					// Just stepped?
-					if (oldStepNr != actStepNr)
+					k.startPos += floor ((startpos - nextpos) * STEPS_PER_BEAT) / STEPS_PER_BEAT;
+					for (int row = 0; row < ROWS; ++row) k.output[row].startPos = k.startPos;
+					nextpos = k.startPos + double (nextTicks) / ticksPerBeat;
+				}
+
+				// Step positions are in the straight grid, the groove shifts
+				// the resulting times (positions in the host time)
+				double nextgroovepos = groovePos (nextpos);
+				const bool nextInBlock = (getFrames (nextgroovepos, startpos, start) < end);
+
+				// Scan pads and calculate note off position
+				for (int row = 0; row < ROWS; ++row)
+				{
+					Output& o = k.output[row];
+					if ((o.stepNr != HALT_STEP) && (o.playing) && (o.ratchets <= 1))
 					{
-						int nrsteps = controllers[NR_OF_STEPS];
+						double noteoffpos = groovePos (o.startPos + o.duration * getRowTicks (row) / ticksPerBeat);
+						// Note offs up to the next step (if in this block)
+						// or up to the end of the block
+						int64_t noteoffframes = getFrames (noteoffpos, startpos, start);
+						if (nextInBlock ? noteoffpos <= nextgroovepos : noteoffframes < end)
+						{
+							noteoffframes = LIMIT (noteoffframes, start, end);
+							stopMidiOut (noteoffframes, key, row, ALL_CH);
+						}
+					}
 
-						// Stop all output for the last step
-						//stopMidiOut (actframes, key, ALL_CH);
+					// Ratchets: Note off and restart at the precalculated
+					// sub-step positions. Each sub-step note is played for
+					// the pad duration fraction of the sub-step.
+					while ((o.stepNr != HALT_STEP) && (o.ratchets > 1) && (o.ratchetNr < o.ratchets))
+					{
+						if (o.playing)
+						{
+							double p0 = o.ratchetPos[o.ratchetNr];
+							double noteoffpos = groovePos (p0 + o.duration * (o.ratchetPos[o.ratchetNr + 1] - p0));
+							int64_t noteoffframes = getFrames (noteoffpos, startpos, start);
+							if (nextInBlock ? noteoffpos > nextgroovepos : noteoffframes >= end) break;
+							noteoffframes = LIMIT (noteoffframes, start, end);
+							stopMidiOut (noteoffframes, key, row, ALL_CH);
+						}
 
-						// Update all rows, if not halted before
-						for (int row = 0; row < ROWS; ++row)
+						if (o.ratchetNr + 1 >= o.ratchets)
 						{
-							int oldoffset = inKeys[key].output[row].stepOffset;
+							o.ratchets = 1;
+							break;
+						}
 
-							if (oldoffset != HALT_STEP)
-							{
-								int rawoffset = getStepOffset (key, row, STEPS_PER_BEAT * (actpos - inKeys[key].startPos));
-								if (rawoffset == HALT_STEP)
-								{
-									inKeys[key].output[row].stepOffset = HALT_STEP;
-									stopMidiOut (actframes, key, row, ALL_CH);
-								}
+						double noteonpos = groovePos (o.ratchetPos[o.ratchetNr + 1]);
+						int64_t noteonframes = getFrames (noteonpos, startpos, start);
+						if (nextInBlock ? noteonpos > nextgroovepos : noteonframes >= end) break;
+						noteonframes = LIMIT (noteonframes, start, end);
+						++o.ratchetNr;
+						retriggerMidiOut (noteonframes, key, row);
+					}
+				}
 
-								else
-								{
-									// Only positive offset values allowed
-									int newoffset =
-									(
-										rawoffset >= 0 ?
-										(oldoffset + rawoffset) % nrsteps :
-										(nrsteps + oldoffset + rawoffset) % nrsteps
-									);
+				// Row clock ticks in this block?
+				if ((nextTicks == 0) || (!nextInBlock)) break;
 
-									int newRowStepNr = (actStepNr + newoffset) % nrsteps;
-									int oldRowStepNr = (oldStepNr + oldoffset) % nrsteps;
-									inKeys[key].output[row].stepOffset = newoffset;
+				int64_t actframes = LIMIT (getFrames (nextgroovepos, startpos, start), start, end);
 
-									if
-									(
-										(newRowStepNr <= 0) ||
-										(newRowStepNr != oldRowStepNr + 1) ||
-										((int (pads[row][newRowStepNr].ch) & 0x0f) != (int (pads[row][oldRowStepNr].ch) & 0x0f)) ||
-										(pads[row][oldRowStepNr].duration <= 1.0f)
-									)
-									{
-										stopMidiOut (actframes, key, row, ALL_CH);
-
-										inKeys[key].output[row].pad = pads[row][newRowStepNr];
-										if (inKeys[key].note != 0xff) startMidiOut (actframes, key, row, ALL_CH);
-									}
+				// Update key steps (used for pattern switching)
+				k.ticks -= nextTicks;
+				if (k.ticks <= 0)
+				{
+					k.ticks = TICKS_PER_STEP;
+					int newStepNr = (k.stepNr + 1) % int (controllers[NR_OF_STEPS]);
 
-									if
-									(
-										(pads[row][oldRowStepNr].duration > 1.0f) &&
-										(inKeys[key].output[row].playing)
-									)
-									{
-										inKeys[key].output[row].duration -= 1.0;
-									}
+					// Count pattern loops (used for trig conditions)
+					if ((newStepNr == 0) && (k.stepNr >= 0))
+					{
+						++k.loop;
+						k.conditionBits = getConditionBits (k.loop);
+					}
+					k.stepNr = newStepNr;
+				}
 
-								}
-							}
-						}
+				// Update all rows, if not halted before
+				for (int row = 0; row < ROWS; ++row)
+				{
+					Output& o = k.output[row];
+					if (o.stepNr == HALT_STEP) continue;
 
-						// Update inKeys position data
-						inKeys[key].stepNr = actStepNr;
-						inKeys[key].startPos = actpos - actStepFrac / STEPS_PER_BEAT;
+					o.ticks -= nextTicks;
+					if (o.ticks > 0) continue;
 
-						// Start new output
-						//startMidiOut (actframes, key, ALL_CH);
+					// Just stepped
+					o.ticks = getRowTicks (row);
+					int oldStepNr = o.stepNr;
+					int newStepNr = getNextRowStep (key, row);
+
+					if (newStepNr == HALT_STEP)
+					{
+						o.stepNr = HALT_STEP;
+						stopMidiOut (actframes, key, row, ALL_CH);
+						continue;
 					}
 
-					for (int row = 0; row < ROWS; ++row)
+					o.stepNr = newStepNr;
+
+					// Let notes tied over a pattern switch ring out
+					if (o.tied && o.playing) continue;
+					o.tied = false;
+					o.startPos = nextpos;
+					o.ratchets = 1;
+
+					if
+					(
+						(oldStepNr < 0) ||
+						(newStepNr <= 0) ||
+						(newStepNr != oldStepNr + 1) ||
+						((int (pads[row][newStepNr].ch) & 0x0f) != (int (pads[row][oldStepNr].ch) & 0x0f)) ||
+						(pads[row][oldStepNr].duration <= 1.0f)
+					)
 					{
-						// Only if pad not halted
-						if (inKeys[key].output[row].stepOffset < MAXSTEPS)
-						{
-							// Scan pads and calculate note off position
-							if (inKeys[key].output[row].playing)
-							{
-								double noteoffpos = inKeys[key].startPos + inKeys[key].output[row].duration / STEPS_PER_BEAT;
-								if ((noteoffpos >= lastpos) && (noteoffpos <= actpos))
-								{
-									int64_t noteoffframes = LIMIT (start + (noteoffpos - startpos) * FRAMES_PER_BEAT, start, end);
-									stopMidiOut (noteoffframes, key, row, ALL_CH);
-								}
-							}
-						}
+						stopMidiOut (actframes, key, row, ALL_CH);
+
+						o.pad = pads[row][newStepNr];
+						if (k.note != 0xff) startMidiOut (actframes, key, row, ALL_CH);
+					}
+
+					if
+					(
+						(oldStepNr >= 0) &&
+						(pads[row][oldStepNr].duration > 1.0f) &&
+						(o.playing)
+					)
+					{
+						o.duration -= 1.0;
 					}
 				}
 
-				// Calculate next step position
-				if (actpos == endpos) nextpos = endpos + 1; // Why I don't like the break command ;-)
-				else
+				// Update inKeys position data
+				k.startPos = nextpos;
+			}
+		}
+
+		runAutomation (startpos, start, end);
+	}
+}
+
+/*
+ * Converts a position (beat number) to the nearest frame
+ * @param pos		Position
+ * @param startpos	Position at the frame start
+ * @param start		Frame
+ * @return		Frame, may be outside the actual block
+ */
+int64_t BSEQuencer::getFrames (const double pos, const double startpos, const uint32_t start)
+{
+	return int64_t (start) + int64_t (floor ((pos - startpos) * FRAMES_PER_BEAT + 0.5));
+}
+
+/*
+ * Gets the end position (beat number) of the actual pattern cycle, counted
+ * in steps of the first inKey
+ */
+double BSEQuencer::getPatternEndPos ()
+{
+	if (inKeys.empty ()) return position;
+
+	Key& k = inKeys[0];
+	int nrsteps = controllers[NR_OF_STEPS];
+	int steps = (k.stepNr < nrsteps - 1 ? nrsteps - 1 - k.stepNr : 0);
+	return k.startPos + double (k.ticks + steps * TICKS_PER_STEP) / (STEPS_PER_BEAT * TICKS_PER_STEP);
+}
+
+/*
+ * Schedules a pattern switch at the next step of the first inKey or at the
+ * next bar (depending on PATTERN_SWITCH). Switches immediately if nothing
+ * is played.
+ * @param pattern	Number of the pattern to switch to
+ * @param frames	Time of the request
+ */
+void BSEQuencer::schedulePattern (const int pattern, const int64_t frames)
+{
+	int mode = controllers[PATTERN_SWITCH];
+	bool cut = mode & SWITCH_CUT;
+	int nr = LIMIT (pattern, 0, NR_PATTERNS - 1);
+
+	if (nr == activePattern)
+	{
+		pendingPattern = NO_PATTERN;
+		return;
+	}
+
+	if (inKeys.empty () || (VALUE_BPM <= 0) || (!controllers[PLAY]))
+	{
+		switchPattern (nr, frames, position, cut);
+		return;
+	}
+
+	double pos = position + double (frames) / FRAMES_PER_BEAT;
+	pendingPattern = nr;
+	pendingPatternCut = cut;
+	if (mode & SWITCH_BAR) pendingPatternPos = ceil (pos / VALUE_BPB) * VALUE_BPB;
+
+	// Next step of the first inKey at or after the message. The inKeys are
+	// not moved forward to frames yet, thus skip the steps before.
+	else
+	{
+		const double stepSize = 1.0 / STEPS_PER_BEAT;
+		double nextpos = inKeys[0].startPos + double (inKeys[0].ticks) / (STEPS_PER_BEAT * TICKS_PER_STEP);
+		if (nextpos < pos) nextpos += ceil ((pos - nextpos) / stepSize - 1e-9) * stepSize;
+		pendingPatternPos = nextpos;
+	}
+}
+
+/*
+ * Switches the active pattern and restarts all inKeys at the switch
+ * position. Switching only changes pointers and is allocation-free.
+ * @param pattern	Number of the pattern to switch to
+ * @param frames	Time of the switch (frames)
+ * @param pos		Time of the switch (beat number)
+ * @param cut		If true, stops all notes. Otherwise tied notes ring out.
+ */
+void BSEQuencer::switchPattern (const int pattern, const int64_t frames, const double pos, const bool cut)
+{
+	int nr = LIMIT (pattern, 0, NR_PATTERNS - 1);
+
+	if (cut) stopMidiOut (frames, ALL_CH);
+
+	activePattern = nr;
+	pads = patterns[nr];
+	padStarts = patternPadStarts[nr];
+	padEnds = patternPadEnds[nr];
+	rows = patternRows[nr];
+	for (int key = 0; key < int (inKeys.size); ++key) restartKey (key, pos);
+
+	pendingPattern = NO_PATTERN;
+	scheduleNotifyStatusToGui = true;
+}
+
+/*
+ * Restarts the stepping of an inKey (with all rows) at the given position.
+ * Notes which are still playing are kept as tied notes.
+ */
+void BSEQuencer::restartKey (const int key, const double pos)
+{
+	if ((key < 0) || (key >= ((int) inKeys.size))) return;
+
+	Key& k = inKeys[key];
+	k.startPos = pos - 1.0 / STEPS_PER_BEAT;
+	k.stepNr = -1;
+	k.ticks = TICKS_PER_STEP;
+	k.loop = 0;
+	k.conditionBits = getConditionBits (0);
+
+	for (int row = 0; row < ROWS; ++row)
+	{
+		Output& o = k.output[row];
+		o.tied = o.playing;
+		o.stepNr = -1;
+		o.ticks = TICKS_PER_STEP;
+		o.direction = 1;
+		o.jumpOff.fill (false);
+	}
+}
+
+/*
+ * Selects a pattern by MIDI program change (program 0..NR_PATTERNS - 1) or
+ * by a key of the reserved key range (PATTERN_KEYS ... PATTERN_KEYS +
+ * NR_PATTERNS - 1). The switch itself is quantized by schedulePattern.
+ * With SELECT_PRESET(_KEYS), program changes load bank presets instead.
+ * @param msg		MIDI message
+ * @param frames	Time of the MIDI message
+ * @return		True if the message was used for pattern selection and
+ *			should not be processed any further
+ */
+bool BSEQuencer::midiSelectPattern (const uint8_t* const msg, const int64_t frames)
+{
+	const int select = controllers[PATTERN_SELECT];
+	if (select == SELECT_OFF) return false;
+
+	const uint8_t typ = lv2_midi_message_type (msg);
+	const uint8_t chn = msg[0] & 0x0F;
+	if ((controllers[MIDI_IN_CHANNEL] != 0) && (controllers[MIDI_IN_CHANNEL] - 1 != chn)) return false;
+
+	if (SELECT_BY_PRESET (select) && (typ == LV2_MIDI_MSG_PGM_CHANGE))
+	{
+		loadBankPreset (msg[1]);
+		return true;
+	}
+
+	if (SELECT_BY_PROGRAM (select) && (typ == LV2_MIDI_MSG_PGM_CHANGE) && (msg[1] < NR_PATTERNS))
+	{
+		schedulePattern (msg[1], frames);
+		return true;
+	}
+
+	if (SELECT_BY_KEYS (select) && ((typ == LV2_MIDI_MSG_NOTE_ON) || (typ == LV2_MIDI_MSG_NOTE_OFF)))
+	{
+		const int nr = int (msg[1]) - int (controllers[PATTERN_KEYS]);
+		if ((nr < 0) || (nr >= NR_PATTERNS)) return false;
+		if ((typ == LV2_MIDI_MSG_NOTE_ON) && (msg[2] != 0)) schedulePattern (nr, frames);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Records incoming notes into the pads of the active pattern while RECORD
+ * is on. Works in autoplay and host playback mode. Notes are quantized to
+ * the nearest step of the row they are mapped to (see getRecordRow). Note
+ * on sets the pad, note off sets its duration (max. one step). The notes
+ * are also forwarded to the output for monitoring.
+ * @param msg		MIDI message
+ * @param frames	Time of the MIDI message
+ * @return		True if the message was recorded and should not be
+ *			processed any further
+ */
+bool BSEQuencer::midiRecord (const uint8_t* const msg, const int64_t frames)
+{
+	if ((!controllers[RECORD]) || (!controllers[PLAY]) || (controllers[MODE] == HOST_CONTROLLED)) return false;
+
+	const uint8_t typ = lv2_midi_message_type (msg);
+	const uint8_t chn = msg[0] & 0x0F;
+	const uint8_t note = msg[1] & 0x7F;
+	if ((typ != LV2_MIDI_MSG_NOTE_ON) && (typ != LV2_MIDI_MSG_NOTE_OFF)) return false;
+	if ((controllers[MIDI_IN_CHANNEL] != 0) && (controllers[MIDI_IN_CHANNEL] - 1 != chn)) return false;
+
+	// Monitor
+	midiStack.append (frames, 0xff, msg[0], msg[1], msg[2], 3);
+
+	const double pos = position + double (frames) / FRAMES_PER_BEAT;
+	RecordedNote& r = recordedNotes[note];
+
+	// Note off (or note on with zero velocity): Set duration
+	if ((typ == LV2_MIDI_MSG_NOTE_OFF) || (msg[2] == 0))
+	{
+		if (r.row < 0) return true;
+
+		Pad& pd = patterns[r.pattern][r.row][r.step];
+		float duration = round (100.0 * (pos - r.startPos) / r.stepSize) / 100.0;
+		pd.duration = LIMIT (duration, 0.01f, 1.0f);
+		patternCompiled[r.pattern] = false;
+		if (r.pattern == controllers[PATTERN])
+		{
+			padMessageBufferAppendPad (r.row, r.step, pd);
+			scheduleNotifyPadsToGui = true;
+		}
+		r.row = -1;
+		return true;
+	}
+
+	// Note on: Find row and nearest step
+	if (inKeys.empty () || (VALUE_BPM <= 0)) return true;
+
+	const int selch = controllers[SELECTION_CH];
+	const int ch = ((selch >= 1) && (selch <= NR_SEQUENCER_CHS) ? selch : 1);
+	int octave = 0;
+	const int row = getRecordRow (note, ch, &octave);
+	if (row < 0) return true;
+
+	Key& k = inKeys[0];
+	Output& o = k.output[row];
+	if (o.stepNr == HALT_STEP) return true;
+
+	const double ticksPerBeat = STEPS_PER_BEAT * TICKS_PER_STEP;
+	const double stepSize = double (getRowTicks (row)) / ticksPerBeat;
+	const double nextStepPos = k.startPos + double (o.ticks) / ticksPerBeat;
+	const int nrSteps = getRowLength (row);
+	int n = floor ((pos - nextStepPos) / stepSize + 1.5);	// 0: actual step, 1: next step, ...
+
+	// Groove: Check the neighbouring steps too
+	double dist = fabs (groovePos (nextStepPos + (n - 1) * stepSize) - pos);
+	int best = n;
+	for (int i = n - 1; i <= n + 1; i += 2)
+	{
+		double d = fabs (groovePos (nextStepPos + (i - 1) * stepSize) - pos);
+		if (d < dist)
+		{
+			dist = d;
+			best = i;
+		}
+	}
+	n = best;
+	const int step = (((o.stepNr + n * (o.direction < 0 ? -1 : 1)) % nrSteps) + nrSteps) % nrSteps;
+
+	Pad& pd = pads[row][step];
+	pd = validatePad (Pad (ch + (int (pd.ch) & 0xF0), 0, octave, float (msg[2]) / 64.0f, 1.0, 1.0, 0, 0, 0, 0));
+	patternCompiled[activePattern] = false;
+	if (activePattern == controllers[PATTERN])
+	{
+		padMessageBufferAppendPad (row, step, pd);
+		scheduleNotifyPadsToGui = true;
+	}
+
+	r.pattern = activePattern;
+	r.row = row;
+	r.step = step;
+	r.startPos = pos;
+	r.stepSize = stepSize;
+	return true;
+}
+
+/*
+ * Finds the row which plays a MIDI note in the actual scale map. Rows
+ * playing the note itself are preferred. Otherwise the row playing the same
+ * note with the least octave shift is used (scale rows only).
+ * @param note		MIDI note
+ * @param ch		Sequencer channel (1..4) used for the note offset
+ * @param octave	Pointer to an int which receives the octave shift
+ * @return		Row number or -1 if no row plays this note
+ */
+int BSEQuencer::getRecordRow (const int note, const int ch, int* octave)
+{
+	const int scaleNr = controllers[SCALE];
+	const int offset = controllers[CH + (ch - 1) * CH_SIZE + NOTE_OFFSET];
+	return SMFImport::getRow (note, rtScaleMaps[scaleNr].elements, scale, offset, octave);
+}
+
+void BSEQuencer::clearRecordedNotes ()
+{
+	for (int i = 0; i < NR_MIDI_KEYS; ++i) recordedNotes[i].row = -1;
+}
+
+/*
+ * Precalculates the timing offsets and velocity factors of the groove cycle
+ * from the selected groove template and the swing amount. Swing delays each
+ * second step (50 % = straight, 75 % = half a step).
+ */
+void BSEQuencer::updateGroove ()
+{
+	const int grooveNr = LIMIT (int (controllers[GROOVE]), 0, NR_GROOVES - 1);
+	const Groove& g = (grooveNr == GROOVE_USER ? userGroove : defaultGrooves[grooveNr]);
+	const int size = LIMIT (g.size, 1, MAXSTEPS);
+	const float swing = (controllers[SWING] - 50.0f) / 50.0f;
+
+	grooveSize = (((swing != 0.0f) && (size % 2)) ? 2 * size : size);
+	for (int i = 0; i < grooveSize; ++i)
+	{
+		float timing = g.timing[i % size] + (i % 2 ? swing : 0.0f);
+		grooveTiming[i] = LIMIT (timing, -MAX_GROOVE_TIMING, MAX_GROOVE_TIMING);
+		grooveVelocity[i] = LIMIT (g.velocity[i % size], MIN_GROOVE_VELOCITY, MAX_GROOVE_VELOCITY);
+	}
+}
+
+/*
+ * Maps a position of the straight step grid to the grooved position. Each
+ * step is shifted by its timing offset, positions within a step are
+ * stretched linearly.
+ * @param pos	Position (beat number) in the straight step grid
+ * @return	Position (beat number) in the host time
+ */
+double BSEQuencer::groovePos (const double pos)
+{
+	if ((grooveSize == 1) && (grooveTiming[0] == 0.0f)) return pos;
+
+	const double stepsPerBeat = STEPS_PER_BEAT;
+	const double stepPos = pos * stepsPerBeat;
+	const double step = floor (stepPos);
+	const double frac = stepPos - step;
+	const int n = ((int64_t (step) % grooveSize) + grooveSize) % grooveSize;
+	const double t0 = grooveTiming[n];
+	const double t1 = grooveTiming[(n + 1) % grooveSize];
+	return (step + t0 + frac * (1.0 + t1 - t0)) / stepsPerBeat;
+}
+
+/*
+ * Gets the groove velocity factor for the step starting at the position
+ * pos (straight step grid).
+ */
+float BSEQuencer::grooveVelocityFactor (const double pos)
+{
+	const int64_t step = floor (pos * STEPS_PER_BEAT + 0.5);
+	return grooveVelocity[((step % grooveSize) + grooveSize) % grooveSize];
+}
+
+/*
+ * Sends the automation lane values of the active pattern for the block
+ * [start, end). Each lane is sampled at its own rate and values are only
+ * sent if they changed (in MIDI resolution). Lanes follow the steps of the
+ * first inKey in the straight grid. Note messages have priority: Automation
+ * output pauses while the MIDI stack space is down to MIDIBUFFER_NOTE_RESERVE
+ * and continues (with the actual value) in the next call.
+ */
+void BSEQuencer::runAutomation (const double startpos, const uint32_t start, const uint32_t end)
+{
+	if (inKeys.empty ()) return;
+
+	for (int ch = 0; ch < NR_SEQUENCER_CHS; ++ch)
+	{
+		const AutomationLane& lane = patternAutomation[activePattern][ch];
+		if (lane.type == AUTOMATION_OFF) continue;
+
+		const int64_t interval = (rate / lane.rate > 1.0 ? rate / lane.rate : 1);
+		int64_t frames = (automationFrames[ch] > start ? automationFrames[ch] : start);
+
+		for (; (frames < end) && (midiStack.space () > MIDIBUFFER_NOTE_RESERVE); frames += interval)
+		{
+			float value = getAutomationValue (ch, startpos + double (frames - start) / FRAMES_PER_BEAT);
+			if (value == NO_AUTOMATION_VALUE) continue;
+
+			switch (int (lane.type))
+			{
+				case AUTOMATION_CC:
 				{
-					nextpos = actpos + (1 - actStepFrac) / STEPS_PER_BEAT;
-					if (nextpos < actpos + 1 / FRAMES_PER_BEAT) nextpos = actpos + 1 / FRAMES_PER_BEAT;	// At least one frame
-					if (nextpos > endpos) nextpos = endpos;
+					int val = value * 127.0f + 0.5f;
+					if (val == automationValues[ch]) break;
+					midiStack.append (frames, ch, LV2_MIDI_MSG_CONTROLLER, lane.controller, val);
+					automationValues[ch] = val;
 				}
-				lastpos = actpos;
+				break;
+
+				case AUTOMATION_PITCH_BEND:
+				{
+					int val = value * 16383.0f + 0.5f;
+					if (val == automationValues[ch]) break;
+					midiStack.append (frames, ch, LV2_MIDI_MSG_BENDER, val & 0x7F, val >> 7);
+					automationValues[ch] = val;
+				}
+				break;
+
+				case AUTOMATION_AFTERTOUCH:
+				{
+					int val = value * 127.0f + 0.5f;
+					if (val == automationValues[ch]) break;
+					midiStack.append (frames, ch, LV2_MIDI_MSG_CHANNEL_PRESSURE, val, 0, 2);
+					automationValues[ch] = val;
+				}
+				break;
+
+				default:	break;
 			}
 		}
+
+		automationFrames[ch] = frames;
 	}
 }
 
+/*
+ * Gets the (interpolated) automation lane value of a sequencer channel at
+ * the position pos (beat number) or NO_AUTOMATION_VALUE if the lane has
+ * no nodes.
+ */
+float BSEQuencer::getAutomationValue (const int ch, const double pos)
+{
+	const AutomationLane& lane = patternAutomation[activePattern][ch];
+	const Key& k = inKeys[0];
+	const int nrSteps = controllers[NR_OF_STEPS];
+
+	// Step position of the first inKey, wrapped to the pattern
+	double stepPos = k.stepNr + 1.0 - double (k.ticks) / TICKS_PER_STEP + (pos - k.startPos) * STEPS_PER_BEAT;
+
+	// Round to a fixed grid: Block positions carry rounding errors
+	// depending on the block size. Otherwise a position on a step border
+	// (e.g., 7.99999999999992) would jump to the previous step.
+	stepPos = round (stepPos * 1000000.0) / 1000000.0;
+	if ((k.loop == 0) && (stepPos < 0.0)) stepPos = 0.0;
+	stepPos = fmod (stepPos, nrSteps);
+	if (stepPos < 0.0) stepPos += nrSteps;
+	const int step = LIMIT (int (stepPos), 0, nrSteps - 1);
+
+	if (automationCompiledSteps[activePattern][ch] != nrSteps) compileAutomation (activePattern, ch);
+	const int prev = automationPrevNodes[activePattern][ch][step];
+	if (prev < 0) return NO_AUTOMATION_VALUE;
+	if (lane.interpolation == INTERPOLATION_STEP) return lane.values[prev];
+	const int next = automationNextNodes[activePattern][ch][step];
+
+	const double v0 = lane.values[prev];
+	const double v1 = lane.values[next];
+	const int dist = (next > prev ? next - prev : next - prev + nrSteps);
+	double t = fmod (stepPos - prev + nrSteps, nrSteps) / dist;
+	if (lane.interpolation == INTERPOLATION_EXP) t = (exp (3.0 * t) - 1.0) / (exp (3.0) - 1.0);
+	return v0 + t * (v1 - v0);
+}
+
+/*
+ * Precompiles the previous (or same) and the next node of each step of an
+ * automation lane for the actual number of steps. The next node of a lane
+ * with a single node is the node itself.
+ */
+void BSEQuencer::compileAutomation (const int pattern, const int ch)
+{
+	const AutomationLane& lane = patternAutomation[pattern][ch];
+	int8_t* prevNodes = automationPrevNodes[pattern][ch];
+	int8_t* nextNodes = automationNextNodes[pattern][ch];
+	const int nrSteps = LIMIT (int (controllers[NR_OF_STEPS]), 1, MAXSTEPS);
+
+	// Last and first node, wrapped around the pattern
+	int prev = -1;
+	for (int step = nrSteps - 1; (step >= 0) && (prev < 0); --step)
+	{
+		if (lane.values[step] != NO_AUTOMATION_VALUE) prev = step;
+	}
+	int next = -1;
+	for (int step = 0; (step < nrSteps) && (next < 0); ++step)
+	{
+		if (lane.values[step] != NO_AUTOMATION_VALUE) next = step;
+	}
+
+	for (int step = 0; step < nrSteps; ++step)
+	{
+		if (lane.values[step] != NO_AUTOMATION_VALUE) prev = step;
+		prevNodes[step] = prev;
+	}
+
+	for (int step = nrSteps - 1; step >= 0; --step)
+	{
+		nextNodes[step] = next;
+		if (lane.values[step] != NO_AUTOMATION_VALUE) next = step;
+	}
+
+	automationCompiledSteps[pattern][ch] = nrSteps;
+}
+
+/*
+ * Marks all automation lanes to be precompiled again before they are
+ * played. Call after each change of the lanes.
+ */
+void BSEQuencer::invalidateAutomation ()
+{
+	for (int p = 0; p < NR_PATTERNS; ++p)
+	{
+		for (int c = 0; c < NR_SEQUENCER_CHS; ++c) automationCompiledSteps[p][c] = 0;
+	}
+}
 
 void BSEQuencer::run (uint32_t n_samples)
 {
 	int64_t last_t = 0;
 
-	if ((!inputPort) || (!outputPort)) return;
+	if ((!inputPort) || (!outputPort) || (!notifyPort)) return;
 
 	midiStack.clear ();
 
-	// Init notify port
+	// Init MIDI output port
 	uint32_t space = outputPort->atom.size;
 	lv2_atom_forge_set_buffer(&output_forge, (uint8_t*) outputPort, space);
 	lv2_atom_forge_sequence_head(&output_forge, &output_frame, 0);
 
+	// Init notify port
+	space = notifyPort->atom.size;
+	lv2_atom_forge_set_buffer(&notify_forge, (uint8_t*) notifyPort, space);
+	lv2_atom_forge_sequence_head(&notify_forge, &notify_frame, 0);
+
+	// Init MIDI output ports (MultiOut variant)
+	if (multiOut)
+	{
+		for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
+		{
+			if (!midiOutputPorts[i]) continue;
+			lv2_atom_forge_set_buffer(&midi_forge[i], (uint8_t*) midiOutputPorts[i], midiOutputPorts[i]->atom.size);
+			lv2_atom_forge_sequence_head(&midi_forge[i], &midi_frame[i], 0);
+		}
+	}
+
+	// Release bank preset controller overrides if the host changed the port
+	for (int i = 0; i < KNOBS_SIZE; ++i)
+	{
+		if (controllerOverride[i] && controllerPorts[i] && (*controllerPorts[i] != controllerOverrideBase[i]))
+		{
+			controllerOverride[i] = false;
+			new_controllers[i] = controllerPorts[i];
+		}
+	}
+
 	// Validate controllers
 	for (int i = 0; i < KNOBS_SIZE; ++i)
 	{
@@ -709,6 +1467,45 @@ void BSEQuencer::run (uint32_t n_samples)
 		if (new_controllers[i]) controllers[i] = *new_controllers[i];
 	}
 
+	// Update pattern controllers: Switch to the selected pattern and send its
+	// pads to the GUI for editing
+	for (int i = PATTERN_SWITCH; i <= PATTERN_KEYS; ++i) if (new_controllers[i]) controllers[i] = *new_controllers[i];
+
+	if (CONTROLLER_CHANGED(PATTERN))
+	{
+		controllers[PATTERN] = *new_controllers[PATTERN];
+		schedulePattern (controllers[PATTERN], 0);
+		padMessageBufferAllPads ();
+		scheduleNotifyPadsToGui = true;
+		scheduleNotifyRowsToGui = true;
+		scheduleNotifyAutomationToGui = true;
+	}
+
+	// Update record controller
+	if (CONTROLLER_CHANGED(RECORD))
+	{
+		controllers[RECORD] = *new_controllers[RECORD];
+		clearRecordedNotes ();
+	}
+
+	// Update groove controllers
+	if (CONTROLLER_CHANGED(SWING) || CONTROLLER_CHANGED(GROOVE))
+	{
+		if (new_controllers[SWING]) controllers[SWING] = *new_controllers[SWING];
+		if (new_controllers[GROOVE]) controllers[GROOVE] = *new_controllers[GROOVE];
+		updateGroove ();
+	}
+
+	// Copy selection (ratchet, condition) and fill controller values
+	for (int i = SELECTION_RATCHET; i <= FILL; ++i) if (new_controllers[i]) controllers[i] = *new_controllers[i];
+
+	// Load bank preset (1..n, 0 = none)
+	if (CONTROLLER_CHANGED(PRESET))
+	{
+		controllers[PRESET] = *new_controllers[PRESET];
+		if (controllers[PRESET] > 0) loadBankPreset (controllers[PRESET] - 1);
+	}
+
 	// Read CONTROL port (notifications from GUI and host)
 	LV2_ATOM_SEQUENCE_FOREACH(inputPort, ev)
 	{
@@ -725,6 +1522,9 @@ void BSEQuencer::run (uint32_t n_samples)
 				//fprintf (stderr, "BSEQuencer.lv2: UI on received.\n");
 				padMessageBufferAllPads ();
 				scheduleNotifyPadsToGui = true;
+				scheduleNotifyRowsToGui = true;
+				scheduleNotifyChainToGui = true;
+				scheduleNotifyAutomationToGui = true;
 				scheduleNotifyStatusToGui = true;
 			}
 
@@ -760,14 +1560,19 @@ void BSEQuencer::run (uint32_t n_samples)
 								Pad pd
 								(
 									pMes[i].ch, pMes[i].pitchNote, pMes[i].pitchOctave, pMes[i].velocity, pMes[i].duration,
-									pMes[i].randGate, pMes[i].randNote, pMes[i].randOctave,pMes[i].randVelocity, pMes[i].randDuration
+									pMes[i].randGate, pMes[i].randNote, pMes[i].randOctave,pMes[i].randVelocity, pMes[i].randDuration,
+									pMes[i].ratchet, pMes[i].ratchetCurve, pMes[i].condition
 								);
 								Pad valPad = validatePad (pd);
-								pads[row][step] = valPad;
-								if (valPad != pd)
+								patterns[int (controllers[PATTERN])][row][step] = valPad;
+								patternCompiled[int (controllers[PATTERN])] = false;
+								if (valPad != pd) fprintf (stderr, "BSEQuencer.lv2: Pad out of range in run (): pads[%i][%i].\n", row, step);
+
+								// Send back invalid pads. And pads edited during a full pad sync:
+								// Otherwise the pending sync data overwrite the GUI edits.
+								if ((valPad != pd) || padSyncPending || padSyncRunning)
 								{
-									fprintf (stderr, "BSEQuencer.lv2: Pad out of range in run (): pads[%i][%i].\n", row, step);
-									padMessageBufferAppendPad (row, step, valPad);
+									if (!padMessageBufferAppendPad (row, step, valPad)) padMessageBufferAllPads ();
 									scheduleNotifyPadsToGui = true;
 								}
 							}
@@ -776,6 +1581,96 @@ void BSEQuencer::run (uint32_t n_samples)
 				}
 			}
 
+			// GUI row properties changed notifications
+			else if (obj->body.otype == uris.notify_rowEvent)
+			{
+				LV2_Atom *oRw = NULL;
+				lv2_atom_object_get (obj, uris.notify_row,  &oRw, NULL);
+
+				if (oRw && (oRw->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oRw;
+					if (vec->body.child_type == uris.atom_Float)
+					{
+						const uint32_t size = (uint32_t) ((oRw->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (RowMessage));
+						RowMessage* rMes = (RowMessage*) (&vec->body + 1);
+
+						// Copy RowMessages to rows
+						for (unsigned int i = 0; i < size; ++i)
+						{
+							int row = (int) rMes[i].row;
+							if ((row >= 0) && (row < ROWS))
+							{
+								RowProperties props (rMes[i].length, rMes[i].multiplier, rMes[i].divider);
+								RowProperties valProps = validateRow (props);
+								patternRows[int (controllers[PATTERN])][row] = valProps;
+								if (valProps != props)
+								{
+									fprintf (stderr, "BSEQuencer.lv2: Row properties out of range in run (): rows[%i].\n", row);
+									scheduleNotifyRowsToGui = true;
+								}
+							}
+						}
+					}
+				}
+			}
+
+			// GUI pattern chain changed notifications
+			else if (obj->body.otype == uris.notify_chainEvent)
+			{
+				LV2_Atom *oCh = NULL;
+				lv2_atom_object_get (obj, uris.notify_chain,  &oCh, NULL);
+
+				if (oCh && (oCh->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oCh;
+					if (vec->body.child_type == uris.atom_Int)
+					{
+						const uint32_t size = (uint32_t) ((oCh->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (int));
+						int* chain = (int*) (&vec->body + 1);
+						for (unsigned int i = 0; (i < size) && (i < NR_PATTERNS); ++i)
+						{
+							patternChain[i] = ((chain[i] >= 0) && (chain[i] < NR_PATTERNS) ? chain[i] : NO_PATTERN);
+						}
+					}
+				}
+			}
+
+			// GUI automation lanes changed notifications
+			else if (obj->body.otype == uris.notify_automationEvent)
+			{
+				LV2_Atom *oAu = NULL;
+				lv2_atom_object_get (obj, uris.notify_automation,  &oAu, NULL);
+
+				if (oAu && (oAu->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oAu;
+					if (vec->body.child_type == uris.atom_Float)
+					{
+						const uint32_t size = (uint32_t) ((oAu->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (AutomationMessage));
+						AutomationMessage* aMes = (AutomationMessage*) (&vec->body + 1);
+
+						// Copy AutomationMessages to lanes
+						for (unsigned int i = 0; i < size; ++i)
+						{
+							int ch = (int) aMes[i].ch;
+							if ((ch >= 0) && (ch < NR_SEQUENCER_CHS))
+							{
+								AutomationLane lane = aMes[i];
+								AutomationLane valLane = validateAutomation (lane);
+								patternAutomation[int (controllers[PATTERN])][ch] = valLane;
+								automationCompiledSteps[int (controllers[PATTERN])][ch] = 0;
+								if (valLane != lane)
+								{
+									fprintf (stderr, "BSEQuencer.lv2: Automation lane out of range in run (): lanes[%i].\n", ch);
+									scheduleNotifyAutomationToGui = true;
+								}
+							}
+						}
+					}
+				}
+			}
+
 			// GUI user scales changed notifications
 			else if (obj->body.otype == uris.notify_scaleMapsEvent)
 			{
@@ -913,6 +1808,23 @@ void BSEQuencer::run (uint32_t n_samples)
 				}
 			}
 
+			// User preset bank file set (by the host)
+			else if (obj->body.otype == uris.patch_Set)
+			{
+				const LV2_Atom* oProperty = NULL;
+				const LV2_Atom* oValue = NULL;
+				lv2_atom_object_get (obj, uris.patch_property, &oProperty, uris.patch_value, &oValue, NULL);
+
+				if
+				(
+					oProperty && (oProperty->type == uris.atom_URID) && (((const LV2_Atom_URID*) oProperty)->body == uris.bankFile) &&
+					oValue && (oValue->type == uris.atom_Path)
+				)
+				{
+					scheduleLoadBank ((const char*) (oValue + 1), oValue->size);
+				}
+			}
+
 			//else fprintf (stderr, "BSEQuencer.lv2: Ignored object in Control port (otype = %i, %s)\n", obj->body.otype,
 			//			  (unmap ? unmap->unmap (unmap->handle, obj->body.otype) : NULL));
 		}
@@ -921,9 +1833,18 @@ void BSEQuencer::run (uint32_t n_samples)
 		// Read incoming MIDI_IN events
 		else if (ev->body.type == uris.midi_Event)
 		{
-			if ((controllers[PLAY]) && (controllers[MODE] == HOST_CONTROLLED))
+			const uint8_t* const msg = (const uint8_t*)(ev + 1);
+
+			// Pattern selection by program change or reserved keys (all modes)
+			// and live recording take precedence over the sequencer MIDI input
+			if
+			(
+				(!midiSelectPattern (msg, act_t)) &&
+				(!midiRecord (msg, act_t)) &&
+				(controllers[PLAY]) &&
+				(controllers[MODE] == HOST_CONTROLLED)
+			)
 			{
-				const uint8_t* const msg = (const uint8_t*)(ev + 1);
 				const uint8_t msize = ev->body.size;
 				uint8_t typ = lv2_midi_message_type(msg);
 				uint8_t chn = msg[0] & 0x0F;
@@ -1092,44 +2013,150 @@ void BSEQuencer::run (uint32_t n_samples)
 	//Update position until next time signal from host
 	position += double (n_samples) / FRAMES_PER_BEAT;
 
+	// Automation output times relative to the next block
+	for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
+	{
+		automationFrames[i] = (automationFrames[i] > n_samples ? automationFrames[i] - n_samples : 0);
+	}
+
 	scheduleNotifyStatusToGui = true;
 
-	// Send notifications to GUI
-	if (ui_on && scheduleNotifyStatusToGui) notifyStatusToGui ();
-	if (ui_on && scheduleNotifyPadsToGui) notifyPadsToGui ();
-	if (ui_on && scheduleNotifyScaleMapsToGui) notifyScaleMapsToGui ();
+	// Send MIDI first
 	notifyMidi ();
 	lv2_atom_forge_pop(&output_forge, &output_frame);
+
+	// Send notifications to GUI. Pads last as they fill the remaining space.
+	if (ui_on && scheduleNotifyStatusToGui) notifyStatusToGui ();
+	if (ui_on && scheduleNotifyRowsToGui) notifyRowsToGui ();
+	if (ui_on && scheduleNotifyChainToGui) notifyChainToGui ();
+	if (ui_on && scheduleNotifyAutomationToGui) notifyAutomationToGui ();
+	if (ui_on && scheduleNotifyScaleMapsToGui) notifyScaleMapsToGui ();
+	if (ui_on && scheduleNotifyControllersToGui) notifyControllersToGui ();
+	if (ui_on && scheduleNotifyPadsToGui) notifyPadsToGui ();
+	lv2_atom_forge_pop(&notify_forge, &notify_frame);
+
+	if (multiOut)
+	{
+		for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
+		{
+			if (midiOutputPorts[i]) lv2_atom_forge_pop(&midi_forge[i], &midi_frame[i]);
+		}
+	}
+}
+
+static LV2_State_Map_Path* getMapPath (const LV2_Feature* const* features)
+{
+	if (!features) return NULL;
+	for (int i = 0; features[i]; ++i)
+	{
+		if (strcmp (features[i]->URI, LV2_STATE__mapPath) == 0) return (LV2_State_Map_Path*) features[i]->data;
+	}
+	return NULL;
 }
 
 LV2_State_Status BSEQuencer::state_save (LV2_State_Store_Function store, LV2_State_Handle handle, uint32_t flags,
 			const LV2_Feature* const* features)
 {
-	// Store pads
-	char padDataString[0x10010] = "Matrix data:\n";
+	// Store pads of all patterns
+	// ID: pattern * ROWS * MAXSTEPS + step * ROWS + row (pattern 0 compatible to older versions)
+	std::string padDataString = "Matrix data:\n";
 
-	for (int step = 0; step < MAXSTEPS; ++step)
+	for (int pat = 0; pat < NR_PATTERNS; ++pat)
+	{
+		for (int step = 0; step < MAXSTEPS; ++step)
+		{
+			for (int row = 0; row < ROWS; ++row)
+			{
+				if (patterns[pat][row][step].ch != 0)
+				{
+					Pad* pd = &patterns[pat][row][step];
+					char valueString[128];
+					int id = pat * ROWS * MAXSTEPS + step * ROWS + row;
+					snprintf
+					(
+						valueString, 126, "id:%d; ch:%d; st:%d; oc:%d; ve:%1.2f; du:%1.2f; rg:%d; rs:%d; ro:%d; rv:%1.2f; rd:%1.2f; ra:%d; rc:%1.2f; co:%d;\n",
+						id, (int) pd->ch, (int)pd->pitchNote, (int) pd->pitchOctave, pd->velocity, pd->duration,
+						(int) pd->randGate, (int) pd->randNote, (int) pd->randOctave, pd->randVelocity, pd->randDuration,
+						(int) pd->ratchet, pd->ratchetCurve, (int) pd->condition
+					);
+					padDataString += valueString;
+				}
+			}
+		}
+	}
+	store (handle, uris.state_pad, padDataString.c_str(), padDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
+
+	// Store row properties of all patterns
+	// ID: pattern * ROWS + row
+	std::string rowDataString = "Row data:\n";
+
+	for (int pat = 0; pat < NR_PATTERNS; ++pat)
 	{
 		for (int row = 0; row < ROWS; ++row)
 		{
-			if (pads[row][step].ch != 0)
+			RowProperties* props = &patternRows[pat][row];
+			if (*props != RowProperties ())
 			{
-				Pad* pd = &pads[row][step];
-				char valueString[128];
-				int id = step * ROWS + row;
-				snprintf
-				(
-					valueString, 126, "id:%d; ch:%d; st:%d; oc:%d; ve:%1.2f; du:%1.2f; rg:%d; rs:%d; ro:%d; rv:%1.2f; rd:%1.2f",
-					id, (int) pd->ch, (int)pd->pitchNote, (int) pd->pitchOctave, pd->velocity, pd->duration,
-					(int) pd->randGate, (int) pd->randNote, (int) pd->randOctave, pd->randVelocity, pd->randDuration
-				);
-				if ((step < MAXSTEPS - 1) || (row < ROWS)) strcat (valueString, ";\n");
-				else strcat(valueString, "\n");
-				strcat (padDataString, valueString);
+				rowDataString +=	"id:" + std::to_string (pat * ROWS + row) +
+							"; le:" + std::to_string (int (props->length)) +
+							"; mu:" + std::to_string (int (props->multiplier)) +
+							"; dv:" + std::to_string (int (props->divider)) + ";\n";
+			}
+		}
+	}
+	store (handle, uris.state_rows, rowDataString.c_str(), rowDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
+
+	// Store pattern chain
+	std::string patternDataString = "Pattern data:\n";
+
+	for (int pat = 0; pat < NR_PATTERNS; ++pat)
+	{
+		if (patternChain[pat] != NO_PATTERN)
+		{
+			patternDataString += "id:" + std::to_string (pat) + "; nx:" + std::to_string (patternChain[pat]) + ";\n";
+		}
+	}
+	store (handle, uris.state_patterns, patternDataString.c_str(), patternDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
+
+	// Store user groove
+	// Timing in fractions of a step, velocity as factor
+	std::string grooveDataString = "Groove data:\n";
+
+	for (int step = 0; step < userGroove.size; ++step)
+	{
+		char valueString[64];
+		snprintf (valueString, 62, "st:%d; tm:%1.3f; ve:%1.2f;\n", step, userGroove.timing[step], userGroove.velocity[step]);
+		grooveDataString += valueString;
+	}
+	store (handle, uris.state_groove, grooveDataString.c_str(), grooveDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
+
+	// Store automation lanes of all patterns
+	// ID: pattern * NR_SEQUENCER_CHS + ch, va: node values for all steps
+	std::string automationDataString = "Automation data:\n";
+
+	for (int pat = 0; pat < NR_PATTERNS; ++pat)
+	{
+		for (int ch = 0; ch < NR_SEQUENCER_CHS; ++ch)
+		{
+			AutomationLane* lane = &patternAutomation[pat][ch];
+			if (*lane != AutomationLane ())
+			{
+				automationDataString +=	"id:" + std::to_string (pat * NR_SEQUENCER_CHS + ch) +
+							"; ty:" + std::to_string (int (lane->type)) +
+							"; cc:" + std::to_string (int (lane->controller)) +
+							"; ip:" + std::to_string (int (lane->interpolation)) +
+							"; ra:" + std::to_string (int (lane->rate)) + ";\nva:";
+				for (int step = 0; step < MAXSTEPS; ++step)
+				{
+					char valueString[16];
+					snprintf (valueString, 14, "%1.3f;", lane->values[step]);
+					automationDataString += valueString;
+				}
+				automationDataString += "\n";
 			}
 		}
 	}
-	store (handle, uris.state_pad, padDataString, strlen (padDataString) + 1, uris.atom_String, LV2_STATE_IS_POD);
+	store (handle, uris.state_automation, automationDataString.c_str(), automationDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
 
 	// Store user scales
 	std::string mapDataString = "Scale data:\n";
@@ -1161,6 +2188,19 @@ LV2_State_Status BSEQuencer::state_save (LV2_State_Store_Function store, LV2_Sta
 	}
 	store (handle, uris.state_scales, mapDataString.c_str(), mapDataString.size() + 1, uris.atom_String, LV2_STATE_IS_POD);
 
+	// Store user preset bank file, use the host path mapping if provided
+	if (userBankPath[0])
+	{
+		LV2_State_Map_Path* mapPath = getMapPath (features);
+		char* path = (mapPath ? mapPath->abstract_path (mapPath->handle, userBankPath) : NULL);
+		if (path)
+		{
+			store (handle, uris.bankFile, path, strlen (path) + 1, uris.atom_Path, LV2_STATE_IS_POD);
+			free (path);
+		}
+		else store (handle, uris.bankFile, userBankPath, strlen (userBankPath) + 1, uris.atom_Path, LV2_STATE_IS_POD);
+	}
+
 	//fprintf (stderr, "BSEQuencer.lv2: State saved.\n");
 	return LV2_STATE_SUCCESS;
 }
@@ -1170,6 +2210,13 @@ LV2_State_Status BSEQuencer::state_restore (LV2_State_Retrieve_Function retrieve
 {
 	//fprintf (stderr, "BSEQuencer.lv2: state_restore ()\n");
 
+	// Restored states use the control port values
+	for (int i = 0; i < KNOBS_SIZE; ++i)
+	{
+		controllerOverride[i] = false;
+		new_controllers[i] = controllerPorts[i];
+	}
+
 	// Retrieve pad data
 	size_t   size;
 	uint32_t type;
@@ -1184,16 +2231,20 @@ LV2_State_Status BSEQuencer::state_restore (LV2_State_Retrieve_Function retrieve
 		// Clear all MIDI in
 		while (!inKeys.empty()) inKeys.pop_back();
 
-		// Clear all pads
-		for (int r = 0; r < ROWS; ++r)
+		// Clear all pads of all patterns
+		for (int p = 0; p < NR_PATTERNS; ++p)
 		{
-			for (int s = 0; s < MAXSTEPS; ++s) pads[r][s] = Pad();
+			for (int r = 0; r < ROWS; ++r)
+			{
+				for (int s = 0; s < MAXSTEPS; ++s) patterns[p][r][s] = Pad();
+			}
 		}
+		invalidatePatterns ();
 
 		// Restore pads
 		// Parse retrieved data
 		std::string padDataString = (char*) padData;
-		const std::string keywords[11] = {"id:", "ch:", "st:", "oc:", "ve:", "du:", "rg:", "rs:", "ro:", "rv:", "rd:"};
+		const std::string keywords[14] = {"id:", "ch:", "st:", "oc:", "ve:", "du:", "rg:", "rs:", "ro:", "rv:", "rd:", "ra:", "rc:", "co:"};
 		while (!padDataString.empty())
 		{
 			// Look for next "id:"
@@ -1211,83 +2262,399 @@ LV2_State_Status BSEQuencer::state_restore (LV2_State_Retrieve_Function retrieve
 			}
 
 			if (nextPos > 0) padDataString.erase (0, nextPos);
-			if ((id < 0) || (id >= MAXSTEPS * ROWS))
+			if ((id < 0) || (id >= NR_PATTERNS * MAXSTEPS * ROWS))
 			{
 				fprintf (stderr, "BSEQuencer.lv2: Restore pad state incomplete. Invalid matrix data block loaded with ID %i. Try to use the data before this id.\n", id);
 				break;
 			}
+			int pat = id / (MAXSTEPS * ROWS);
 			int row = id % ROWS;
-			int step = id / ROWS;
-			pads[row][step] = Pad (0, 0, 0, 0, 0, 1, 0, 0, 0, 0);
+			int step = (id / ROWS) % MAXSTEPS;
+			patterns[pat][row][step] = Pad (0, 0, 0, 0, 0, 1, 0, 0, 0, 0);
 
 			// Look for pad data
-			for (int i = 1; i < 11; ++i)
+			for (int i = 1; i < 14; ++i)
 			{
 				strPos = padDataString.find (keywords[i]);
 				if (strPos == std::string::npos) continue;	// Keyword not found => next keyword
+				if (strPos > padDataString.find ("id:")) continue;	// Keyword of the next pad => next keyword
 				if (strPos + 3 >= padDataString.length())	// Nothing more after keyword => end
 				{
-					padDataString ="";
-					break;
+					padDataString ="";
+					break;
+				}
+				if (strPos > 0) padDataString.erase (0, strPos + 3);
+				float val;
+				try {val = BUtilities::stof (padDataString, &nextPos);}
+				catch  (const std::exception& e)
+				{
+					fprintf (stderr, "BSEQuencer.lv2: Restore padstate incomplete. Can't parse %s from \"%s...\"",
+							 keywords[i].substr(0,2).c_str(), padDataString.substr (0, 63).c_str());
+					break;
+				}
+
+				if (nextPos > 0) padDataString.erase (0, nextPos);
+				switch (i) {
+				case 1: patterns[pat][row][step].ch = val;
+						break;
+				case 2: patterns[pat][row][step].pitchNote = val;
+						break;
+				case 3: patterns[pat][row][step].pitchOctave = val;
+						break;
+				case 4:	patterns[pat][row][step].velocity = val;
+						break;
+				case 5:	patterns[pat][row][step].duration = val;
+						break;
+				case 6:	patterns[pat][row][step].randGate = val;
+						break;
+				case 7:	patterns[pat][row][step].randNote = val;
+						break;
+				case 8:	patterns[pat][row][step].randOctave = val;
+						break;
+				case 9:	patterns[pat][row][step].randVelocity = val;
+						break;
+				case 10:patterns[pat][row][step].randDuration = val;
+						break;
+				case 11:patterns[pat][row][step].ratchet = val;
+						break;
+				case 12:patterns[pat][row][step].ratchetCurve = val;
+						break;
+				case 13:patterns[pat][row][step].condition = val;
+						break;
+				default:break;
+				}
+			}
+		}
+
+
+		// Validate all pads
+		for (int p = 0; p < NR_PATTERNS; ++p)
+		{
+			for (int i = 0; i < ROWS; ++i)
+			{
+				for (int j = 0; j < MAXSTEPS; ++j)
+				{
+					Pad valPad = validatePad (patterns[p][i][j]);
+					if (valPad != patterns[p][i][j])
+					{
+						fprintf (stderr, "BSEQuencer.lv2: Pad out of range in state_restore (): patterns[%i][%i][%i].\n", p, i, j);
+						patterns[p][i][j] = valPad;
+					}
+				}
+			}
+		}
+
+		// Copy all to padMessageBuffer for submission to GUI
+		padMessageBufferAllPads ();
+
+		// Force GUI notification
+		scheduleNotifyPadsToGui = true;
+	}
+
+	// Restore row properties
+	// Missing row data (older states) => default properties
+	for (int p = 0; p < NR_PATTERNS; ++p)
+	{
+		for (int r = 0; r < ROWS; ++r) patternRows[p][r] = RowProperties ();
+	}
+	const void* rowData = retrieve(handle, uris.state_rows, &size, &type, &valflags);
+
+	if (rowData && (type == uris.atom_String))
+	{
+		std::string rowDataString = (char*) rowData;
+		const std::string keywords[4] = {"id:", "le:", "mu:", "dv:"};
+		while (!rowDataString.empty())
+		{
+			// Look for next "id:"
+			size_t strPos = rowDataString.find ("id:");
+			size_t nextPos = 0;
+			if (strPos == std::string::npos) break;	// No "id:" found => end
+			if (strPos + 3 > rowDataString.length()) break;	// Nothing more after id => end
+			rowDataString.erase (0, strPos + 3);
+			int id;
+			try {id = BUtilities::stof (rowDataString, &nextPos);}
+			catch  (const std::exception& e)
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore row state incomplete. Can't parse ID from \"%s...\"", rowDataString.substr (0, 63).c_str());
+				break;
+			}
+
+			if (nextPos > 0) rowDataString.erase (0, nextPos);
+			if ((id < 0) || (id >= NR_PATTERNS * ROWS))
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore row state incomplete. Invalid row data block loaded with ID %i.\n", id);
+				break;
+			}
+			RowProperties& props = patternRows[id / ROWS][id % ROWS];
+
+			// Look for row data
+			for (int i = 1; i < 4; ++i)
+			{
+				strPos = rowDataString.find (keywords[i]);
+				if (strPos == std::string::npos) continue;	// Keyword not found => next keyword
+				if (strPos > rowDataString.find ("id:")) continue;	// Keyword of the next row => next keyword
+				if (strPos + 3 >= rowDataString.length())	// Nothing more after keyword => end
+				{
+					rowDataString ="";
+					break;
+				}
+				if (strPos > 0) rowDataString.erase (0, strPos + 3);
+				float val;
+				try {val = BUtilities::stof (rowDataString, &nextPos);}
+				catch  (const std::exception& e)
+				{
+					fprintf (stderr, "BSEQuencer.lv2: Restore row state incomplete. Can't parse %s from \"%s...\"",
+							 keywords[i].substr(0,2).c_str(), rowDataString.substr (0, 63).c_str());
+					break;
+				}
+
+				if (nextPos > 0) rowDataString.erase (0, nextPos);
+				switch (i) {
+				case 1: props.length = val;
+						break;
+				case 2: props.multiplier = val;
+						break;
+				case 3: props.divider = val;
+						break;
+				default:break;
+				}
+			}
+
+			RowProperties valProps = validateRow (props);
+			if (valProps != props)
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Row properties out of range in state_restore (): rows[%i].\n", id);
+				props = valProps;
+			}
+		}
+	}
+
+	// Force GUI notification
+	scheduleNotifyRowsToGui = true;
+
+	// Restore pattern chain
+	// Missing pattern data (older states) => each pattern repeats itself
+	for (int p = 0; p < NR_PATTERNS; ++p) patternChain[p] = NO_PATTERN;
+	const void* patternData = retrieve(handle, uris.state_patterns, &size, &type, &valflags);
+
+	if (patternData && (type == uris.atom_String))
+	{
+		std::string patternDataString = (char*) patternData;
+		while (!patternDataString.empty())
+		{
+			// Look for next "id:" and "nx:"
+			size_t strPos = patternDataString.find ("id:");
+			size_t nextPos = 0;
+			if (strPos == std::string::npos) break;	// No "id:" found => end
+			if (strPos + 3 > patternDataString.length()) break;	// Nothing more after id => end
+			patternDataString.erase (0, strPos + 3);
+			int id, nx;
+			try
+			{
+				id = BUtilities::stof (patternDataString, &nextPos);
+				if (nextPos > 0) patternDataString.erase (0, nextPos);
+				strPos = patternDataString.find ("nx:");
+				if ((strPos == std::string::npos) || (strPos + 3 >= patternDataString.length())) break;
+				patternDataString.erase (0, strPos + 3);
+				nx = BUtilities::stof (patternDataString, &nextPos);
+				if (nextPos > 0) patternDataString.erase (0, nextPos);
+			}
+			catch  (const std::exception& e)
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore pattern state incomplete. Can't parse data from \"%s...\"", patternDataString.substr (0, 63).c_str());
+				break;
+			}
+
+			if ((id < 0) || (id >= NR_PATTERNS) || (nx < NO_PATTERN) || (nx >= NR_PATTERNS))
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore pattern state incomplete. Invalid pattern data block loaded with ID %i.\n", id);
+				break;
+			}
+			patternChain[id] = nx;
+		}
+	}
+
+	// Force GUI notification
+	scheduleNotifyChainToGui = true;
+
+	// Restore user groove
+	// Missing groove data (older states) => no groove. The groove size is
+	// defined by the highest step number. Steps without data are straight.
+	userGroove = defaultGrooves[GROOVE_USER];
+	const void* grooveData = retrieve(handle, uris.state_groove, &size, &type, &valflags);
+
+	if (grooveData && (type == uris.atom_String))
+	{
+		std::string grooveDataString = (char*) grooveData;
+		const std::string keywords[3] = {"st:", "tm:", "ve:"};
+		for (int i = 0; i < MAXSTEPS; ++i)
+		{
+			userGroove.timing[i] = 0.0f;
+			userGroove.velocity[i] = 1.0f;
+		}
+
+		while (!grooveDataString.empty())
+		{
+			// Look for next "st:"
+			size_t strPos = grooveDataString.find ("st:");
+			size_t nextPos = 0;
+			if (strPos == std::string::npos) break;	// No "st:" found => end
+			if (strPos + 3 > grooveDataString.length()) break;	// Nothing more after st => end
+			grooveDataString.erase (0, strPos + 3);
+			int step;
+			try {step = BUtilities::stof (grooveDataString, &nextPos);}
+			catch  (const std::exception& e)
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore groove state incomplete. Can't parse step from \"%s...\"", grooveDataString.substr (0, 63).c_str());
+				break;
+			}
+
+			if (nextPos > 0) grooveDataString.erase (0, nextPos);
+			if ((step < 0) || (step >= MAXSTEPS))
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore groove state incomplete. Invalid groove data block loaded with step %i.\n", step);
+				break;
+			}
+			if (step >= userGroove.size) userGroove.size = step + 1;
+
+			// Look for groove data
+			for (int i = 1; i < 3; ++i)
+			{
+				strPos = grooveDataString.find (keywords[i]);
+				if (strPos == std::string::npos) continue;	// Keyword not found => next keyword
+				if (strPos + 3 >= grooveDataString.length())	// Nothing more after keyword => end
+				{
+					grooveDataString ="";
+					break;
+				}
+				if (strPos > 0) grooveDataString.erase (0, strPos + 3);
+				float val;
+				try {val = BUtilities::stof (grooveDataString, &nextPos);}
+				catch  (const std::exception& e)
+				{
+					fprintf (stderr, "BSEQuencer.lv2: Restore groove state incomplete. Can't parse %s from \"%s...\"",
+							 keywords[i].substr(0,2).c_str(), grooveDataString.substr (0, 63).c_str());
+					break;
+				}
+
+				if (nextPos > 0) grooveDataString.erase (0, nextPos);
+				switch (i) {
+				case 1: userGroove.timing[step] = LIMIT (val, -MAX_GROOVE_TIMING, MAX_GROOVE_TIMING);
+						break;
+				case 2: userGroove.velocity[step] = LIMIT (val, MIN_GROOVE_VELOCITY, MAX_GROOVE_VELOCITY);
+						break;
+				default:break;
+				}
+			}
+		}
+	}
+
+	updateGroove ();
+
+	// Restore automation lanes
+	// Missing automation data (older states) => no automation
+	for (int p = 0; p < NR_PATTERNS; ++p)
+	{
+		for (int c = 0; c < NR_SEQUENCER_CHS; ++c) patternAutomation[p][c] = AutomationLane ();
+	}
+	const void* automationData = retrieve(handle, uris.state_automation, &size, &type, &valflags);
+
+	if (automationData && (type == uris.atom_String))
+	{
+		std::string automationDataString = (char*) automationData;
+		const std::string keywords[6] = {"id:", "ty:", "cc:", "ip:", "ra:", "va:"};
+		while (!automationDataString.empty())
+		{
+			// Look for next "id:"
+			size_t strPos = automationDataString.find ("id:");
+			size_t nextPos = 0;
+			if (strPos == std::string::npos) break;	// No "id:" found => end
+			if (strPos + 3 > automationDataString.length()) break;	// Nothing more after id => end
+			automationDataString.erase (0, strPos + 3);
+			int id;
+			try {id = BUtilities::stof (automationDataString, &nextPos);}
+			catch  (const std::exception& e)
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore automation state incomplete. Can't parse ID from \"%s...\"", automationDataString.substr (0, 63).c_str());
+				break;
+			}
+
+			if (nextPos > 0) automationDataString.erase (0, nextPos);
+			if ((id < 0) || (id >= NR_PATTERNS * NR_SEQUENCER_CHS))
+			{
+				fprintf (stderr, "BSEQuencer.lv2: Restore automation state incomplete. Invalid automation data block loaded with ID %i.\n", id);
+				break;
+			}
+			AutomationLane& lane = patternAutomation[id / NR_SEQUENCER_CHS][id % NR_SEQUENCER_CHS];
+
+			// Look for automation data
+			for (int i = 1; i < 6; ++i)
+			{
+				strPos = automationDataString.find (keywords[i]);
+				if (strPos == std::string::npos) continue;	// Keyword not found => next keyword
+				if (strPos > automationDataString.find ("id:")) continue;	// Keyword belongs to the next lane => next keyword
+				if (strPos + 3 >= automationDataString.length())	// Nothing more after keyword => end
+				{
+					automationDataString ="";
+					break;
+				}
+				automationDataString.erase (0, strPos + 3);
+
+				// Node values
+				if (i == 5)
+				{
+					for (int step = 0; step < MAXSTEPS; ++step)
+					{
+						try {lane.values[step] = BUtilities::stof (automationDataString, &nextPos);}
+						catch (const std::exception& e)
+						{
+							fprintf (stderr, "BSEQuencer.lv2: Restore automation state incomplete. Incomplete automation data block loaded with ID %i.\n", id);
+							break;
+						}
+
+						automationDataString.erase (0, nextPos);
+						nextPos = automationDataString.find (";");
+						automationDataString.erase (0, nextPos + 1);
+					}
+					continue;
 				}
-				if (strPos > 0) padDataString.erase (0, strPos + 3);
+
 				float val;
-				try {val = BUtilities::stof (padDataString, &nextPos);}
+				try {val = BUtilities::stof (automationDataString, &nextPos);}
 				catch  (const std::exception& e)
 				{
-					fprintf (stderr, "BSEQuencer.lv2: Restore padstate incomplete. Can't parse %s from \"%s...\"",
-							 keywords[i].substr(0,2).c_str(), padDataString.substr (0, 63).c_str());
+					fprintf (stderr, "BSEQuencer.lv2: Restore automation state incomplete. Can't parse %s from \"%s...\"",
+							 keywords[i].substr(0,2).c_str(), automationDataString.substr (0, 63).c_str());
 					break;
 				}
 
-				if (nextPos > 0) padDataString.erase (0, nextPos);
+				if (nextPos > 0) automationDataString.erase (0, nextPos);
 				switch (i) {
-				case 1: pads[row][step].ch = val;
-						break;
-				case 2: pads[row][step].pitchNote = val;
-						break;
-				case 3: pads[row][step].pitchOctave = val;
+				case 1: lane.type = val;
 						break;
-				case 4:	pads[row][step].velocity = val;
+				case 2: lane.controller = val;
 						break;
-				case 5:	pads[row][step].duration = val;
+				case 3: lane.interpolation = val;
 						break;
-				case 6:	pads[row][step].randGate = val;
-						break;
-				case 7:	pads[row][step].randNote = val;
-						break;
-				case 8:	pads[row][step].randOctave = val;
-						break;
-				case 9:	pads[row][step].randVelocity = val;
-						break;
-				case 10:pads[row][step].randDuration = val;
+				case 4: lane.rate = val;
 						break;
 				default:break;
 				}
 			}
-		}
-
 
-		// Validate all pads
-		for (int i = 0; i < ROWS; ++i)
-		{
-			for (int j = 0; j < MAXSTEPS; ++j)
+			AutomationLane valLane = validateAutomation (lane);
+			if (valLane != lane)
 			{
-				Pad valPad = validatePad (pads[i][j]);
-				if (valPad != pads[i][j])
-				{
-					fprintf (stderr, "BSEQuencer.lv2: Pad out of range in state_restore (): pads[%i][%i].\n", i, j);
-					pads[i][j] = valPad;
-				}
+				fprintf (stderr, "BSEQuencer.lv2: Automation lane out of range in state_restore (): lanes[%i].\n", id);
+				lane = valLane;
 			}
 		}
+	}
 
-		// Copy all to padMessageBuffer for submission to GUI
-		padMessageBufferAllPads ();
+	invalidateAutomation ();
 
-		// Force GUI notification
-		scheduleNotifyPadsToGui = true;
-	}
+	// Force GUI notification
+	scheduleNotifyAutomationToGui = true;
 
 	// Restore user scales
 	const void* scaleData = retrieve(handle, uris.state_scales, &size, &type, &valflags);
@@ -1442,9 +2809,42 @@ LV2_State_Status BSEQuencer::state_restore (LV2_State_Retrieve_Function retrieve
 		scheduleNotifyScaleMapsToGui = true;
 	}
 
+	// Restore user preset bank. Not called concurrently with run (): Load
+	// it directly
+	const void* bankFileData = retrieve (handle, uris.bankFile, &size, &type, &valflags);
+	if (bankFileData && (type == uris.atom_Path) && (size > 1))
+	{
+		LV2_State_Map_Path* mapPath = getMapPath (features);
+		char* absPath = (mapPath ? mapPath->absolute_path (mapPath->handle, (const char*) bankFileData) : NULL);
+		const std::string path = (absPath ? absPath : (const char*) bankFileData);
+		if (absPath) free (absPath);
+
+		if ((path.size () < BANK_PATH_SIZE) && (path != userBankPath))
+		{
+			PresetBank* bank = new PresetBank ();
+			if (bank->load (path))
+			{
+				if (userBank) delete userBank;
+				userBank = bank;
+				strncpy (userBankPath, path.c_str (), BANK_PATH_SIZE - 1);
+			}
+			else delete bank;
+		}
+	}
+	else if (userBank)
+	{
+		delete userBank;
+		userBank = nullptr;
+		userBankPath[0] = 0;
+	}
+
 	// Force GUI notification
 	scheduleNotifyStatusToGui = true;
 
+	// The state already contains the changes made after loading a bank
+	// preset: Don't load the preset again
+	if (new_controllers[PRESET]) controllers[PRESET] = *new_controllers[PRESET];
+
 	return LV2_STATE_SUCCESS;
 }
 
@@ -1453,6 +2853,379 @@ void BSEQuencer::activate ()
 	inKeys.clear ();
 }
 
+/*
+ * Sets the seed of the random generator (gate, note, octave, velocity and
+ * duration randomization). Used by SMFExport for reproducible renderings.
+ */
+void BSEQuencer::seed (const uint32_t value)
+{
+	rnd.seed (value);
+}
+
+/*
+ * Appends the current state (pads, rows, pattern chain, user groove,
+ * automation and scale maps) together with the passed controller values as
+ * a new preset to a preset bank. Only non-empty pads and non-default rows,
+ * lanes and scale maps are stored. Used by PresetBankCompiler, not real
+ * time safe.
+ */
+void BSEQuencer::appendBankPreset (std::vector<uint32_t>& bank, const std::string& name, const float* presetControllers)
+{
+	// New bank: Init header
+	if (bank.size () * sizeof (uint32_t) < sizeof (PresetBankHeader))
+	{
+		PresetBankHeader header;
+		memset (&header, 0, sizeof (header));
+		strncpy (header.id, PRESET_BANK_ID, 8);
+		header.version = PRESET_BANK_VERSION;
+		header.presetSize = sizeof (PresetBankPreset);
+		header.padSize = sizeof (PresetBankPad);
+		header.rowSize = sizeof (PresetBankRow);
+		header.laneSize = sizeof (PresetBankLane);
+		header.scaleMapSize = sizeof (PresetBankScaleMap);
+		bank.assign ((sizeof (PresetBankHeader) + 3) / 4, 0);
+		memcpy (bank.data (), &header, sizeof (header));
+	}
+
+	std::vector<PresetBankPad> bankPads;
+	std::vector<PresetBankRow> bankRows;
+	std::vector<PresetBankLane> bankLanes;
+	std::vector<PresetBankScaleMap> bankScaleMaps;
+
+	for (int p = 0; p < NR_PATTERNS; ++p)
+	{
+		for (int r = 0; r < ROWS; ++r)
+		{
+			for (int s = 0; s < MAXSTEPS; ++s)
+			{
+				if (patterns[p][r][s].ch == 0) continue;
+				PresetBankPad bankPad;
+				bankPad.id = (p * MAXSTEPS + s) * ROWS + r;
+				bankPad.pad = patterns[p][r][s];
+				bankPads.push_back (bankPad);
+			}
+
+			if (patternRows[p][r] != RowProperties ())
+			{
+				PresetBankRow bankRow;
+				bankRow.id = p * ROWS + r;
+				bankRow.props = patternRows[p][r];
+				bankRows.push_back (bankRow);
+			}
+		}
+
+		for (int c = 0; c < NR_SEQUENCER_CHS; ++c)
+		{
+			if (patternAutomation[p][c] != AutomationLane ())
+			{
+				PresetBankLane bankLane;
+				bankLane.id = p * NR_SEQUENCER_CHS + c;
+				bankLane.lane = patternAutomation[p][c];
+				bankLanes.push_back (bankLane);
+			}
+		}
+	}
+
+	for (int i = 0; i < NR_SYSTEM_SCALES + NR_USER_SCALES; ++i)
+	{
+		PresetBankScaleMap bankScaleMap;
+		memset (&bankScaleMap, 0, sizeof (bankScaleMap));
+		bankScaleMap.map = defaultScaleMaps[i];
+		const RTScaleMap& m = rtScaleMaps[i];
+		bool changed =
+		(
+			(m.iD != bankScaleMap.map.iD) ||
+			(strncmp (m.name, bankScaleMap.map.name, 64) != 0) ||
+			(memcmp (m.elements, bankScaleMap.map.elements, sizeof (m.elements)) != 0) ||
+			(m.scaleNotes != bankScaleMap.map.scaleNotes)
+		);
+		for (int j = 0; j < ROWS; ++j) changed = changed || (strncmp (m.altSymbols[j], bankScaleMap.map.altSymbols[j], 16) != 0);
+		if (!changed) continue;
+
+		bankScaleMap.index = i;
+		bankScaleMap.map = m;
+
+		// Zero-padded strings: Reproducible bank data
+		memset (bankScaleMap.map.name, 0, sizeof (bankScaleMap.map.name));
+		strncpy (bankScaleMap.map.name, m.name, 63);
+		for (int j = 0; j < ROWS; ++j)
+		{
+			memset (bankScaleMap.map.altSymbols[j], 0, 16);
+			strncpy (bankScaleMap.map.altSymbols[j], m.altSymbols[j], 15);
+		}
+		bankScaleMaps.push_back (bankScaleMap);
+	}
+
+	PresetBankPreset preset;
+	memset (&preset, 0, sizeof (preset));
+	strncpy (preset.name, name.c_str (), 63);
+	preset.nrPads = bankPads.size ();
+	preset.nrRows = bankRows.size ();
+	preset.nrLanes = bankLanes.size ();
+	preset.nrScaleMaps = bankScaleMaps.size ();
+	memcpy (preset.controllers, presetControllers, KNOBS_SIZE * sizeof (float));
+	preset.controllers[PRESET] = 0;
+	for (int i = 0; i < NR_PATTERNS; ++i) preset.chain[i] = patternChain[i];
+	preset.groove = userGroove;
+	preset.size = PresetBank::getSize (&preset);
+
+	// Copy to bank
+	const size_t pos = bank.size ();
+	bank.resize (pos + (preset.size + 3) / 4, 0);
+	uint8_t* dest = (uint8_t*) (bank.data () + pos);
+	memcpy (dest, &preset, sizeof (preset));
+	dest += sizeof (preset);
+	memcpy (dest, bankPads.data (), bankPads.size () * sizeof (PresetBankPad));
+	dest += bankPads.size () * sizeof (PresetBankPad);
+	memcpy (dest, bankRows.data (), bankRows.size () * sizeof (PresetBankRow));
+	dest += bankRows.size () * sizeof (PresetBankRow);
+	memcpy (dest, bankLanes.data (), bankLanes.size () * sizeof (PresetBankLane));
+	dest += bankLanes.size () * sizeof (PresetBankLane);
+	memcpy (dest, bankScaleMaps.data (), bankScaleMaps.size () * sizeof (PresetBankScaleMap));
+
+	((PresetBankHeader*) bank.data ())->nrPresets++;
+}
+
+/*
+ * Sets the user groove from the notes of a Standard MIDI File (see
+ * GrooveImport.hpp).
+ * @param path		Path of the Standard MIDI File
+ * @param stepsPerBeat	Step grid
+ * @param size		Groove cycle size in steps
+ * @return		True on success
+ */
+bool BSEQuencer::importGroove (const std::string& path, const double stepsPerBeat, const int size)
+{
+	Groove groove;
+	if (!readGroove (path, stepsPerBeat, size, groove)) return false;
+	userGroove = groove;
+	updateGroove ();
+	return true;
+}
+
+/*
+ * Imports a Standard MIDI File track into a pattern. The notes are mapped
+ * to the rows of the scale map selected in the passed controller values.
+ * Used by the SMFImport tool, not real time safe.
+ * @param path			Path of the Standard MIDI File
+ * @param settings		Import settings
+ * @param pattern		Target pattern (0..NR_PATTERNS - 1)
+ * @param presetControllers	Controller values (scale, root, channel
+ *				note offset)
+ * @return			True on success
+ */
+bool BSEQuencer::importSMF (const std::string& path, const SMFImportSettings& settings, const int pattern, const float* presetControllers)
+{
+	if ((pattern < 0) || (pattern >= NR_PATTERNS)) return false;
+
+	const int scaleNr = LIMIT (presetControllers[SCALE], 0, NR_SYSTEM_SCALES + NR_USER_SCALES - 1);
+	const int ch = LIMIT (settings.ch, 1, NR_SEQUENCER_CHS);
+	BScale importScale
+	(
+		presetControllers[ROOT] + presetControllers[SIGNATURE] + (presetControllers[OCTAVE] + 1) * 12,
+		rtScaleMaps[scaleNr].scaleNotes
+	);
+	SMFImport importer (rtScaleMaps[scaleNr].elements, importScale, presetControllers[CH + (ch - 1) * CH_SIZE + NOTE_OFFSET]);
+	patternCompiled[pattern] = false;
+	return importer.import (path, settings, patterns[pattern]);
+}
+
+/*
+ * Loads a preset from the user preset bank (if loaded) or the built-in
+ * preset bank. The preset data are copied from the bank without any
+ * parsing. The preset controller values are sent to the GUI, which sets the
+ * plugin control ports.
+ * @param index		Preset index (0..bank size - 1)
+ */
+void BSEQuencer::loadBankPreset (const int index)
+{
+	const PresetBankPreset* preset = (userBank ? userBank->getPreset (index) : presetBank.getPreset (index));
+	if (!preset) return;
+
+	stopMidiOut (0, ALL_CH);
+
+	// Reset pattern data
+	invalidatePatterns ();
+	for (int p = 0; p < NR_PATTERNS; ++p)
+	{
+		for (int r = 0; r < ROWS; ++r)
+		{
+			for (int s = 0; s < MAXSTEPS; ++s) patterns[p][r][s] = Pad ();
+			patternRows[p][r] = RowProperties ();
+		}
+
+		for (int c = 0; c < NR_SEQUENCER_CHS; ++c) patternAutomation[p][c] = AutomationLane ();
+		patternChain[p] = LIMIT (preset->chain[p], NO_PATTERN, NR_PATTERNS - 1);
+	}
+
+	// Copy pattern data
+	const PresetBankPad* bankPads = PresetBank::getPads (preset);
+	for (uint32_t i = 0; i < preset->nrPads; ++i)
+	{
+		const int id = bankPads[i].id;
+		if ((id < 0) || (id >= NR_PATTERNS * MAXSTEPS * ROWS)) continue;
+		patterns[id / (MAXSTEPS * ROWS)][id % ROWS][(id / ROWS) % MAXSTEPS] = validatePad (bankPads[i].pad);
+	}
+
+	const PresetBankRow* bankRows = PresetBank::getRows (preset);
+	for (uint32_t i = 0; i < preset->nrRows; ++i)
+	{
+		const int id = bankRows[i].id;
+		if ((id < 0) || (id >= NR_PATTERNS * ROWS)) continue;
+		patternRows[id / ROWS][id % ROWS] = validateRow (bankRows[i].props);
+	}
+
+	const PresetBankLane* bankLanes = PresetBank::getLanes (preset);
+	for (uint32_t i = 0; i < preset->nrLanes; ++i)
+	{
+		const int id = bankLanes[i].id;
+		if ((id < 0) || (id >= NR_PATTERNS * NR_SEQUENCER_CHS)) continue;
+		patternAutomation[id / NR_SEQUENCER_CHS][id % NR_SEQUENCER_CHS] = validateAutomation (bankLanes[i].lane);
+	}
+	invalidateAutomation ();
+
+	// Groove
+	userGroove = preset->groove;
+	userGroove.size = LIMIT (userGroove.size, 1, MAXSTEPS);
+	updateGroove ();
+
+	// Scale maps
+	for (int i = 0; i < NR_SYSTEM_SCALES + NR_USER_SCALES; ++i) rtScaleMaps[i] = defaultScaleMaps[i];
+	const PresetBankScaleMap* bankScaleMaps = PresetBank::getScaleMaps (preset);
+	for (uint32_t i = 0; i < preset->nrScaleMaps; ++i)
+	{
+		const int nr = bankScaleMaps[i].index;
+		if ((nr >= 0) && (nr < NR_SYSTEM_SCALES + NR_USER_SCALES)) rtScaleMaps[nr] = bankScaleMaps[i].map;
+	}
+
+	// Controllers: Override the control ports with the preset values until
+	// the host changes them (e.g., the GUI applies the preset values). The
+	// changed controllers are applied with the next run (). Keep transport
+	// and the way presets are selected.
+	for (int i = 0; i < KNOBS_SIZE; ++i)
+	{
+		bankControllers[i] = validateValue (preset->controllers[i], controllerLimits[i]);
+		if ((i == PLAY) || (i == PRESET) || (i == PATTERN_SELECT) || (i == PATTERN_KEYS)) continue;
+		controllerOverride[i] = true;
+		controllerOverrideBase[i] = (controllerPorts[i] ? *controllerPorts[i] : 0.0f);
+		new_controllers[i] = &bankControllers[i];
+	}
+
+	// Scale: Already use the new scale for the rest of this cycle
+	controllers[SCALE] = bankControllers[SCALE];
+	controllers[ROOT] = bankControllers[ROOT];
+	controllers[SIGNATURE] = bankControllers[SIGNATURE];
+	controllers[OCTAVE] = bankControllers[OCTAVE];
+	scale.setScale (rtScaleMaps[int (controllers[SCALE])].scaleNotes);
+	scale.setRoot (controllers[ROOT] + controllers[SIGNATURE] + (controllers[OCTAVE] + 1) * 12);
+
+	padMessageBufferAllPads ();
+	scheduleNotifyPadsToGui = true;
+	scheduleNotifyRowsToGui = true;
+	scheduleNotifyChainToGui = true;
+	scheduleNotifyAutomationToGui = true;
+	scheduleNotifyScaleMapsToGui = true;
+	scheduleNotifyControllersToGui = true;
+	scheduleNotifyStatusToGui = true;
+}
+
+/*
+ * Schedules loading a user preset bank file in the worker. Real time safe.
+ * @param path	Path (not necessarily null-terminated)
+ * @param size	Size of path incl. the terminating null (if any)
+ */
+void BSEQuencer::scheduleLoadBank (const char* path, const uint32_t size)
+{
+	if (!workerSchedule)
+	{
+		fprintf (stderr, "BSEQuencer.lv2: Host does not support worker:schedule. Can't load preset bank.\n");
+		return;
+	}
+
+	if ((size == 0) || (size > BANK_PATH_SIZE) || ((size == BANK_PATH_SIZE) && (path[size - 1] != 0)))
+	{
+		fprintf (stderr, "BSEQuencer.lv2: Invalid preset bank path.\n");
+		return;
+	}
+
+	BankWorkerMessage message;
+	message.type = BANK_LOAD;
+	message.bank = nullptr;
+	memset (message.path, 0, BANK_PATH_SIZE);
+	memcpy (message.path, path, size);
+	workerSchedule->schedule_work (workerSchedule->handle, sizeof (message), &message);
+}
+
+/*
+ * Worker: Loads user preset bank files (BANK_LOAD) and deletes replaced
+ * banks (BANK_FREE). Loaded banks are handed over to work_response.
+ */
+LV2_Worker_Status BSEQuencer::work (LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+{
+	if (size != sizeof (BankWorkerMessage)) return LV2_WORKER_ERR_UNKNOWN;
+	BankWorkerMessage message = *((const BankWorkerMessage*) data);
+
+	switch (message.type)
+	{
+		case BANK_LOAD:
+		{
+			PresetBank* bank = new PresetBank ();
+			if (!bank->load (message.path))
+			{
+				delete bank;
+				return LV2_WORKER_ERR_UNKNOWN;
+			}
+
+			message.type = BANK_LOADED;
+			message.bank = bank;
+			if (respond (handle, sizeof (message), &message) != LV2_WORKER_SUCCESS)
+			{
+				delete bank;
+				return LV2_WORKER_ERR_NO_SPACE;
+			}
+		}
+		break;
+
+		case BANK_FREE:
+			if (message.bank) delete message.bank;
+			break;
+
+		default:
+			return LV2_WORKER_ERR_UNKNOWN;
+	}
+
+	return LV2_WORKER_SUCCESS;
+}
+
+/*
+ * Worker response (called by the host in the real time thread): Replaces
+ * the user preset bank by the loaded one. The replaced bank is deleted by
+ * the worker.
+ */
+LV2_Worker_Status BSEQuencer::work_response (uint32_t size, const void* data)
+{
+	if (size != sizeof (BankWorkerMessage)) return LV2_WORKER_ERR_UNKNOWN;
+	BankWorkerMessage message = *((const BankWorkerMessage*) data);
+	if ((message.type != BANK_LOADED) || (!message.bank)) return LV2_WORKER_ERR_UNKNOWN;
+
+	PresetBank* oldBank = userBank;
+	userBank = message.bank;
+	memcpy (userBankPath, message.path, BANK_PATH_SIZE);
+	userBankPath[BANK_PATH_SIZE - 1] = 0;
+
+	if (oldBank && workerSchedule)
+	{
+		message.type = BANK_FREE;
+		message.bank = oldBank;
+		if (workerSchedule->schedule_work (workerSchedule->handle, sizeof (message), &message) != LV2_WORKER_SUCCESS)
+		{
+			fprintf (stderr, "BSEQuencer.lv2: Can't schedule freeing the replaced preset bank.\n");
+		}
+	}
+
+	return LV2_WORKER_SUCCESS;
+}
+
 /*
  * Checks if a value is within a limit, and if not, puts the value within
  * this limit.
@@ -1482,12 +3255,50 @@ Pad BSEQuencer::validatePad (Pad pad)
 		validateValue (pad.randNote, controllerLimits[SELECTION_NOTE_RAND]),
 		validateValue (pad.randOctave, controllerLimits[SELECTION_OCTAVE_RAND]),
 		validateValue (pad.randVelocity, controllerLimits[SELECTION_VELOCITY_RAND]),
-		validateValue (pad.randDuration, controllerLimits[SELECTION_DURATION_RAND])
+		validateValue (pad.randDuration, controllerLimits[SELECTION_DURATION_RAND]),
+		validateValue (pad.ratchet, controllerLimits[SELECTION_RATCHET]),
+		validateValue (pad.ratchetCurve, controllerLimits[SELECTION_RATCHET_CURVE]),
+		validateValue (pad.condition, controllerLimits[SELECTION_CONDITION])
+	);
+}
+
+/*
+ * Validates the properties of a single row
+ */
+RowProperties BSEQuencer::validateRow (RowProperties props)
+{
+	return RowProperties
+	(
+		validateValue (props.length, {0, MAXSTEPS, 1}),
+		validateValue (props.multiplier, {1, MAX_ROW_MULTIPLIER, 1}),
+		validateValue (props.divider, {1, MAX_ROW_DIVIDER, 1})
 	);
 }
 
 /*
- * Appends a single pad to padMessageBuffer
+ * Validates an automation lane. Node values out of range are removed.
+ */
+AutomationLane BSEQuencer::validateAutomation (AutomationLane lane)
+{
+	AutomationLane valLane
+	(
+		validateValue (lane.type, {AUTOMATION_OFF, AUTOMATION_AFTERTOUCH, 1}),
+		validateValue (lane.controller, {0, 127, 1}),
+		validateValue (lane.interpolation, {INTERPOLATION_STEP, INTERPOLATION_EXP, 1}),
+		validateValue (lane.rate, {MIN_AUTOMATION_RATE, MAX_AUTOMATION_RATE, 1})
+	);
+
+	for (int i = 0; i < MAXSTEPS; ++i)
+	{
+		if ((lane.values[i] >= 0.0f) && (lane.values[i] <= 1.0f)) valLane.values[i] = lane.values[i];
+	}
+
+	return valLane;
+}
+
+/*
+ * Appends a single pad to padMessageBuffer. A message for the same pad
+ * not sent yet is replaced instead.
  */
 bool BSEQuencer::padMessageBufferAppendPad (int row, int step, Pad pad)
 {
@@ -1495,12 +3306,19 @@ bool BSEQuencer::padMessageBufferAppendPad (int row, int step, Pad pad)
 	PadMessage msg = PadMessage
 	(
 		step, row, pad.ch, pad.pitchNote, pad.pitchOctave, pad.velocity, pad.duration,
-		pad.randGate, pad.randNote, pad.randOctave, pad.randVelocity, pad.randDuration
+		pad.randGate, pad.randNote, pad.randOctave, pad.randVelocity, pad.randDuration,
+		pad.ratchet, pad.ratchetCurve, pad.condition
 	);
 
-	for (int i = 0; i < MAXSTEPS * ROWS; ++i)
+	for (int i = padMessageCursor; i < MAXSTEPS * ROWS; ++i)
 	{
-		if (padMessageBuffer[i] != end)
+		if ((padMessageBuffer[i].step == msg.step) && (padMessageBuffer[i].row == msg.row))
+		{
+			padMessageBuffer[i] = msg;
+			return true;
+		}
+
+		if (padMessageBuffer[i] == end)
 		{
 			padMessageBuffer[i] = msg;
 			if (i < MAXSTEPS * ROWS - 1) padMessageBuffer[i + 1] = end;
@@ -1512,49 +3330,159 @@ bool BSEQuencer::padMessageBufferAppendPad (int row, int step, Pad pad)
 
 
 /*
- * Copies all pads to padMessageBuffer (thus overwrites it!)
+ * Copies all non-empty pads (ch != 0, as in state_save) to padMessageBuffer
+ * (thus overwrites it!) and starts a full pad sync. The GUI resets all pads
+ * on the sync begin marker.
  */
 void BSEQuencer::padMessageBufferAllPads ()
 {
+	int nr = 0;
 	for (int i = 0; i < MAXSTEPS; ++i)
 	{
 		for (int j = 0; j < ROWS; ++j)
 		{
-			Pad* pd = &(pads[j][i]);
-			padMessageBuffer[i * ROWS + j] = PadMessage
+			Pad* pd = &(patterns[int (controllers[PATTERN])][j][i]);
+			if (pd->ch == 0) continue;
+
+			padMessageBuffer[nr] = PadMessage
 			(
 				i, j, pd->ch, pd->pitchNote, pd->pitchOctave, pd->velocity, pd->duration,
-				pd->randGate, pd->randNote, pd->randOctave, pd->randVelocity, pd->randDuration
+				pd->randGate, pd->randNote, pd->randOctave, pd->randVelocity, pd->randDuration,
+				pd->ratchet, pd->ratchetCurve, pd->condition
 			);
+			++nr;
 		}
 	}
+
+	if (nr < MAXSTEPS * ROWS) padMessageBuffer[nr] = PadMessage (ENDPADMESSAGE);
+	padMessageCursor = 0;
+	padSyncPending = true;
+	padSyncRunning = false;
 }
 
+/*
+ * Sends the pad messages from padMessageCursor on in chunks of max.
+ * padMessageBytesPerCycle. Chunks are limited to the space left in the
+ * notify port. Remaining pads are sent in the next cycle(s). Full pad syncs
+ * are enclosed by begin and complete markers.
+ */
 void BSEQuencer::notifyPadsToGui ()
 {
 	PadMessage endmsg (ENDPADMESSAGE);
-	if (!(endmsg == padMessageBuffer[0]))
+
+	if (padSyncPending)
 	{
-		// Get padMessageBuffer size
-		int end = 0;
-		for (int i = 0; (i < ROWS * MAXSTEPS) && (!(padMessageBuffer[i] == endmsg)); ++i) end = i;
+		if (!notifyPadSyncToGui (PAD_SYNC_BEGIN)) return;
+		padSyncPending = false;
+		padSyncRunning = true;
+	}
+
+	// Get padMessageBuffer size
+	int end = padMessageCursor;
+	while ((end < ROWS * MAXSTEPS) && (!(padMessageBuffer[end] == endmsg))) ++end;
 
-		// Prepare forge buffer and initialize atom sequence
+	// Get chunk size
+	const uint32_t overhead = sizeof (LV2_Atom_Event) + sizeof (LV2_Atom_Object) + sizeof (LV2_Atom_Property_Body) + sizeof (LV2_Atom_Vector);
+	const uint32_t budget = std::max (padMessageBytesPerCycle, uint32_t (overhead + sizeof (PadMessage)));	// At least one pad
+	const uint32_t space = std::min (notify_forge.size - notify_forge.offset, budget);
+	int count = end - padMessageCursor;
+	if (space < overhead) count = 0;
+	else count = std::min (count, int ((space - overhead) / sizeof (PadMessage)));
 
+	if (count > 0)
+	{
 		LV2_Atom_Forge_Frame frame;
-		lv2_atom_forge_frame_time(&output_forge, 0);
-		lv2_atom_forge_object(&output_forge, &frame, 0, uris.notify_padEvent);
-		lv2_atom_forge_key(&output_forge, uris.notify_pad);
-		lv2_atom_forge_vector(&output_forge, sizeof(float), uris.atom_Float, sizeof(PadMessage) / sizeof(float) * (end + 1), (void*) padMessageBuffer);
-		lv2_atom_forge_pop(&output_forge, &frame);
+		lv2_atom_forge_frame_time(&notify_forge, 0);
+		lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_padEvent);
+		lv2_atom_forge_key(&notify_forge, uris.notify_pad);
+		lv2_atom_forge_vector(&notify_forge, sizeof(float), uris.atom_Float, sizeof(PadMessage) / sizeof(float) * count, (void*) &padMessageBuffer[padMessageCursor]);
+		lv2_atom_forge_pop(&notify_forge, &frame);
+		padMessageCursor += count;
+	}
 
-		// Empty padMessageBuffer
-		padMessageBuffer[0] = endmsg;
+	// All sent: Empty padMessageBuffer
+	if (padMessageCursor >= end)
+	{
+		if (padSyncRunning)
+		{
+			if (!notifyPadSyncToGui (PAD_SYNC_COMPLETE)) return;
+			padSyncRunning = false;
+		}
 
+		padMessageBuffer[0] = endmsg;
+		padMessageCursor = 0;
 		scheduleNotifyPadsToGui = false;
 	}
 }
 
+bool BSEQuencer::notifyPadSyncToGui (const int syncState)
+{
+	const uint32_t size = sizeof (LV2_Atom_Event) + sizeof (LV2_Atom_Object) + sizeof (LV2_Atom_Property_Body) + lv2_atom_pad_size (sizeof (LV2_Atom_Int));
+	if (notify_forge.size - notify_forge.offset < size) return false;
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_padSyncEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_padSync);
+	lv2_atom_forge_int(&notify_forge, syncState);
+	lv2_atom_forge_pop(&notify_forge, &frame);
+	return true;
+}
+
+void BSEQuencer::notifyRowsToGui ()
+{
+	RowMessage rowMessages[ROWS];
+	for (int i = 0; i < ROWS; ++i) rowMessages[i] = RowMessage (i, patternRows[int (controllers[PATTERN])][i]);
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_rowEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_row);
+	lv2_atom_forge_vector(&notify_forge, sizeof(float), uris.atom_Float, sizeof(RowMessage) / sizeof(float) * ROWS, (void*) rowMessages);
+	lv2_atom_forge_pop(&notify_forge, &frame);
+
+	scheduleNotifyRowsToGui = false;
+}
+
+void BSEQuencer::notifyChainToGui ()
+{
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_chainEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_chain);
+	lv2_atom_forge_vector(&notify_forge, sizeof (int), uris.atom_Int, NR_PATTERNS, (void*) patternChain);
+	lv2_atom_forge_pop(&notify_forge, &frame);
+
+	scheduleNotifyChainToGui = false;
+}
+
+void BSEQuencer::notifyAutomationToGui ()
+{
+	AutomationMessage automationMessages[NR_SEQUENCER_CHS];
+	for (int i = 0; i < NR_SEQUENCER_CHS; ++i) automationMessages[i] = AutomationMessage (i, patternAutomation[int (controllers[PATTERN])][i]);
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_automationEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_automation);
+	lv2_atom_forge_vector(&notify_forge, sizeof(float), uris.atom_Float, sizeof(AutomationMessage) / sizeof(float) * NR_SEQUENCER_CHS, (void*) automationMessages);
+	lv2_atom_forge_pop(&notify_forge, &frame);
+
+	scheduleNotifyAutomationToGui = false;
+}
+
+void BSEQuencer::notifyControllersToGui ()
+{
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_controllersEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_controllers);
+	lv2_atom_forge_vector(&notify_forge, sizeof(float), uris.atom_Float, KNOBS_SIZE, (void*) bankControllers);
+	lv2_atom_forge_pop(&notify_forge, &frame);
+
+	scheduleNotifyControllersToGui = false;
+}
+
 void BSEQuencer::notifyStatusToGui ()
 {
 	// Get all act. steps for all active midiInKeys -> cursorbits
@@ -1578,9 +3506,9 @@ void BSEQuencer::notifyStatusToGui ()
 
 				for (int row = 0; row < ROWS; ++row)
 				{
-					if ((inKeys[i].stepNr >= 0) && (inKeys[i].output[row].stepOffset != HALT_STEP))
+					int stepNr = inKeys[i].output[row].stepNr;
+					if ((stepNr >= 0) && (stepNr < MAXSTEPS))
 					{
-						int stepNr = (inKeys[i].stepNr + inKeys[i].output[row].stepOffset) % ((int)controllers[NR_OF_STEPS]);
 
 						// Set cursorbits
 						cursorbits[stepNr] = (cursorbits[stepNr] | (1 << row));
@@ -1596,15 +3524,17 @@ void BSEQuencer::notifyStatusToGui ()
 	// Prepare forge buffer and initialize atom sequence
 
 	LV2_Atom_Forge_Frame frame;
-	lv2_atom_forge_frame_time(&output_forge, 0);
-	lv2_atom_forge_object(&output_forge, &frame, 0, uris.notify_statusEvent);
-	lv2_atom_forge_key(&output_forge, uris.notify_cursors);
-	lv2_atom_forge_vector(&output_forge, sizeof (int), uris.atom_Int, MAXSTEPS, (void*) cursorbits);
-	lv2_atom_forge_key(&output_forge, uris.notify_notes);
-	lv2_atom_forge_int(&output_forge, notebits);
-	lv2_atom_forge_key(&output_forge, uris.notify_channels);
-	lv2_atom_forge_int(&output_forge, chbits);
-	lv2_atom_forge_pop(&output_forge, &frame);
+	lv2_atom_forge_frame_time(&notify_forge, 0);
+	lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_statusEvent);
+	lv2_atom_forge_key(&notify_forge, uris.notify_cursors);
+	lv2_atom_forge_vector(&notify_forge, sizeof (int), uris.atom_Int, MAXSTEPS, (void*) cursorbits);
+	lv2_atom_forge_key(&notify_forge, uris.notify_notes);
+	lv2_atom_forge_int(&notify_forge, notebits);
+	lv2_atom_forge_key(&notify_forge, uris.notify_channels);
+	lv2_atom_forge_int(&notify_forge, chbits);
+	lv2_atom_forge_key(&notify_forge, uris.notify_pattern);
+	lv2_atom_forge_int(&notify_forge, activePattern);
+	lv2_atom_forge_pop(&notify_forge, &frame);
 
 	scheduleNotifyStatusToGui = false;
 }
@@ -1614,20 +3544,20 @@ void BSEQuencer::notifyScaleMapsToGui ()
 	for (int i = NR_SYSTEM_SCALES; i < NR_SYSTEM_SCALES + NR_USER_SCALES; ++i)
 	{
 		LV2_Atom_Forge_Frame frame;
-		lv2_atom_forge_frame_time(&output_forge, 0);
-		lv2_atom_forge_object(&output_forge, &frame, 0, uris.notify_scaleMapsEvent);
-		lv2_atom_forge_key(&output_forge, uris.notify_scaleID);
-		lv2_atom_forge_int(&output_forge, rtScaleMaps[i].iD);
-		lv2_atom_forge_key(&output_forge, uris.notify_scaleName);
-		lv2_atom_forge_string (&output_forge, rtScaleMaps[i].name, 64);
-		lv2_atom_forge_key(&output_forge, uris.notify_scaleElements);
-		lv2_atom_forge_vector(&output_forge, sizeof (int), uris.atom_Int, 16, (void*) rtScaleMaps[i].elements);
-		lv2_atom_forge_key(&output_forge, uris.notify_scaleAltSymbols);
-		lv2_atom_forge_vector(&output_forge, 16, uris.atom_String, 16, (void*) rtScaleMaps[i].altSymbols);
-		lv2_atom_forge_key(&output_forge, uris.notify_scale);
+		lv2_atom_forge_frame_time(&notify_forge, 0);
+		lv2_atom_forge_object(&notify_forge, &frame, 0, uris.notify_scaleMapsEvent);
+		lv2_atom_forge_key(&notify_forge, uris.notify_scaleID);
+		lv2_atom_forge_int(&notify_forge, rtScaleMaps[i].iD);
+		lv2_atom_forge_key(&notify_forge, uris.notify_scaleName);
+		lv2_atom_forge_string (&notify_forge, rtScaleMaps[i].name, 64);
+		lv2_atom_forge_key(&notify_forge, uris.notify_scaleElements);
+		lv2_atom_forge_vector(&notify_forge, sizeof (int), uris.atom_Int, 16, (void*) rtScaleMaps[i].elements);
+		lv2_atom_forge_key(&notify_forge, uris.notify_scaleAltSymbols);
+		lv2_atom_forge_vector(&notify_forge, 16, uris.atom_String, 16, (void*) rtScaleMaps[i].altSymbols);
+		lv2_atom_forge_key(&notify_forge, uris.notify_scale);
 		BScaleNotes* notes = &rtScaleMaps[i].scaleNotes;
-		lv2_atom_forge_vector(&output_forge, sizeof (int), uris.atom_Int, 12, (void*) notes);
-		lv2_atom_forge_pop(&output_forge, &frame);
+		lv2_atom_forge_vector(&notify_forge, sizeof (int), uris.atom_Int, 12, (void*) notes);
+		lv2_atom_forge_pop(&notify_forge, &frame);
 
 		scheduleNotifyScaleMapsToGui = false;
 	}
@@ -1651,11 +3581,20 @@ void BSEQuencer::notifyMidi ()
 		msg[1] = midiData.note;
 		msg[2] = midiData.velocity;
 
+		// MultiOut variant: Forge directly into the output of the sequencer
+		// channel, MIDI thru stays in the main output
+		LV2_Atom_Forge* forge = &output_forge;
+		if (multiOut && (midiData.ch < NR_SEQUENCER_CHS))
+		{
+			if (!midiOutputPorts[midiData.ch]) continue;
+			forge = &midi_forge[midiData.ch];
+		}
+
 		// send MIDI message
-		if (!lv2_atom_forge_frame_time (&output_forge, midiData.frames)) return;
-		if (!lv2_atom_forge_raw (&output_forge, &midiatom, sizeof (LV2_Atom))) return;
-		if (!lv2_atom_forge_raw (&output_forge, &msg, midiatom.size)) return;
-		lv2_atom_forge_pad (&output_forge, sizeof (LV2_Atom) + midiatom.size);
+		if (!lv2_atom_forge_frame_time (forge, midiData.frames)) continue;
+		if (!lv2_atom_forge_raw (forge, &midiatom, sizeof (LV2_Atom))) continue;
+		if (!lv2_atom_forge_raw (forge, &msg, midiatom.size)) continue;
+		lv2_atom_forge_pad (forge, sizeof (LV2_Atom) + midiatom.size);
 	}
 }
 
@@ -1670,7 +3609,7 @@ static LV2_Handle instantiate (const LV2_Descriptor* descriptor, double samplera
 {
 	// New instance
 	BSEQuencer* instance;
-	try {instance = new BSEQuencer(samplerate, features);}
+	try {instance = new BSEQuencer(samplerate, features, strcmp (descriptor->URI, BSEQUENCER_MULTIOUT_URI) == 0);}
 	catch (std::exception& exc)
 	{
 		fprintf (stderr, "BSEQuencer.lv2: Plugin instantiation failed. %s\n", exc.what ());
@@ -1716,6 +3655,20 @@ static void activate (LV2_Handle instance)
 	if (inst) inst->activate ();
 }
 
+static LV2_Worker_Status work (LV2_Handle instance, LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+{
+	BSEQuencer* inst = (BSEQuencer*)instance;
+	if (!inst) return LV2_WORKER_SUCCESS;
+	return inst->work (respond, handle, size, data);
+}
+
+static LV2_Worker_Status work_response (LV2_Handle instance, uint32_t size, const void* data)
+{
+	BSEQuencer* inst = (BSEQuencer*)instance;
+	if (!inst) return LV2_WORKER_SUCCESS;
+	return inst->work_response (size, data);
+}
+
 static void cleanup (LV2_Handle instance)
 {
 	BSEQuencer* inst = (BSEQuencer*) instance;
@@ -1726,9 +3679,13 @@ static void cleanup (LV2_Handle instance)
 static const void* extension_data(const char* uri)
 {
   static const LV2_State_Interface  state  = {state_save, state_restore};
+  static const LV2_Worker_Interface worker = {work, work_response, NULL};
   if (!strcmp(uri, LV2_STATE__interface)) {
     return &state;
   }
+  if (!strcmp(uri, LV2_WORKER__interface)) {
+    return &worker;
+  }
   return NULL;
 }
 
@@ -1745,12 +3702,25 @@ static const LV2_Descriptor descriptor =
 		extension_data
 };
 
+static const LV2_Descriptor multiOutDescriptor =
+{
+		BSEQUENCER_MULTIOUT_URI,
+		instantiate,
+		connect_port,
+		activate,
+		run,
+		NULL,	// deactivate
+		cleanup,
+		extension_data
+};
+
 // LV2 Symbol Export
 LV2_SYMBOL_EXPORT const LV2_Descriptor* lv2_descriptor (uint32_t index)
 {
 	switch (index)
 	{
 	case 0: return &descriptor;
+	case 1: return &multiOutDescriptor;
 	default: return NULL;
 	}
 }
@@ -44,6 +44,8 @@
 #include <lv2/lv2plug.in/ns/ext/time/time.h>
 #include <lv2/lv2plug.in/ns/ext/midi/midi.h>
 #include <lv2/lv2plug.in/ns/ext/state/state.h>
+#include <lv2/lv2plug.in/ns/ext/options/options.h>
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
 #include "definitions.h"
 #include "ports.h"
 #include "urids.h"
@@ -51,8 +53,16 @@
 #include "ScaleMap.hpp"
 #include "Pad.hpp"
 #include "PadMessage.hpp"
+#include "RowProperties.hpp"
+#include "RowMessage.hpp"
+#include "Groove.hpp"
+#include "AutomationLane.hpp"
+#include "AutomationMessage.hpp"
 #include "StaticArrayList.hpp"
 #include "MidiStack.hpp"
+#include "PresetBank.hpp"
+#include "SMFImport.hpp"
+#include "GrooveImport.hpp"
 
 typedef struct {
 	float min;
@@ -62,7 +72,9 @@ typedef struct {
 
 typedef struct {
 	bool playing;
-	int stepOffset;
+	int stepNr;
+	int ticks;
+	double startPos;
 	int direction;
 	Pad pad;
 	uint8_t ch;
@@ -70,6 +82,11 @@ typedef struct {
 	uint8_t note;
 	uint8_t velocity;
 	float duration;
+	bool tied;
+	bool preCondition;
+	int ratchets;
+	int ratchetNr;
+	std::array<double, MAX_RATCHETS + 1> ratchetPos;
 	std::array<bool, MAXSTEPS> jumpOff;
 } Output;
 
@@ -78,18 +95,53 @@ typedef struct {
 	int8_t velocity;
 	double startPos;
 	int stepNr;
+	int ticks;
+	int loop;
+	uint64_t conditionBits;
 	std::array<Output, MAXSTEPS> output;
 } Key;
 
+typedef struct {
+	int pattern;
+	int row;
+	int step;
+	double startPos;
+	double stepSize;
+} RecordedNote;
+
+#define BANK_PATH_SIZE 1024
+
+enum BankWorkerMessageType
+{
+	BANK_LOAD	= 0,	// run => work: Load path
+	BANK_LOADED	= 1,	// work => work_response: Use bank
+	BANK_FREE	= 2	// work_response => work: Delete bank
+};
+
+// Message for loading user preset bank files in the worker
+struct BankWorkerMessage
+{
+	int32_t type;			// BankWorkerMessageType
+	PresetBank* bank;
+	char path[BANK_PATH_SIZE];
+};
+
 class BSEQuencer
 {
 public:
-	BSEQuencer (double samplerate, const LV2_Feature* const* features);
+	BSEQuencer (double samplerate, const LV2_Feature* const* features, const bool multiOut = false);
+	~BSEQuencer ();
 	void connect_port(uint32_t port, void *data);
 	void run(uint32_t n_samples);
 	LV2_State_Status state_save(LV2_State_Store_Function store, LV2_State_Handle handle, uint32_t flags, const LV2_Feature* const* features);
 	LV2_State_Status state_restore(LV2_State_Retrieve_Function retrieve, LV2_State_Handle handle, uint32_t flags, const LV2_Feature* const* features);
 	void activate ();
+	LV2_Worker_Status work (LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle, uint32_t size, const void* data);
+	LV2_Worker_Status work_response (uint32_t size, const void* data);
+	void appendBankPreset (std::vector<uint32_t>& bank, const std::string& name, const float* presetControllers);
+	bool importSMF (const std::string& path, const SMFImportSettings& settings, const int pattern, const float* presetControllers);
+	bool importGroove (const std::string& path, const double stepsPerBeat, const int size);
+	void seed (const uint32_t value);
 
 private:
 	bool makeMidi (const int64_t frames, const uint8_t status, const int key, const int row, uint8_t chbits = ALL_CH);
@@ -98,6 +150,9 @@ private:
 	void stopMidiOut (const int64_t frames, const int key, const int row, const uint8_t chbits);
 	void startMidiOut (const int64_t frames, const int key, const uint8_t chbits);
 	void startMidiOut (const int64_t frames, const int key, const int row, const uint8_t chbits);
+	void retriggerMidiOut (const int64_t frames, const int key, const int row);
+	uint64_t getConditionBits (const int loop);
+	bool checkCondition (const int key, const int row);
 	void cleanupInKeys ();
 	void makeAutoKey (const uint64_t last_t);
 	void stopAutoKey (const uint64_t act_t);
@@ -105,15 +160,43 @@ private:
 	bool padHasSuccessor (const int row, const int step);
 	int getPadStart (const int row, const int step);
 	int getNextPadStart (const int key, const int row, const int step);
+	void compilePattern (const int pattern);
+	void invalidatePatterns ();
 	int getNextStep (const int key, const int row, const int step);
-	double getStep (const int key, const double relpos);
-	int getStepOffset (const int key, const int row, const int relStep);
+	int getRowLength (const int row);
+	int getRowTicks (const int row);
+	int getNextRowStep (const int key, const int row);
 	void runSequencer (const double startpos, const uint32_t start, const uint32_t end);
+	int64_t getFrames (const double pos, const double startpos, const uint32_t start);
+	double getPatternEndPos ();
+	void schedulePattern (const int pattern, const int64_t frames);
+	void switchPattern (const int pattern, const int64_t frames, const double pos, const bool cut);
+	void restartKey (const int key, const double pos);
+	bool midiSelectPattern (const uint8_t* const msg, const int64_t frames);
+	void loadBankPreset (const int index);
+	void scheduleLoadBank (const char* path, const uint32_t size);
+	bool midiRecord (const uint8_t* const msg, const int64_t frames);
+	int getRecordRow (const int note, const int ch, int* octave);
+	void clearRecordedNotes ();
+	void updateGroove ();
+	double groovePos (const double pos);
+	float grooveVelocityFactor (const double pos);
+	void runAutomation (const double startpos, const uint32_t start, const uint32_t end);
+	float getAutomationValue (const int ch, const double pos);
+	void compileAutomation (const int pattern, const int ch);
+	void invalidateAutomation ();
 	float validateValue (float value, const Limit limit);
 	Pad validatePad (Pad pad);
+	RowProperties validateRow (RowProperties props);
+	AutomationLane validateAutomation (AutomationLane lane);
 	bool padMessageBufferAppendPad (int row, int step, Pad pad);
 	void padMessageBufferAllPads ();
 	void notifyPadsToGui ();
+	bool notifyPadSyncToGui (const int syncState);
+	void notifyRowsToGui ();
+	void notifyControllersToGui ();
+	void notifyChainToGui ();
+	void notifyAutomationToGui ();
 	void notifyStatusToGui ();
 	void notifyScaleMapsToGui ();
 	void notifyMidi ();
@@ -128,13 +211,29 @@ private:
 	// DSP <-> GUI communication
 	const LV2_Atom_Sequence* inputPort;
 	LV2_Atom_Sequence* outputPort;
+	LV2_Atom_Sequence* notifyPort;
 
 	LV2_Atom_Forge output_forge;
 	LV2_Atom_Forge_Frame output_frame;
+	LV2_Atom_Forge notify_forge;
+	LV2_Atom_Forge_Frame notify_frame;
+
+	// MultiOut variant: MIDI output for each sequencer channel, outputPort
+	// is only used for MIDI thru
+	bool multiOut;
+	LV2_Atom_Sequence* midiOutputPorts [NR_SEQUENCER_CHS];
+	LV2_Atom_Forge midi_forge [NR_SEQUENCER_CHS];
+	LV2_Atom_Forge_Frame midi_frame [NR_SEQUENCER_CHS];
 
 	PadMessage padMessageBuffer[MAXSTEPS * ROWS];
+	int padMessageCursor;	// Index of the next pad message to be sent
+	bool padSyncPending;	// Full pad sync requested, begin marker not sent yet
+	bool padSyncRunning;	// Full pad sync in progress, complete marker not sent yet
+	uint32_t padMessageBytesPerCycle;	// Max. pad message payload per cycle (option)
 
-	// Controllers
+	// Controllers. new_controllers point to the control ports or to the
+	// bank controllers if overridden by a bank preset.
+	float* controllerPorts [KNOBS_SIZE];
 	float* new_controllers [KNOBS_SIZE];
 	float controllers [KNOBS_SIZE];
 	Limit controllerLimits [KNOBS_SIZE] =
@@ -177,11 +276,64 @@ private:
 		{0, 1, 1},	// CH PITCH
 		{0, 2, 0},	// CH VELOCITY
 		{1, 16, 1},	// CH MIDI_CHANNEL
-		{-127, 127, 1}	// CH NOTE_OFFSET
+		{-127, 127, 1},	// CH NOTE_OFFSET
+		{0, NR_PATTERNS - 1, 1},	// PATTERN
+		{0, 3, 1},	// PATTERN_SWITCH
+		{0, 5, 1},	// PATTERN_SELECT
+		{0, NR_MIDI_KEYS - NR_PATTERNS, 1},	// PATTERN_KEYS
+		{0, 1, 1},	// RECORD
+		{50, 75, 1},	// SWING
+		{0, NR_GROOVES - 1, 1},	// GROOVE
+		{1, MAX_RATCHETS, 1},	// SELECTION_RATCHET
+		{-1, 1, 0},	// SELECTION_RATCHET_CURVE
+		{0, NR_CONDITIONS - 1, 1},	// SELECTION_CONDITION
+		{0, 1, 1},	// FILL
+		{0, MAX_BANK_PRESETS, 1}	// PRESET
 	};
 
-	//Pads
-	Pad pads [ROWS] [MAXSTEPS];
+	// Patterns
+	Pad patterns [NR_PATTERNS] [ROWS] [MAXSTEPS];
+	RowProperties patternRows [NR_PATTERNS] [ROWS];
+	int patternChain [NR_PATTERNS];
+	AutomationLane patternAutomation [NR_PATTERNS] [NR_SEQUENCER_CHS];
+
+	// Playback data precompiled from the pads: First and last step of the
+	// tied pad group containing a step. Rebuilt on demand after changes.
+	uint8_t patternPadStarts [NR_PATTERNS] [ROWS] [MAXSTEPS];
+	uint8_t patternPadEnds [NR_PATTERNS] [ROWS] [MAXSTEPS];
+	bool patternCompiled [NR_PATTERNS];
+
+	// Active (playing) pattern, edited pattern is controllers[PATTERN]
+	Pad (*pads) [MAXSTEPS];
+	uint8_t (*padStarts) [MAXSTEPS];
+	uint8_t (*padEnds) [MAXSTEPS];
+	RowProperties* rows;
+	int activePattern;
+	int pendingPattern;
+	double pendingPatternPos;
+	bool pendingPatternCut;
+
+	// Live recording: Notes recorded but not released yet
+	RecordedNote recordedNotes [NR_MIDI_KEYS];
+
+	// Groove: Template and swing precalculated as timing offsets (steps)
+	// and velocity factors for each step of the groove cycle
+	Groove userGroove;
+	int grooveSize;
+	float grooveTiming [2 * MAXSTEPS];
+	float grooveVelocity [2 * MAXSTEPS];
+
+	// Automation output: Next output time (frames relative to the actual
+	// block) and last sent value of each sequencer channel lane
+	int64_t automationFrames [NR_SEQUENCER_CHS];
+	int automationValues [NR_SEQUENCER_CHS];
+
+	// Automation nodes precompiled from the lanes: Previous (or same) and
+	// next node of each step or -1 if the lane has no nodes. Compiled for
+	// automationCompiledSteps steps (0 = not compiled).
+	int8_t automationPrevNodes [NR_PATTERNS] [NR_SEQUENCER_CHS] [MAXSTEPS];
+	int8_t automationNextNodes [NR_PATTERNS] [NR_SEQUENCER_CHS] [MAXSTEPS];
+	int automationCompiledSteps [NR_PATTERNS] [NR_SEQUENCER_CHS];
 
 	// Host communicated data
 	double rate;
@@ -196,14 +348,31 @@ private:
 	// Internals
 	bool ui_on;
 	bool scheduleNotifyPadsToGui;
+	bool scheduleNotifyRowsToGui;
+	bool scheduleNotifyChainToGui;
+	bool scheduleNotifyAutomationToGui;
 	bool scheduleNotifyStatusToGui;
 	bool scheduleNotifyScaleMapsToGui;
+	bool scheduleNotifyControllersToGui;
 	StaticArrayList<Key, 16> inKeys;
 	Key defaultKey;
 	BScale scale;
 
 	RTScaleMap rtScaleMaps[NR_SYSTEM_SCALES + NR_USER_SCALES];
 
+	// Built-in preset bank, user preset bank (loaded by the worker, replaces
+	// the built-in bank if set) and the controllers of the last loaded preset
+	PresetBank presetBank;
+	PresetBank* userBank;
+	char userBankPath[BANK_PATH_SIZE];
+	LV2_Worker_Schedule* workerSchedule;
+	float bankControllers[KNOBS_SIZE];
+
+	// Bank preset controller overrides. Valid until the host changes the
+	// control port value (from controllerOverrideBase).
+	bool controllerOverride[KNOBS_SIZE];
+	float controllerOverrideBase[KNOBS_SIZE];
+
 	std::minstd_rand rnd;
 	std::uniform_real_distribution<float> distUni;
 	std::uniform_real_distribution<float> distBi;
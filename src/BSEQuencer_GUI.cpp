@@ -21,20 +21,41 @@
 #include "BSEQuencer_GUI.hpp"
 #include "BUtilities/to_string.hpp"
 #include "BUtilities/vsystem.hpp"
+#ifdef PRESETBANKFILE
+#include PRESETBANKFILE
+#endif
 #include <exception>
 
 BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *const *features, PuglNativeView parentWindow) :
 	Window (1250, 820, "B.SEQuencer", parentWindow, true, PUGL_MODULE, 0),
 	controller (NULL), write_function (NULL),
 	pluginPath (bundle_path ? std::string (bundle_path) : std::string ("")),
-	sz (1.0), bgImageSurface (nullptr),
-	uris (), forge (), clipBoard (),
+	sz (1.0),
+	uris (), forge (), padSync (false), playingPattern (0), clipBoard (),
 	cursorBits {0}, noteBits (0), chBits (0),
 	tempTool (false), tempToolCh (0), wheelScrolled (false), modifier (MODIFIER_VELOCITY),
 	mContainer (0, 0, 1250, 820, "main"),
 	padSurface (98, 88, 804, 484, "box"),
 	captionSurface (18, 88, 64, 484, "box"),
 
+	presetLabel (440, 20, 55, 20, "lflabel", BSEQUENCER_LABEL_PRESET),
+	presetListBox (495, 20, 250, 20, 250, 360, "menu", BItems::ItemList (), 0.0),
+	patternLabel (440, 52, 55, 20, "lflabel", BSEQUENCER_LABEL_PATTERN),
+	patternListBox (495, 52, 50, 20, 50, 340, "menu", BItems::ItemList (), 0.0),
+	patternNextLabel (555, 52, 40, 20, "lflabel", BSEQUENCER_LABEL_THEN),
+	patternNextListBox (595, 52, 85, 20, 85, 360, "menu", BItems::ItemList (), NO_PATTERN),
+	patternSwitchLabel (690, 52, 55, 20, "lflabel", BSEQUENCER_LABEL_SWITCH),
+	patternSwitchListBox (745, 52, 110, 20, 110, 100, "menu",
+			      BItems::ItemList ({{SWITCH_STEP, BSEQUENCER_LABEL_NEXT_STEP}, {SWITCH_BAR, BSEQUENCER_LABEL_NEXT_BAR},
+						 {SWITCH_STEP | SWITCH_CUT, BSEQUENCER_LABEL_NEXT_STEP_CUT}, {SWITCH_BAR | SWITCH_CUT, BSEQUENCER_LABEL_NEXT_BAR_CUT}}), SWITCH_STEP),
+	patternSelectLabel (865, 52, 40, 20, "lflabel", BSEQUENCER_LABEL_MIDI),
+	patternSelectListBox (905, 52, 105, 20, 105, 140, "menu",
+			      BItems::ItemList ({{SELECT_OFF, BSEQUENCER_LABEL_OFF}, {SELECT_PROGRAM, BSEQUENCER_LABEL_PROGRAM},
+						 {SELECT_KEYS, BSEQUENCER_LABEL_KEYS}, {SELECT_PROGRAM_KEYS, BSEQUENCER_LABEL_PROGRAM_AND_KEYS},
+						 {SELECT_PRESET, BSEQUENCER_LABEL_PRESET}, {SELECT_PRESET_KEYS, BSEQUENCER_LABEL_PRESET_AND_KEYS}}), SELECT_OFF),
+	patternKeysListBox (1015, 52, 55, 20, 55, 240, "menu", BItems::ItemList (), 36.0),
+	patternPlayingLabel (1075, 52, 85, 20, "lflabel", BSEQUENCER_LABEL_PLAYING ": 1"),
+
 	modeBox (920, 88, 310, 170, "box"),
 	modeBoxLabel (10, 10, 290, 20, "ctlabel", BSEQUENCER_LABEL_PLAY_MODE),
 	modeLabel (10, 80, 60, 20, "lflabel", BSEQUENCER_LABEL_MODE),
@@ -49,7 +70,9 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 						     {10, "10"}, {11, "11"}, {12, "12"}, {13, "13"}, {14, "14"}, {15, "15"}, {16, "16"}})),
 	modeOnKeyLabel (10, 140, 100, 20, "lflabel", BSEQUENCER_LABEL_ON_NOTE_ON),
 	modeOnKeyListBox (180, 140, 120, 20, 120, 80, "menu", BItems::ItemList ({{0, BSEQUENCER_LABEL_RESTART}, {2, BSEQUENCER_LABEL_RESTART_SYNC}, {1, BSEQUENCER_LABEL_CONTINUE}})),
-	modePlayLabel (10, 50, 205, 20, "lflabel", BSEQUENCER_LABEL_STATUS_PLAYING),
+	modePlayLabel (10, 50, 155, 20, "lflabel", BSEQUENCER_LABEL_STATUS_PLAYING),
+	modeFillButton (170, 45, 50, 20, "tgbutton", BSEQUENCER_LABEL_FILL, 0.0),
+	modeRecordButton (225, 45, 40, 20, "tgbutton", BSEQUENCER_LABEL_RECORD, 0.0),
 	modePlayButton (270, 40, 30, 30, "box", 1.0),
 
 	toolBox (920, 280, 310, 292, "box"),
@@ -59,6 +82,12 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	toolResetButton (90, 130, 20, 20, "tgbutton"),
 	toolUndoButton (120, 130, 20, 20, "tgbutton"),
 	toolRedoButton (150, 130, 20, 20, "tgbutton"),
+	toolImportButton (10, 130, 70, 20, "tgbutton", BSEQUENCER_LABEL_IMPORT),
+	toolRatchetListBox (185, 130, 50, 20, 0, -160, 50, 160, "menu",
+			    BItems::ItemList ({{1, "1x"}, {2, "2x"}, {3, "3x"}, {4, "4x"}, {5, "5x"}, {6, "6x"}, {7, "7x"}, {8, "8x"}}), 1.0),
+	toolRatchetCurveListBox (240, 130, 60, 20, 60, 60, "menu",
+				 BItems::ItemList ({{-1, BSEQUENCER_LABEL_ACCEL}, {0, BSEQUENCER_LABEL_EVEN}, {1, BSEQUENCER_LABEL_RITARD}}), 0.0),
+	toolConditionListBox (),
 	toolButtonBoxCtrlLabel (10, 10, 80, 20, "lflabel", BSEQUENCER_LABEL_CONTROLS),
 	toolButtonBoxChLabel (10, 70, 80, 20, "lflabel", BSEQUENCER_LABEL_CHANNELS),
 	toolButtonBoxEditLabel (10, 100, 80, 20, "lflabel", BSEQUENCER_LABEL_EDIT),
@@ -83,20 +112,26 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	propertiesBaseListBox (210, 85, 90, 20, 90, 60, "menu",
 			       BItems::ItemList ({BSEQUENCER_LABEL_BEAT, BSEQUENCER_LABEL_BAR}), 1.0),
 	propertiesRootLabel (10, 115, 60, 20, "lflabel", BSEQUENCER_LABEL_ROOT),
-	propertiesRootListBox (110, 115, 90, 20, 0, -160, 90, 160, "menu",
+	propertiesRootListBox (80, 115, 60, 20, 0, -160, 60, 160, "menu",
 			       BItems::ItemList ({{0, "C"}, {2, "D"}, {4, "E"}, {5, "F"}, {7, "G"}, {9, "A"}, {11, "B"}}), 0.0),
-	propertiesSignatureListBox (210, 115, 90, 20, 90, 80, "menu",
+	propertiesSignatureListBox (150, 115, 50, 20, 50, 80, "menu",
 				    BItems::ItemList ({{-1, "b"}, {0, ""}, {1, "#"}}), 0.0),
-	propertiesOctaveLabel (10, 145, 60, 20, "lflabel", BSEQUENCER_LABEL_OCTAVE),
-	propertiesOctaveListBox (210, 145, 90, 20, 0, -220, 90, 220, "menu",
+	propertiesOctaveListBox (210, 115, 90, 20, 0, -220, 90, 220, "menu",
 				 BItems::ItemList ({{-1, "-1"}, {0, "0"}, {1, "1"}, {2, "2"}, {3, "3"}, {4, "4"}, {5, "5"}, {6, "6"}, {7, "7"}, {8, "8"}}), 4.0),
+	propertiesGrooveLabel (10, 145, 60, 20, "lflabel", BSEQUENCER_LABEL_GROOVE),
+	propertiesGrooveListBox (80, 145, 110, 20, 0, -100, 110, 100, "menu",
+				 BItems::ItemList ({{GROOVE_OFF, BSEQUENCER_LABEL_OFF}, {GROOVE_SHUFFLE, BSEQUENCER_LABEL_SHUFFLE}, {GROOVE_LAID_BACK, BSEQUENCER_LABEL_LAID_BACK},
+						    {GROOVE_PUSH, BSEQUENCER_LABEL_PUSH}, {GROOVE_USER, BSEQUENCER_LABEL_USER}}), GROOVE_OFF),
+	propertiesSwingSlider (200, 135, 100, 25, "slider", 50.0, 50.0, 75.0, 1.0, "%2.0f %%"),
 	propertiesScaleLabel (10, 175, 60, 20, "lflabel", BSEQUENCER_LABEL_SCALE),
 	propertiesScaleEditIcon (70, 175, 20, 20, "widget", (bundle_path ? std::string (bundle_path) + EDIT_SYMBOL : std::string (""))),
 	propertiesScaleListBox (),
 
 	helpButton (1166, 50, 24, 24, "halobutton", BSEQUENCER_LABEL_HELP),
 	ytButton (1196, 50, 24, 24, "halobutton", BSEQUENCER_LABEL_FEATURE_TOUR),
-	scaleEditor (nullptr)
+	scaleEditor (nullptr),
+	automationEditor (nullptr),
+	fileChooser (nullptr)
 {
 	// Init scale maps
 	for (int scaleNr = 0; scaleNr < NR_SYSTEM_SCALES + NR_USER_SCALES; ++scaleNr)
@@ -113,6 +148,43 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	propertiesScaleListBox = BWidgets::PopupListBox (100, 175, 200, 20, 0, -420, 200, 420, "menu", scaleItems, 0.0);
 	propertiesScaleListBox.rename ("menu");
 
+	// Init pattern list boxes
+	BItems::ItemList patternItems;
+	BItems::ItemList patternNextItems (BItems::Item (NO_PATTERN, BSEQUENCER_LABEL_REPEAT));
+	for (int i = 0; i < NR_PATTERNS; ++i)
+	{
+		patternItems.push_back (BItems::Item (i, std::to_string (i + 1)));
+		patternNextItems.push_back (BItems::Item (i, std::to_string (i + 1)));
+	}
+	patternListBox = BWidgets::PopupListBox (495, 52, 50, 20, 50, 340, "menu", patternItems, 0.0);
+	patternListBox.rename ("menu");
+	patternNextListBox = BWidgets::PopupListBox (595, 52, 85, 20, 85, 360, "menu", patternNextItems, NO_PATTERN);
+	patternNextListBox.rename ("menu");
+
+	// Init preset list box: Names of the built-in bank presets
+	BItems::ItemList presetItems (BItems::Item (0, "-"));
+#ifdef PRESETBANKFILE
+	PresetBank presetBank;
+	presetBank.setData (presetBankData, sizeof (presetBankData));
+	for (size_t i = 0; i < presetBank.size (); ++i) presetItems.push_back (BItems::Item (i + 1, std::string (presetBank.getPreset (i)->name)));
+#endif
+	presetListBox = BWidgets::PopupListBox (495, 20, 250, 20, 250, 360, "menu", presetItems, 0.0);
+	presetListBox.rename ("menu");
+
+	// Init pattern keys list box: Lowest key of the reserved key range
+	const std::string noteNames[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+	BItems::ItemList keyItems;
+	for (int i = 0; i <= NR_MIDI_KEYS - NR_PATTERNS; ++i) keyItems.push_back (BItems::Item (i, noteNames[i % 12] + std::to_string (i / 12 - 1)));
+	patternKeysListBox = BWidgets::PopupListBox (1015, 52, 55, 20, 55, 240, "menu", keyItems, 36.0);
+	patternKeysListBox.rename ("menu");
+	for (int i = 0; i < NR_PATTERNS; ++i) patternChain[i] = NO_PATTERN;
+
+	// Init condition list box
+	BItems::ItemList conditionItems;
+	for (int i = 0; i < NR_CONDITIONS; ++i) conditionItems.push_back (BItems::Item (i, getConditionLabel (i)));
+	toolConditionListBox = BWidgets::PopupListBox (240, 70, 60, 20, 60, 240, "menu", conditionItems, 0.0);
+	toolConditionListBox.rename ("menu");
+
 	// Init toolbox buttons
 	toolButtonBox.addButton (90, 70, 20, 20, {{0.0, 0.03, 0.06, 1.0}, NO_CTRL, BSEQUENCER_LABEL_NO_CHANNEL});
 	for (int i = 1; i < NR_SEQUENCER_CHS + 1; ++i) toolButtonBox.addButton (90 + i * 30, 70, 20, 20, chButtonStyles[i]);
@@ -125,7 +197,8 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	{
 		chBoxes[i].box = BWidgets::Widget (98 + i * 203.5, 590, 193.5, 210, "box");
 		chBoxes[i].chSymbol = BWidgets::DrawingSurface (7, 7, 26, 26, "button");
-		chBoxes[i].chLabel = BWidgets::Label (40, 10, 133.5, 20, "ctlabel", BSEQUENCER_LABEL_CHANNEL " " + std::to_string (i + 1));
+		chBoxes[i].chLabel = BWidgets::Label (40, 10, 93.5, 20, "ctlabel", BSEQUENCER_LABEL_CHANNEL " " + std::to_string (i + 1));
+		chBoxes[i].automationButton = BWidgets::TextButton (138.5, 10, 45, 20, "tgbutton", BSEQUENCER_LABEL_AUTO);
 		chBoxes[i].channelLabel = BWidgets::Label (10, 50, 100, 20, "lflabel", BSEQUENCER_LABEL_MIDI_CH);
 		chBoxes[i].channelListBox = BWidgets::PopupListBox (123.5, 50, 60, 20, 60, 120, "menu",
 								    BItems::ItemList({"1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16"}),
@@ -143,6 +216,7 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	// Link controllerWidgets
 	controllerWidgets[MIDI_IN_CHANNEL] = (BWidgets::ValueWidget*) &modeMidiInChannelListBox;
 	controllerWidgets[PLAY] = (BWidgets::ValueWidget*) &modePlayButton;
+	controllerWidgets[RECORD] = (BWidgets::ValueWidget*) &modeRecordButton;
 	controllerWidgets[MODE] = (BWidgets::ValueWidget*) &modeListBox;
 	controllerWidgets[ON_KEY_PRESSED] = (BWidgets::ValueWidget*) &modeOnKeyListBox;
 	controllerWidgets[NR_OF_STEPS] = (BWidgets::ValueWidget*) &propertiesNrStepsListBox;
@@ -151,6 +225,8 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	controllerWidgets[ROOT] = (BWidgets::ValueWidget*) &propertiesRootListBox;
 	controllerWidgets[SIGNATURE] = (BWidgets::ValueWidget*) &propertiesSignatureListBox;
 	controllerWidgets[OCTAVE] = (BWidgets::ValueWidget*) &propertiesOctaveListBox;
+	controllerWidgets[SWING] = (BWidgets::ValueWidget*) &propertiesSwingSlider;
+	controllerWidgets[GROOVE] = (BWidgets::ValueWidget*) &propertiesGrooveListBox;
 	controllerWidgets[SCALE] = (BWidgets::ValueWidget*) &propertiesScaleListBox;
 	controllerWidgets[AUTOPLAY_BPM] = (BWidgets::ValueWidget*) &modeAutoplayBpmSlider;
 	controllerWidgets[AUTOPLAY_BPB] = (BWidgets::ValueWidget*) &modeAutoplayBpbSlider;
@@ -164,6 +240,15 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	controllerWidgets[SELECTION_OCTAVE_RAND] = (BWidgets::ValueWidget*) &toolOctaveDial.range;
 	controllerWidgets[SELECTION_VELOCITY_RAND] = (BWidgets::ValueWidget*) &toolVelocityDial.range;
 	controllerWidgets[SELECTION_DURATION_RAND] = (BWidgets::ValueWidget*) &toolDurationDial.range;
+	controllerWidgets[SELECTION_RATCHET] = (BWidgets::ValueWidget*) &toolRatchetListBox;
+	controllerWidgets[SELECTION_RATCHET_CURVE] = (BWidgets::ValueWidget*) &toolRatchetCurveListBox;
+	controllerWidgets[SELECTION_CONDITION] = (BWidgets::ValueWidget*) &toolConditionListBox;
+	controllerWidgets[FILL] = (BWidgets::ValueWidget*) &modeFillButton;
+	controllerWidgets[PATTERN] = (BWidgets::ValueWidget*) &patternListBox;
+	controllerWidgets[PATTERN_SWITCH] = (BWidgets::ValueWidget*) &patternSwitchListBox;
+	controllerWidgets[PATTERN_SELECT] = (BWidgets::ValueWidget*) &patternSelectListBox;
+	controllerWidgets[PATTERN_KEYS] = (BWidgets::ValueWidget*) &patternKeysListBox;
+	controllerWidgets[PRESET] = (BWidgets::ValueWidget*) &presetListBox;
 
 	for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
 	{
@@ -187,6 +272,11 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	padSurface.setScrollable (true);
 	padSurface.setCallbackFunction (BEvents::WHEEL_SCROLL_EVENT, padsScrolledCallback);
 
+	captionSurface.setScrollable (true);
+	captionSurface.setCallbackFunction (BEvents::WHEEL_SCROLL_EVENT, captionScrolledCallback);
+
+	patternNextListBox.setCallbackFunction (BEvents::VALUE_CHANGED_EVENT, chainChangedCallback);
+
 	padSurface.setFocusable (true);
 	padSurface.setCallbackFunction (BEvents::FOCUS_IN_EVENT, padsFocusedCallback);
 	padSurface.setCallbackFunction (BEvents::FOCUS_OUT_EVENT, padsFocusedCallback);
@@ -195,14 +285,17 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	toolResetButton.setCallbackFunction(BEvents::VALUE_CHANGED_EVENT, resetClickedCallback);
 	toolUndoButton.setCallbackFunction(BEvents::VALUE_CHANGED_EVENT, undoClickedCallback);
 	toolRedoButton.setCallbackFunction(BEvents::VALUE_CHANGED_EVENT, undoClickedCallback);
+	toolImportButton.setCallbackFunction(BEvents::BUTTON_CLICK_EVENT, importPressedCallback);
 
 	helpButton.setCallbackFunction(BEvents::BUTTON_PRESS_EVENT, helpPressedCallback);
 	ytButton.setCallbackFunction(BEvents::BUTTON_PRESS_EVENT, ytPressedCallback);
 	propertiesScaleEditIcon.setCallbackFunction(BEvents::BUTTON_PRESS_EVENT, editPressedCallback);
+	for (int i = 0; i < NR_SEQUENCER_CHS; ++i) chBoxes[i].automationButton.setCallbackFunction(BEvents::BUTTON_CLICK_EVENT, automationPressedCallback);
 
 	// Apply theme
-	bgImageSurface = cairo_image_surface_create_from_png ((pluginPath + BG_FILE).c_str());
+	cairo_surface_t* bgImageSurface = BWidgets::ImageCache::load (pluginPath + BG_FILE);
 	widgetBg.loadFillFromCairoSurface (bgImageSurface);
+	cairo_surface_destroy (bgImageSurface);
 	applyTheme (theme);
 
 	toolDurationDial.range.setMax (0.0);
@@ -216,6 +309,8 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	modeAutoplayBpmSlider.hide ();
 	modeAutoplayBpbLabel.hide ();
 	modeAutoplayBpbSlider.hide ();
+	patternKeysListBox.hide ();
+	modeRecordButton.hide ();
 
 	modeBoxLabel.setState (BColors::ACTIVE);
 	toolBoxLabel.setState (BColors::ACTIVE);
@@ -244,6 +339,8 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	modeBox.add (modeOnKeyLabel);
 	modeBox.add (modeOnKeyListBox);
 	modeBox.add (modePlayLabel);
+	modeBox.add (modeFillButton);
+	modeBox.add (modeRecordButton);
 	modeBox.add (modePlayButton);
 
 	toolBox.add (toolBoxLabel);
@@ -256,6 +353,10 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	toolButtonBox.add (toolResetButton);
 	toolButtonBox.add (toolUndoButton);
 	toolButtonBox.add (toolRedoButton);
+	toolButtonBox.add (toolImportButton);
+	toolButtonBox.add (toolRatchetListBox);
+	toolButtonBox.add (toolRatchetCurveListBox);
+	toolButtonBox.add (toolConditionListBox);
 
 	toolBox.add (toolGateLabel);
 	toolBox.add (toolGateSlider);
@@ -277,8 +378,10 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	propertiesBox.add (propertiesRootLabel);
 	propertiesBox.add (propertiesRootListBox);
 	propertiesBox.add (propertiesSignatureListBox);
-	propertiesBox.add (propertiesOctaveLabel);
 	propertiesBox.add (propertiesOctaveListBox);
+	propertiesBox.add (propertiesGrooveLabel);
+	propertiesBox.add (propertiesGrooveListBox);
+	propertiesBox.add (propertiesSwingSlider);
 	propertiesBox.add (propertiesScaleLabel);
 	propertiesBox.add (propertiesScaleEditIcon);
 	propertiesBox.add (propertiesScaleListBox);
@@ -287,6 +390,7 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	{
 		chBoxes[i].box.add (chBoxes[i].chSymbol);
 		chBoxes[i].box.add (chBoxes[i].chLabel);
+		chBoxes[i].box.add (chBoxes[i].automationButton);
 		chBoxes[i].box.add (chBoxes[i].channelLabel);
 		chBoxes[i].box.add (chBoxes[i].channelListBox);
 		chBoxes[i].box.add (chBoxes[i].pitchLabel);
@@ -299,6 +403,18 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 	}
 
 	mContainer.add (captionSurface);
+	mContainer.add (presetLabel);
+	mContainer.add (presetListBox);
+	mContainer.add (patternLabel);
+	mContainer.add (patternListBox);
+	mContainer.add (patternNextLabel);
+	mContainer.add (patternNextListBox);
+	mContainer.add (patternSwitchLabel);
+	mContainer.add (patternSwitchListBox);
+	mContainer.add (patternSelectLabel);
+	mContainer.add (patternSelectListBox);
+	mContainer.add (patternKeysListBox);
+	mContainer.add (patternPlayingLabel);
 	mContainer.add (toolBox);
 	mContainer.add (modeBox);
 	mContainer.add (propertiesBox);
@@ -336,6 +452,8 @@ BSEQuencer_GUI::BSEQuencer_GUI (const char *bundle_path, const LV2_Feature *cons
 BSEQuencer_GUI::~BSEQuencer_GUI ()
 {
 	if (scaleEditor) delete scaleEditor;
+	if (automationEditor) delete automationEditor;
+	if (fileChooser) delete fileChooser;
 
 	send_ui_off ();
 }
@@ -344,7 +462,7 @@ void BSEQuencer_GUI::port_event(uint32_t port, uint32_t buffer_size,
 	uint32_t format, const void* buffer)
 {
 	// Notify port
-	if ((format == uris.atom_eventTransfer) && (port == OUTPUT))
+	if ((format == uris.atom_eventTransfer) && (port == NOTIFY))
 	{
 		const LV2_Atom* atom = (const LV2_Atom*) buffer;
 		if ((atom->type == uris.atom_Blank) || (atom->type == uris.atom_Object))
@@ -368,6 +486,10 @@ void BSEQuencer_GUI::port_event(uint32_t port, uint32_t buffer_size,
 							wheelScrolled = false;
 						}
 
+						// Changed steps of each row (bitmask) including
+						// tied pads before and after the change
+						uint32_t dirty[ROWS] = {0};
+
 						uint32_t size = (uint32_t) ((oPad->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (PadMessage));
 						PadMessage* pMes = (PadMessage*)(&vec->body + 1);
 						for (unsigned int i = 0; i < size; ++i)
@@ -377,27 +499,170 @@ void BSEQuencer_GUI::port_event(uint32_t port, uint32_t buffer_size,
 							int row = (int) pMes[i].row;
 							if ((step >= 0) && (step < MAXSTEPS) && (row >= 0) && (row < ROWS))
 							{
+								markPad (row, step, dirty);
 								pattern.setPad (row, step, Pad (pMes[i]));
+								markPad (row, step, dirty);
 							}
 						}
+
+						// Full pad sync: Store and draw on completion
+						if (!padSync)
+						{
+							pattern.store ();
+							drawPad (dirty);
+						}
+					}
+				}
+			}
+
+			// Pad sync begin / complete notification
+			else if (obj->body.otype == uris.notify_padSyncEvent)
+			{
+				LV2_Atom *oSync = NULL;
+				lv2_atom_object_get(obj, uris.notify_padSync, &oSync, NULL);
+
+				if (oSync && (oSync->type == uris.atom_Int))
+				{
+					const int syncState = ((LV2_Atom_Int*)oSync)->body;
+
+					if (syncState == PAD_SYNC_BEGIN)
+					{
+						if (wheelScrolled)
+						{
+							pattern.store ();
+							wheelScrolled = false;
+						}
+
+						// Only non-empty pads are sent: Reset all pads first
+						for (int r = 0; r < ROWS; ++r)
+						{
+							for (int s = 0; s < MAXSTEPS; ++s) pattern.setPad (r, s, Pad ());
+						}
+						padSync = true;
+					}
+
+					else if (syncState == PAD_SYNC_COMPLETE)
+					{
+						padSync = false;
 						pattern.store ();
 						drawPad ();
 					}
 				}
 			}
 
+			// Row properties notification
+			else if (obj->body.otype == uris.notify_rowEvent)
+			{
+				LV2_Atom *oRow = NULL;
+				lv2_atom_object_get(obj, uris.notify_row, &oRow, NULL);
+
+				if (oRow && (oRow->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oRow;
+					if (vec->body.child_type == uris.atom_Float)
+					{
+						uint32_t size = (uint32_t) ((oRow->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (RowMessage));
+						RowMessage* rMes = (RowMessage*)(&vec->body + 1);
+						for (unsigned int i = 0; i < size; ++i)
+						{
+							int row = (int) rMes[i].row;
+							if ((row >= 0) && (row < ROWS)) pattern.setRow (row, rMes[i]);
+						}
+						drawCaption ();
+						drawPad ();
+					}
+				}
+			}
+
+			// Pattern chain notification
+			else if (obj->body.otype == uris.notify_chainEvent)
+			{
+				LV2_Atom *oChain = NULL;
+				lv2_atom_object_get(obj, uris.notify_chain, &oChain, NULL);
+
+				if (oChain && (oChain->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oChain;
+					if (vec->body.child_type == uris.atom_Int)
+					{
+						uint32_t size = (uint32_t) ((oChain->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (int));
+						int* chain = (int*)(&vec->body + 1);
+						for (unsigned int i = 0; (i < size) && (i < NR_PATTERNS); ++i)
+						{
+							patternChain[i] = ((chain[i] >= 0) && (chain[i] < NR_PATTERNS) ? chain[i] : NO_PATTERN);
+						}
+						patternNextListBox.setValue (patternChain[LIMIT ((int) controllers[PATTERN], 0, NR_PATTERNS - 1)]);
+					}
+				}
+			}
+
+			// Controllers notification (bank preset loaded): Apply to the
+			// controller ports
+			else if (obj->body.otype == uris.notify_controllersEvent)
+			{
+				LV2_Atom *oControllers = NULL;
+				lv2_atom_object_get(obj, uris.notify_controllers, &oControllers, NULL);
+
+				if (oControllers && (oControllers->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oControllers;
+					if (vec->body.child_type == uris.atom_Float)
+					{
+						uint32_t size = (uint32_t) ((oControllers->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (float));
+						float* values = (float*)(&vec->body + 1);
+						for (unsigned int i = 0; (i < size) && (i < KNOBS_SIZE); ++i)
+						{
+							// Keep transport and the way presets are selected
+							if ((i == PLAY) || (i == PRESET) || (i == PATTERN_SELECT) || (i == PATTERN_KEYS)) continue;
+							controllerWidgets[i]->setValue (values[i]);
+						}
+					}
+				}
+			}
+
+			// Automation lanes notification
+			else if (obj->body.otype == uris.notify_automationEvent)
+			{
+				LV2_Atom *oAutomation = NULL;
+				lv2_atom_object_get(obj, uris.notify_automation, &oAutomation, NULL);
+
+				if (oAutomation && (oAutomation->type == uris.atom_Vector))
+				{
+					const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*) oAutomation;
+					if (vec->body.child_type == uris.atom_Float)
+					{
+						uint32_t size = (uint32_t) ((oAutomation->size - sizeof(LV2_Atom_Vector_Body)) / sizeof (AutomationMessage));
+						AutomationMessage* aMes = (AutomationMessage*)(&vec->body + 1);
+						for (unsigned int i = 0; i < size; ++i)
+						{
+							int ch = (int) aMes[i].ch;
+							if ((ch >= 0) && (ch < NR_SEQUENCER_CHS)) automationLanes[ch] = aMes[i];
+						}
+					}
+				}
+			}
+
 			// Status notifications
 			else if (obj->body.otype == uris.notify_statusEvent)
 			{
-				LV2_Atom *oCursors = NULL, *oNotes = NULL, *oChs = NULL;
+				LV2_Atom *oCursors = NULL, *oNotes = NULL, *oChs = NULL, *oPattern = NULL;
 				lv2_atom_object_get
 				(
 					obj, uris.notify_cursors, &oCursors,
 					uris.notify_notes, &oNotes,
 					uris.notify_channels, &oChs,
+					uris.notify_pattern, &oPattern,
 					NULL
 				);
 
+				// Playing pattern notifications
+				if (oPattern && (oPattern->type == uris.atom_Int) && (playingPattern != ((LV2_Atom_Int*)oPattern)->body))
+				{
+					playingPattern = ((LV2_Atom_Int*)oPattern)->body;
+					patternPlayingLabel.setText (BSEQUENCER_LABEL_PLAYING ": " + std::to_string (playingPattern + 1));
+					drawCursors ();
+				}
+
 				// Cursor notifications
 				if (oCursors && (oCursors->type == uris.atom_Vector))
 				{
@@ -407,8 +672,21 @@ void BSEQuencer_GUI::port_event(uint32_t port, uint32_t buffer_size,
 						int* cb = (int*)(&vec->body + 1);
 						if (memcmp (cursorBits, cb, MAXSTEPS * sizeof(int)))
 						{
+							// Redraw the cursor overlay of the changed
+							// steps only
+							uint32_t dirty[ROWS] = {0};
+							for (int s = 0; s < MAXSTEPS; ++s)
+							{
+								const uint32_t changed = cursorBits[s] ^ uint32_t (cb[s]);
+								if (!changed) continue;
+								for (int r = 0; r < ROWS; ++r)
+								{
+									if (changed & (1 << r)) markPad (r, s, dirty);
+								}
+							}
+
 							memcpy (&cursorBits, cb, MAXSTEPS * sizeof(int));
-							drawPad ();
+							drawCursors (dirty);
 						}
 					}
 				}
@@ -534,6 +812,9 @@ void BSEQuencer_GUI::port_event(uint32_t port, uint32_t buffer_size,
 void BSEQuencer_GUI::scale ()
 {
 	hide ();
+	padSprites.clear ();
+	getTextLayoutCache ()->clear ();
+
 	//Scale fonts
 	ctLabelFont.setFontSize (12 * sz);
 	tgLabelFont.setFontSize (12 * sz);
@@ -541,13 +822,8 @@ void BSEQuencer_GUI::scale ()
 	lfLabelFont.setFontSize (12 * sz);
 
 	//Background
-	cairo_surface_t* surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1250 * sz, 820 * sz);
-	cairo_t* cr = cairo_create (surface);
-	cairo_scale (cr, sz, sz);
-	cairo_set_source_surface(cr, bgImageSurface, 0, 0);
-	cairo_paint(cr);
+	cairo_surface_t* surface = BWidgets::ImageCache::load (pluginPath + BG_FILE, sz);
 	widgetBg.loadFillFromCairoSurface(surface);
-	cairo_destroy (cr);
 	cairo_surface_destroy (surface);
 
 	//Scale widgets
@@ -558,6 +834,31 @@ void BSEQuencer_GUI::scale ()
 	scaleFocus ();
 	RESIZE (captionSurface, 18, 88, 64, 484, sz);
 
+	RESIZE (presetLabel, 440, 20, 55, 20, sz);
+	RESIZE (presetListBox, 495, 20, 250, 20, sz);
+	presetListBox.resizeListBox (BUtilities::Point (250 * sz, 360 * sz));
+	presetListBox.resizeListBoxItems (BUtilities::Point (250 * sz, 20 * sz));
+	RESIZE (patternLabel, 440, 52, 55, 20, sz);
+	RESIZE (patternListBox, 495, 52, 50, 20, sz);
+	patternListBox.resizeListBox (BUtilities::Point (50 * sz, 340 * sz));
+	patternListBox.resizeListBoxItems (BUtilities::Point (50 * sz, 20 * sz));
+	RESIZE (patternNextLabel, 555, 52, 40, 20, sz);
+	RESIZE (patternNextListBox, 595, 52, 85, 20, sz);
+	patternNextListBox.resizeListBox (BUtilities::Point (85 * sz, 360 * sz));
+	patternNextListBox.resizeListBoxItems (BUtilities::Point (85 * sz, 20 * sz));
+	RESIZE (patternSwitchLabel, 690, 52, 55, 20, sz);
+	RESIZE (patternSwitchListBox, 745, 52, 110, 20, sz);
+	patternSwitchListBox.resizeListBox (BUtilities::Point (110 * sz, 100 * sz));
+	patternSwitchListBox.resizeListBoxItems (BUtilities::Point (110 * sz, 20 * sz));
+	RESIZE (patternSelectLabel, 865, 52, 40, 20, sz);
+	RESIZE (patternSelectListBox, 905, 52, 105, 20, sz);
+	patternSelectListBox.resizeListBox (BUtilities::Point (105 * sz, 140 * sz));
+	patternSelectListBox.resizeListBoxItems (BUtilities::Point (105 * sz, 20 * sz));
+	RESIZE (patternKeysListBox, 1015, 52, 55, 20, sz);
+	patternKeysListBox.resizeListBox (BUtilities::Point (55 * sz, 240 * sz));
+	patternKeysListBox.resizeListBoxItems (BUtilities::Point (55 * sz, 20 * sz));
+	RESIZE (patternPlayingLabel, 1075, 52, 85, 20, sz);
+
 	RESIZE (modeBox, 920, 88, 310, 180, sz);
 	RESIZE (modeBoxLabel, 10, 10, 290, 20, sz);
 	RESIZE (modeLabel, 10, 80, 60, 20, sz);
@@ -576,7 +877,9 @@ void BSEQuencer_GUI::scale ()
 	RESIZE (modeOnKeyListBox, 180, 140, 120, 20, sz);
 	modeOnKeyListBox.resizeListBox (BUtilities::Point (120 * sz, 80 * sz));
 	modeOnKeyListBox.resizeListBoxItems (BUtilities::Point (120 * sz, 20 * sz));
-	RESIZE (modePlayLabel, 10, 50, 205, 20, sz);
+	RESIZE (modePlayLabel, 10, 50, 155, 20, sz);
+	RESIZE (modeFillButton, 170, 45, 50, 20, sz);
+	RESIZE (modeRecordButton, 225, 45, 40, 20, sz);
 	RESIZE (modePlayButton, 270, 40, 30, 30, sz);
 
 	RESIZE (toolBox, 920, 280, 310, 292, sz);
@@ -586,6 +889,17 @@ void BSEQuencer_GUI::scale ()
 	RESIZE (toolResetButton, 90, 130, 20, 20, sz);
 	RESIZE (toolUndoButton, 120, 130, 20, 20, sz);
 	RESIZE (toolRedoButton, 150, 130, 20, 20, sz);
+	RESIZE (toolImportButton, 10, 130, 70, 20, sz);
+	RESIZE (toolRatchetListBox, 185, 130, 50, 20, sz);
+	toolRatchetListBox.resizeListBox (BUtilities::Point (50 * sz, 160 * sz));
+	toolRatchetListBox.moveListBox (BUtilities::Point (0, -160 * sz));
+	toolRatchetListBox.resizeListBoxItems (BUtilities::Point (50 * sz, 20 * sz));
+	RESIZE (toolRatchetCurveListBox, 240, 130, 60, 20, sz);
+	toolRatchetCurveListBox.resizeListBox (BUtilities::Point (60 * sz, 60 * sz));
+	toolRatchetCurveListBox.resizeListBoxItems (BUtilities::Point (60 * sz, 20 * sz));
+	RESIZE (toolConditionListBox, 240, 70, 60, 20, sz);
+	toolConditionListBox.resizeListBox (BUtilities::Point (60 * sz, 240 * sz));
+	toolConditionListBox.resizeListBoxItems (BUtilities::Point (60 * sz, 20 * sz));
 	RESIZE (toolButtonBoxCtrlLabel, 10, 10, 80, 20, sz);
 	RESIZE (toolButtonBoxChLabel, 10, 70, 80, 20, sz);
 	RESIZE (toolButtonBoxEditLabel, 10, 100, 80, 20, sz);
@@ -612,18 +926,23 @@ void BSEQuencer_GUI::scale ()
 	propertiesBaseListBox.resizeListBox (BUtilities::Point (90 * sz, 60 * sz));
 	propertiesBaseListBox.resizeListBoxItems (BUtilities::Point (90 * sz, 20 * sz));
 	RESIZE (propertiesRootLabel, 10, 115, 60, 20, sz);
-	RESIZE (propertiesRootListBox, 110, 115, 90, 20, sz);
-	propertiesRootListBox.resizeListBox (BUtilities::Point (90 * sz, 160 * sz));
+	RESIZE (propertiesRootListBox, 80, 115, 60, 20, sz);
+	propertiesRootListBox.resizeListBox (BUtilities::Point (60 * sz, 160 * sz));
 	propertiesRootListBox.moveListBox (BUtilities::Point (0, -160 * sz));
-	propertiesRootListBox.resizeListBoxItems (BUtilities::Point (90 * sz, 20 * sz));
-	RESIZE (propertiesSignatureListBox, 210, 115, 90, 20, sz);
-	propertiesSignatureListBox.resizeListBox (BUtilities::Point (90 * sz, 80 * sz));
-	propertiesSignatureListBox.resizeListBoxItems (BUtilities::Point (90 * sz, 20 * sz));
-	RESIZE (propertiesOctaveLabel, 10, 145, 65, 20, sz);
-	RESIZE (propertiesOctaveListBox, 210, 145, 90, 20, sz);
+	propertiesRootListBox.resizeListBoxItems (BUtilities::Point (60 * sz, 20 * sz));
+	RESIZE (propertiesSignatureListBox, 150, 115, 50, 20, sz);
+	propertiesSignatureListBox.resizeListBox (BUtilities::Point (50 * sz, 80 * sz));
+	propertiesSignatureListBox.resizeListBoxItems (BUtilities::Point (50 * sz, 20 * sz));
+	RESIZE (propertiesOctaveListBox, 210, 115, 90, 20, sz);
 	propertiesOctaveListBox.resizeListBox (BUtilities::Point (90 * sz, 220 * sz));
 	propertiesOctaveListBox.moveListBox (BUtilities::Point (0, -220 * sz));
 	propertiesOctaveListBox.resizeListBoxItems (BUtilities::Point (90 * sz, 20 * sz));
+	RESIZE (propertiesGrooveLabel, 10, 145, 60, 20, sz);
+	RESIZE (propertiesGrooveListBox, 80, 145, 110, 20, sz);
+	propertiesGrooveListBox.resizeListBox (BUtilities::Point (110 * sz, 100 * sz));
+	propertiesGrooveListBox.moveListBox (BUtilities::Point (0, -100 * sz));
+	propertiesGrooveListBox.resizeListBoxItems (BUtilities::Point (110 * sz, 20 * sz));
+	RESIZE (propertiesSwingSlider, 200, 135, 100, 25, sz);
 	RESIZE (propertiesScaleLabel, 10, 175, 60, 20, sz);
 	RESIZE (propertiesScaleEditIcon, 70, 175, 20, 20, sz);
 	RESIZE (propertiesScaleListBox, 100, 175, 200, 20, sz);
@@ -634,12 +953,15 @@ void BSEQuencer_GUI::scale ()
 	RESIZE (helpButton, 1166, 50, 24, 24, sz);
 	RESIZE (ytButton, 1196, 50, 24, 24, sz);
 	if (scaleEditor) {RESIZE ((*scaleEditor), 420, 20, 360, 760, sz);}
+	if (automationEditor) {RESIZE ((*automationEditor), 445, 280, 360, 300, sz);}
+	if (fileChooser) {RESIZE ((*fileChooser), 425, 230, 400, 320, sz);}
 
 	for (int i = 0; i < NR_SEQUENCER_CHS; ++i)
 	{
 		RESIZE (chBoxes[i].box, 98 + i * 203.5, 590, 193.5, 210, sz);
 		RESIZE (chBoxes[i].chSymbol, 7, 7, 26, 26, sz);
-		RESIZE (chBoxes[i].chLabel, 40, 10, 133.5, 20, sz);
+		RESIZE (chBoxes[i].chLabel, 40, 10, 93.5, 20, sz);
+		RESIZE (chBoxes[i].automationButton, 138.5, 10, 45, 20, sz);
 		RESIZE (chBoxes[i].channelLabel, 10, 50, 100, 20, sz);
 		RESIZE (chBoxes[i].channelListBox, 123.5, 50, 60, 20, sz);
 		chBoxes[i].channelListBox.resizeListBox (BUtilities::Point (60 * sz, 120 * sz));
@@ -679,7 +1001,7 @@ void BSEQuencer_GUI::scaleFocus ()
 	double blockwidth = 0.0;
 	for (std::string textline : textblock)
 	{
-		cairo_text_extents_t ext = padSurface.focusText.getFont ()->getTextExtents (cr, textline);
+		cairo_text_extents_t ext = getTextExtents (cr, *padSurface.focusText.getFont (), textline);
 		if (ext.width > blockwidth) blockwidth = ext.width;
 	}
 	padSurface.focusText.resize (blockwidth + 2 * padSurface.focusText.getXOffset (), blockheight + 2 * padSurface.focusText.getYOffset ());
@@ -691,11 +1013,26 @@ void BSEQuencer_GUI::scaleFocus ()
 
 void BSEQuencer_GUI::applyTheme (BStyles::Theme& theme)
 {
+	padSprites.clear ();
+	getTextLayoutCache ()->clear ();
 	mContainer.applyTheme (theme);
 
 	padSurface.applyTheme (theme);
 	captionSurface.applyTheme (theme);
 
+	presetLabel.applyTheme (theme);
+	presetListBox.applyTheme (theme);
+	patternLabel.applyTheme (theme);
+	patternListBox.applyTheme (theme);
+	patternNextLabel.applyTheme (theme);
+	patternNextListBox.applyTheme (theme);
+	patternSwitchLabel.applyTheme (theme);
+	patternSwitchListBox.applyTheme (theme);
+	patternSelectLabel.applyTheme (theme);
+	patternSelectListBox.applyTheme (theme);
+	patternKeysListBox.applyTheme (theme);
+	patternPlayingLabel.applyTheme (theme);
+
 	modeBox.applyTheme (theme);
 	modeBoxLabel.applyTheme (theme);
 	modeLabel.applyTheme (theme);
@@ -709,6 +1046,8 @@ void BSEQuencer_GUI::applyTheme (BStyles::Theme& theme)
 	modeOnKeyLabel.applyTheme (theme);
 	modeOnKeyListBox.applyTheme (theme);
 	modePlayLabel.applyTheme (theme);
+	modeFillButton.applyTheme (theme);
+	modeRecordButton.applyTheme (theme);
 	modePlayButton.applyTheme (theme);
 
 	toolBox.applyTheme (theme);
@@ -718,6 +1057,11 @@ void BSEQuencer_GUI::applyTheme (BStyles::Theme& theme)
 	toolResetButton.applyTheme (theme);
 	toolUndoButton.applyTheme (theme);
 	toolRedoButton.applyTheme (theme);
+	toolImportButton.applyTheme (theme);
+	if (fileChooser) fileChooser->applyTheme (theme);
+	toolRatchetListBox.applyTheme (theme);
+	toolRatchetCurveListBox.applyTheme (theme);
+	toolConditionListBox.applyTheme (theme);
 	toolButtonBoxCtrlLabel.applyTheme (theme);
 	toolButtonBoxChLabel.applyTheme (theme);
 	toolButtonBoxEditLabel.applyTheme (theme);
@@ -742,8 +1086,10 @@ void BSEQuencer_GUI::applyTheme (BStyles::Theme& theme)
 	propertiesRootLabel.applyTheme (theme);
 	propertiesRootListBox.applyTheme (theme);
 	propertiesSignatureListBox.applyTheme (theme);
-	propertiesOctaveLabel.applyTheme (theme);
 	propertiesOctaveListBox.applyTheme (theme);
+	propertiesGrooveLabel.applyTheme (theme);
+	propertiesGrooveListBox.applyTheme (theme);
+	propertiesSwingSlider.applyTheme (theme);
 	propertiesScaleLabel.applyTheme (theme);
 	propertiesScaleEditIcon.applyTheme (theme);
 	propertiesScaleListBox.applyTheme (theme);
@@ -753,6 +1099,7 @@ void BSEQuencer_GUI::applyTheme (BStyles::Theme& theme)
 		chBoxes[i].box.applyTheme (theme);
 		chBoxes[i].chSymbol.applyTheme (theme);
 		chBoxes[i].chLabel.applyTheme (theme);
+		chBoxes[i].automationButton.applyTheme (theme);
 		chBoxes[i].channelLabel.applyTheme (theme);
 		chBoxes[i].channelListBox.applyTheme (theme);
 		chBoxes[i].pitchLabel.applyTheme (theme);
@@ -800,6 +1147,27 @@ void BSEQuencer_GUI::onCloseRequest (BEvents::WidgetEvent* event)
 		delete scaleEditor;
 		scaleEditor = nullptr;
 	}
+	else if (event && (automationEditor) && (event->getRequestWidget () == automationEditor))
+	{
+		if (automationEditor->getValue () == 1.0)
+		{
+			int ch = automationEditor->getChannel ();
+			automationLanes[ch] = automationEditor->getLane ();
+			send_automation (ch);
+		}
+
+		delete automationEditor;
+		automationEditor = nullptr;
+	}
+
+	else if (event && (fileChooser) && (event->getRequestWidget () == fileChooser))
+	{
+		if (fileChooser->getValue () == 1.0) importSMF (fileChooser->getPath () + PATH_SEPARATOR + fileChooser->getFileName ());
+
+		delete fileChooser;
+		fileChooser = nullptr;
+	}
+
 	else Window::onCloseRequest (event);
 }
 
@@ -852,6 +1220,49 @@ void BSEQuencer_GUI::send_pad (int row, int step)
 	write_function(controller, INPUT, lv2_atom_total_size(msg), uris.atom_eventTransfer, msg);
 }
 
+void BSEQuencer_GUI::send_row (int row)
+{
+	RowMessage rowmsg (row, pattern.getRow (row));
+
+	uint8_t obj_buf[64];
+	lv2_atom_forge_set_buffer(&forge, obj_buf, sizeof(obj_buf));
+
+	LV2_Atom_Forge_Frame frame;
+	LV2_Atom* msg = (LV2_Atom*)lv2_atom_forge_object(&forge, &frame, 0, uris.notify_rowEvent);
+	lv2_atom_forge_key(&forge, uris.notify_row);
+	lv2_atom_forge_vector(&forge, sizeof(float), uris.atom_Float, sizeof(RowMessage) / sizeof(float), (void*) &rowmsg);
+	lv2_atom_forge_pop(&forge, &frame);
+	write_function(controller, INPUT, lv2_atom_total_size(msg), uris.atom_eventTransfer, msg);
+}
+
+void BSEQuencer_GUI::send_chain ()
+{
+	uint8_t obj_buf[256];
+	lv2_atom_forge_set_buffer(&forge, obj_buf, sizeof(obj_buf));
+
+	LV2_Atom_Forge_Frame frame;
+	LV2_Atom* msg = (LV2_Atom*)lv2_atom_forge_object(&forge, &frame, 0, uris.notify_chainEvent);
+	lv2_atom_forge_key(&forge, uris.notify_chain);
+	lv2_atom_forge_vector(&forge, sizeof(int), uris.atom_Int, NR_PATTERNS, (void*) patternChain);
+	lv2_atom_forge_pop(&forge, &frame);
+	write_function(controller, INPUT, lv2_atom_total_size(msg), uris.atom_eventTransfer, msg);
+}
+
+void BSEQuencer_GUI::send_automation (int ch)
+{
+	AutomationMessage automationmsg (ch, automationLanes[ch]);
+
+	uint8_t obj_buf[256];
+	lv2_atom_forge_set_buffer(&forge, obj_buf, sizeof(obj_buf));
+
+	LV2_Atom_Forge_Frame frame;
+	LV2_Atom* msg = (LV2_Atom*)lv2_atom_forge_object(&forge, &frame, 0, uris.notify_automationEvent);
+	lv2_atom_forge_key(&forge, uris.notify_automation);
+	lv2_atom_forge_vector(&forge, sizeof(float), uris.atom_Float, sizeof(AutomationMessage) / sizeof(float), (void*) &automationmsg);
+	lv2_atom_forge_pop(&forge, &frame);
+	write_function(controller, INPUT, lv2_atom_total_size(msg), uris.atom_eventTransfer, msg);
+}
+
 void BSEQuencer_GUI::send_scaleMaps (int scaleNr)
 {
 	RTScaleMap rtScaleMap; rtScaleMap = scaleMaps[scaleNr];
@@ -922,6 +1333,7 @@ void BSEQuencer_GUI::valueChangedCallback(BEvents::Event* event)
 						ui->modeMidiInChannelListBox.hide ();
 						ui->modeOnKeyLabel.hide ();
 						ui->modeOnKeyListBox.hide ();
+						ui->modeRecordButton.show ();
 						for (int i = 0; i < NR_SEQUENCER_CHS; ++i) ui->chBoxes[i].pitchScreen.show ();
 					}
 
@@ -935,6 +1347,7 @@ void BSEQuencer_GUI::valueChangedCallback(BEvents::Event* event)
 						ui->modeMidiInChannelListBox.show ();
 						ui->modeOnKeyLabel.show ();
 						ui->modeOnKeyListBox.show ();
+						ui->modeRecordButton.hide ();
 						for (int i = 0; i < NR_SEQUENCER_CHS; ++i) ui->chBoxes[i].pitchScreen.hide ();
 					}
 
@@ -948,6 +1361,7 @@ void BSEQuencer_GUI::valueChangedCallback(BEvents::Event* event)
 						ui->modeMidiInChannelListBox.hide ();
 						ui->modeOnKeyLabel.hide ();
 						ui->modeOnKeyListBox.hide ();
+						ui->modeRecordButton.show ();
 						for (int i = 0; i < NR_SEQUENCER_CHS; ++i) ui->chBoxes[i].pitchScreen.show ();
 					}
 				}
@@ -959,9 +1373,19 @@ void BSEQuencer_GUI::valueChangedCallback(BEvents::Event* event)
 					else ui->propertiesScaleEditIcon.show();
 				}
 
+				// MIDI pattern selection changed
+				if (widgetNr == PATTERN_SELECT)
+				{
+					if (SELECT_BY_KEYS (int (value))) ui->patternKeysListBox.show ();
+					else ui->patternKeysListBox.hide ();
+				}
+
+				// Edit pattern changed
+				if (widgetNr == PATTERN) ui->patternNextListBox.setValue (ui->patternChain[LIMIT ((int) value, 0, NR_PATTERNS - 1)]);
+
 				// Pad relevant changes
 				if ((widgetNr == NR_OF_STEPS) || (widgetNr == STEPS_PER) ||(widgetNr == ROOT) || (widgetNr == SIGNATURE) ||
-					(widgetNr == SCALE)) ui->drawPad ();
+					(widgetNr == SCALE) || (widgetNr == PATTERN)) ui->drawPad ();
 
 				// Caption relevant changes
 				if ((widgetNr == ROOT) || (widgetNr == SIGNATURE) || (widgetNr == SCALE)) ui->drawCaption ();
@@ -1027,6 +1451,119 @@ void BSEQuencer_GUI::editPressedCallback (BEvents::Event* event)
 	}
 }
 
+void BSEQuencer_GUI::automationPressedCallback (BEvents::Event* event)
+{
+	if ((event) && (event->getWidget ()) && (event->getWidget()->getMainWindow()))
+	{
+		BWidgets::Widget* widget = (BWidgets::Widget*) event->getWidget();
+		BSEQuencer_GUI* ui = (BSEQuencer_GUI*)(widget->getMainWindow());
+
+		if (ui->automationEditor) return;
+
+		for (int ch = 0; ch < NR_SEQUENCER_CHS; ++ch)
+		{
+			if (widget == &ui->chBoxes[ch].automationButton)
+			{
+				ui->automationEditor = new AutomationEditor
+				(
+					445 * ui->sz, 280 * ui->sz, 360 * ui->sz, 300 * ui->sz, "automationeditor",
+					ch,
+					ui->controllerWidgets[NR_OF_STEPS]->getValue (),
+					ui->automationLanes[ch]
+				);
+				ui->add (*ui->automationEditor);
+				break;
+			}
+		}
+	}
+}
+
+void BSEQuencer_GUI::importPressedCallback (BEvents::Event* event)
+{
+	if ((event) && (event->getWidget ()) && (event->getWidget()->getMainWindow()))
+	{
+		BSEQuencer_GUI* ui = (BSEQuencer_GUI*)(((BWidgets::Widget*)(event->getWidget()))->getMainWindow());
+
+		if (!ui->fileChooser)
+		{
+			ui->fileChooser = new BWidgets::FileChooser
+			(
+				425 * ui->sz, 230 * ui->sz, 400 * ui->sz, 320 * ui->sz, "filechooser",
+				(getenv ("HOME") ? getenv ("HOME") : "/"),
+				std::vector<BWidgets::FileFilter>
+				{
+					BWidgets::FileFilter {"MIDI files", std::regex (".*\\.(mid|midi|smf)$", std::regex_constants::icase)},
+					BWidgets::FileFilter {"All files", std::regex (".*")}
+				},
+				std::vector<std::string>
+				{
+					BSEQUENCER_LABEL_IMPORT, BSEQUENCER_LABEL_OPEN, BSEQUENCER_LABEL_CANCEL, "", "",
+					BSEQUENCER_LABEL_NEW_FOLDER, BSEQUENCER_LABEL_CANT_CREATE_FOLDER
+				}
+			);
+			ui->fileChooser->applyTheme (ui->theme);
+			ui->add (*ui->fileChooser);
+		}
+	}
+}
+
+/*
+ * Imports a Standard MIDI File into the actual pattern (see SMFImport). The
+ * notes are mapped to the rows of the actual scale map and quantized to the
+ * step grid. They are set to the selected channel (or channel 1 if no
+ * channel is selected) and sent to the plugin pad by pad. Can be undone.
+ */
+void BSEQuencer_GUI::importSMF (const std::string& path)
+{
+	SMFImportSettings settings;
+	const int selCh = controllerWidgets[SELECTION_CH]->getValue ();
+	settings.ch = ((selCh >= 1) && (selCh <= NR_SEQUENCER_CHS) ? selCh : 1);
+	settings.stepsPerBeat =
+	(
+		controllers[BASE] == PER_BEAT ?
+		controllers[STEPS_PER] :
+		controllers[STEPS_PER] / controllers[AUTOPLAY_BPB]
+	);
+	settings.nrSteps = controllers[NR_OF_STEPS];
+
+	const int scaleNr = controllers[SCALE];
+	BScale importScale
+	(
+		controllers[ROOT] + controllers[SIGNATURE] + (controllers[OCTAVE] + 1) * 12,
+		scaleMaps[scaleNr].scaleNotes
+	);
+	SMFImport importer
+	(
+		scaleMaps[scaleNr].elements.data (),
+		importScale,
+		controllers[CH + (settings.ch - 1) * CH_SIZE + NOTE_OFFSET]
+	);
+
+	Pad pads[ROWS][MAXSTEPS];
+	if (!importer.import (path, settings, pads)) return;
+
+	if (wheelScrolled)
+	{
+		pattern.store ();
+		wheelScrolled = false;
+	}
+
+	for (int r = 0; r < ROWS; ++r)
+	{
+		for (int s = 0; s < MAXSTEPS; ++s)
+		{
+			pattern.setPad (r, s, pads[r][s]);
+			send_pad (r, s);
+		}
+	}
+
+	drawPad ();
+	pattern.store ();
+
+	std::cerr << "BSEQuencer.lv2#GUI: " << importer.getNrImported () << " notes imported from " << path << ", " <<
+		     importer.getNrSkipped () << " notes skipped.\n";
+}
+
 void BSEQuencer_GUI::resetClickedCallback (BEvents::Event* event)
 {
 	if ((event) && (event->getWidget ()) && (event->getWidget()->getMainWindow()))
@@ -1134,7 +1671,10 @@ void BSEQuencer_GUI::padsPressedCallback (BEvents::Event* event)
 							ui->controllerWidgets[SELECTION_NOTE_RAND]->getValue(),
 							ui->controllerWidgets[SELECTION_OCTAVE_RAND]->getValue(),
 							ui->controllerWidgets[SELECTION_VELOCITY_RAND]->getValue(),
-							ui->controllerWidgets[SELECTION_DURATION_RAND]->getValue()
+							ui->controllerWidgets[SELECTION_DURATION_RAND]->getValue(),
+							ui->controllerWidgets[SELECTION_RATCHET]->getValue(),
+							ui->controllerWidgets[SELECTION_RATCHET_CURVE]->getValue(),
+							ui->controllerWidgets[SELECTION_CONDITION]->getValue()
 						);
 
 						// Delete ch if duration == 0
@@ -1223,6 +1763,9 @@ void BSEQuencer_GUI::padsPressedCallback (BEvents::Event* event)
 							ui->controllerWidgets[SELECTION_OCTAVE]->setValue(pd.pitchOctave);
 							ui->controllerWidgets[SELECTION_VELOCITY]->setValue(pd.velocity);
 							ui->controllerWidgets[SELECTION_DURATION]->setValue(pd.duration);
+							ui->controllerWidgets[SELECTION_RATCHET]->setValue(pd.ratchet);
+							ui->controllerWidgets[SELECTION_RATCHET_CURVE]->setValue(pd.ratchetCurve);
+							ui->controllerWidgets[SELECTION_CONDITION]->setValue(pd.condition);
 						}
 
 						else if (edit == EDIT_MERGE)
@@ -1316,6 +1859,9 @@ void BSEQuencer_GUI::padsPressedCallback (BEvents::Event* event)
 					ui->controllerWidgets[SELECTION_OCTAVE_RAND]->setValue (pd.randOctave);
 					ui->controllerWidgets[SELECTION_VELOCITY_RAND]->setValue (pd.randVelocity);
 					ui->controllerWidgets[SELECTION_DURATION_RAND]->setValue (pd.randDuration);
+					ui->controllerWidgets[SELECTION_RATCHET]->setValue (pd.ratchet);
+					ui->controllerWidgets[SELECTION_RATCHET_CURVE]->setValue (pd.ratchetCurve);
+					ui->controllerWidgets[SELECTION_CONDITION]->setValue (pd.condition);
 				}
 			}
 		}
@@ -1636,7 +2182,9 @@ void BSEQuencer_GUI::padsFocusedCallback (BEvents::Event* event)
 				BSEQUENCER_LABEL_NOTE ": " + std::to_string (int (pd.pitchNote)) + " ± " + std::to_string (int (abs (pd.randNote))) + "\n" +
 				BSEQUENCER_LABEL_OCTAVE ": " + std::to_string (int (pd.pitchOctave)) + " ± " + std::to_string (int (abs (pd.randOctave))) + "\n" +
 				BSEQUENCER_LABEL_VELOCITY ": " + BUtilities::to_string (pd.velocity, "%1.2f") + " ± " + BUtilities::to_string (abs (pd.randVelocity), "%1.2f") + "\n" +
-				BSEQUENCER_LABEL_DURATION ": " + BUtilities::to_string (pd.duration, "%1.2f") + " (" + BUtilities::to_string (pdr, "%1.2f") + ")");
+				BSEQUENCER_LABEL_DURATION ": " + BUtilities::to_string (pd.duration, "%1.2f") + " (" + BUtilities::to_string (pdr, "%1.2f") + ")\n" +
+				BSEQUENCER_LABEL_RATCHET ": " + std::to_string (int (pd.ratchet)) + "x " + BUtilities::to_string (pd.ratchetCurve, "%1.2f") + "\n" +
+				BSEQUENCER_LABEL_CONDITION ": " + getConditionLabel (pd.condition));
 			ui->scaleFocus ();
 		}
 	}
@@ -1645,6 +2193,78 @@ void BSEQuencer_GUI::padsFocusedCallback (BEvents::Event* event)
 	else if (event->getEventType () == BEvents::FOCUS_OUT_EVENT) focusOutCallback (event);
 }
 
+void BSEQuencer_GUI::captionScrolledCallback (BEvents::Event* event)
+{
+	if ((event) && (event->getWidget ()) && (event->getWidget()->getMainWindow()) &&
+		((event->getEventType () == BEvents::WHEEL_SCROLL_EVENT)))
+	{
+		BWidgets::DrawingSurface* widget = (BWidgets::DrawingSurface*) event->getWidget ();
+		BSEQuencer_GUI* ui = (BSEQuencer_GUI*) widget->getMainWindow();
+		BEvents::WheelEvent* wheelEvent = (BEvents::WheelEvent*) event;
+
+		const double height = ui->captionSurface.getEffectiveHeight ();
+		int row = (ROWS - 1) - ((int) ((wheelEvent->getPosition ().y - widget->getYOffset()) / (height / ROWS)));
+		if ((row < 0) || (row >= ROWS)) return;
+
+		RowProperties props = ui->pattern.getRow (row);
+		int dir = (wheelEvent->getDelta().y > 0 ? 1 : (wheelEvent->getDelta().y < 0 ? -1 : 0));
+		if (dir == 0) return;
+
+		// SHIFT: Change row clock (multiplier / divider)
+		if (ui->modifier == MODIFIER_DURATION)
+		{
+			const int nrRatios = 11;
+			const int ratios[nrRatios][2] = {{4, 1}, {3, 1}, {2, 1}, {3, 2}, {1, 1}, {2, 3}, {1, 2}, {1, 3}, {1, 4}, {1, 6}, {1, 8}};
+			int nr = 4;
+			for (int i = 0; i < nrRatios; ++i)
+			{
+				if ((ratios[i][0] == int (props.multiplier)) && (ratios[i][1] == int (props.divider)))
+				{
+					nr = i;
+					break;
+				}
+			}
+			nr = LIMIT (nr - dir, 0, nrRatios - 1);
+			props.multiplier = ratios[nr][0];
+			props.divider = ratios[nr][1];
+		}
+
+		// Otherwise: Change row length (0 = all steps)
+		else
+		{
+			int nrSteps = ui->controllerWidgets[NR_OF_STEPS]->getValue ();
+			int length = (props.length == 0 ? nrSteps : int (props.length)) + dir;
+			props.length = (length >= nrSteps ? 0 : LIMIT (length, 1, nrSteps));
+		}
+
+		if (props != ui->pattern.getRow (row))
+		{
+			ui->pattern.setRow (row, props);
+			ui->send_row (row);
+			ui->drawCaption ();
+			ui->drawPad ();
+		}
+	}
+}
+
+void BSEQuencer_GUI::chainChangedCallback (BEvents::Event* event)
+{
+	if ((event) && (event->getWidget ()))
+	{
+		BWidgets::ValueWidget* widget = (BWidgets::ValueWidget*) event->getWidget ();
+		BSEQuencer_GUI* ui = (BSEQuencer_GUI*) widget->getMainWindow();
+		if (!ui) return;
+
+		int pat = LIMIT ((int) ui->controllers[PATTERN], 0, NR_PATTERNS - 1);
+		int next = widget->getValue ();
+		if (ui->patternChain[pat] != next)
+		{
+			ui->patternChain[pat] = next;
+			ui->send_chain ();
+		}
+	}
+}
+
 void BSEQuencer_GUI::drawCaption ()
 {
 	cairo_surface_t* surface = captionSurface.getDrawingSurface();
@@ -1698,6 +2318,22 @@ void BSEQuencer_GUI::drawCaption ()
 
 		cairo_move_to (cr, width / 2 - ext.width / 2, (15.5 - i) * height / 16 + ext.height / 2);
 		cairo_show_text (cr, label.c_str());
+
+		// Row length and clock
+		RowProperties props = pattern.getRow (i);
+		if (props != RowProperties ())
+		{
+			std::string rowlabel = "";
+			if (props.length != 0) rowlabel += std::to_string (int (props.length));
+			if (props.multiplier != 1) rowlabel += " x" + std::to_string (int (props.multiplier));
+			if (props.divider != 1) rowlabel += " /" + std::to_string (int (props.divider));
+
+			cairo_text_extents_t rowext;
+			cairo_set_font_size (cr, ctLabelFont.getFontSize () * 0.5);
+			cairo_text_extents (cr, rowlabel.c_str(), &rowext);
+			cairo_move_to (cr, width - rowext.width - 2.0, (16 - i) * height / 16 - 3.0);
+			cairo_show_text (cr, rowlabel.c_str());
+		}
 	}
 
 	cairo_destroy (cr);
@@ -1706,6 +2342,9 @@ void BSEQuencer_GUI::drawCaption ()
 
 void BSEQuencer_GUI::drawPad ()
 {
+	cairo_surface_t* overlay = padSurface.getOverlaySurface ();
+	cairo_surface_clear (overlay);
+
 	cairo_surface_t* surface = padSurface.getDrawingSurface();
 	cairo_t* cr = cairo_create (surface);
 	for (int row = 0; row < ROWS; ++row)
@@ -1729,16 +2368,111 @@ void BSEQuencer_GUI::drawPad (const int row, const int step)
 	padSurface.update();
 }
 
-void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
+void BSEQuencer_GUI::drawPad (const uint32_t* dirty)
+{
+	const int nrSteps = controllerWidgets[NR_OF_STEPS]->getValue ();
+	cairo_surface_t* surface = padSurface.getDrawingSurface();
+	cairo_t* cr = cairo_create (surface);
+	for (int row = 0; row < ROWS; ++row)
+	{
+		for (int step = 0; step < nrSteps; ++step)
+		{
+			if (!(dirty[row] & (uint32_t (1) << step))) continue;
+			drawPad (cr, row, step);
+			while (pattern.padHasSuccessor (row, step)) ++step;
+		}
+	}
+	cairo_destroy (cr);
+	updatePads (dirty);
+}
+
+void BSEQuencer_GUI::drawCursors ()
+{
+	cairo_surface_clear (padSurface.getOverlaySurface ());
+	for (int row = 0; row < ROWS; ++row)
+	{
+		for (int step = 0; step < ((int)controllerWidgets[NR_OF_STEPS]->getValue ()); ++step)
+		{
+			drawPadCursor (row, step);
+			while (pattern.padHasSuccessor (row, step)) ++step;
+		}
+	}
+	padSurface.update ();
+}
+
+void BSEQuencer_GUI::drawCursors (const uint32_t* dirty)
+{
+	const int nrSteps = controllerWidgets[NR_OF_STEPS]->getValue ();
+	for (int row = 0; row < ROWS; ++row)
+	{
+		for (int step = 0; step < nrSteps; ++step)
+		{
+			if (!(dirty[row] & (uint32_t (1) << step))) continue;
+			drawPadCursor (row, step);
+			while (pattern.padHasSuccessor (row, step)) ++step;
+		}
+	}
+	updatePads (dirty);
+}
+
+void BSEQuencer_GUI::updatePads (const uint32_t* dirty)
+{
+	const int nrSteps = controllerWidgets[NR_OF_STEPS]->getValue ();
+	const double w = padSurface.getEffectiveWidth () / nrSteps;
+	const double h = padSurface.getEffectiveHeight () / ROWS;
+
+	// Redisplay each contiguous run of changed pads of a row. The window
+	// coalesces overlapping (and adjoining) damage regions.
+	for (int row = 0; row < ROWS; ++row)
+	{
+		int step = 0;
+		while (step < nrSteps)
+		{
+			if (!(dirty[row] & (uint32_t (1) << step)))
+			{
+				++step;
+				continue;
+			}
+
+			const int first = step;
+			while ((step < nrSteps) && (dirty[row] & (uint32_t (1) << step))) ++step;
+
+			const double x0 = round (first * w);
+			const double x1 = round (step * w);
+			const double y0 = round ((ROWS - row - 1) * h);
+			const double y1 = round ((ROWS - row) * h);
+			padSurface.update (BUtilities::RectArea (x0, y0, x1 - x0, y1 - y0));
+		}
+	}
+}
+
+void BSEQuencer_GUI::markPad (const int row, const int step, uint32_t* dirty)
 {
 	int start = step;
 	while (pattern.padHasAntecessor (row, start)) --start;
+	int end = step;
+	while (pattern.padHasSuccessor (row, end)) ++end;
 
-	Pad pd = pattern.getPad (row, start);
+	for (int s = LIMIT (start, 0, MAXSTEPS - 1); s <= LIMIT (end, 0, MAXSTEPS - 1); ++s) dirty[row] |= (uint32_t (1) << s);
+}
+
+void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
+{
+	int start = step;
+	while (pattern.padHasAntecessor (row, start)) --start;
 
 	if ((!cr) || (cairo_status (cr) != CAIRO_STATUS_SUCCESS) || (row < 0) || (row >= ROWS) || (start < 0) ||
 		(start >= (int (controllerWidgets[NR_OF_STEPS]->getValue ())))) return;
 
+	drawPadBackground (cr, row, start);
+	drawPadButton (cr, row, start, getPadArea (row, start), false);
+
+	// Draw cursor overlay
+	drawPadCursor (row, start);
+}
+
+void BSEQuencer_GUI::drawPadBackground (cairo_t* cr, const int row, const int start)
+{
 	// Get size of drawing area
 	const double width = padSurface.getEffectiveWidth ();
 	const double height = padSurface.getEffectiveHeight ();
@@ -1746,14 +2480,9 @@ void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
 	const double h = height / ROWS;
 	const double x = start * w;
 	const double y = (ROWS - row - 1) * h;
-	const double xr = round (x);
 	const double yr = round (y);
-	int ps = pattern.padGetSize (row, start);
-	if (start + ps > int (controllerWidgets[NR_OF_STEPS]->getValue ())) ps = int (controllerWidgets[NR_OF_STEPS]->getValue ()) - start;
-	const double wr = round (x + w * ps) - xr;
 	const double hr = round (y + h) - yr;
 
-
 	// Odd or even?
 	BColors::Color bg = ((int (start / controllerWidgets[STEPS_PER]->getValue ())) % 2) ? oddPadBgColor : evenPadBgColor;
 
@@ -1765,6 +2494,9 @@ void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
 	int clipSMax = clipBoard.origin.second + clipBoard.extends.second;
 	if (clipSMin > clipSMax) std::swap (clipSMin, clipSMax);
 
+	// Steps behind the row length aren't played
+	const int rowLength = pattern.getRow (row).length;
+
 	// Draw backgroung
 	int i = 0;
 	do
@@ -1775,6 +2507,7 @@ void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
 			double xi = round (x + i * w);
 			double wi = round (x + (i + 1) * w) - xi;
 			if ((!clipBoard.ready) && (row >= clipRMin) && (row <= clipRMax) && (start + i >= clipSMin) && (start + i <= clipSMax)) bgi.applyBrightness (1.5);
+			if ((rowLength > 0) && (start + i >= rowLength)) bgi.applyBrightness (-0.5);
 			cairo_set_source_rgba (cr, CAIRO_RGBA (bgi));
 			cairo_set_line_width (cr, 0.0);
 			cairo_rectangle (cr, xi, yr, wi, hr);
@@ -1782,38 +2515,76 @@ void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
 		}
 		++i;
 	} while (pattern.padHasSuccessor (row, start + i - 1));
+}
 
-	// Draw pad
+void BSEQuencer_GUI::drawPadButton (cairo_t* cr, const int row, const int start, const BUtilities::RectArea& area, const bool playing)
+{
+	const Pad pd = pattern.getPad (row, start);
+	const int rowLength = pattern.getRow (row).length;
+	const double xr = area.getX ();
+	const double yr = area.getY ();
+	const double wr = area.getWidth ();
+	const double hr = area.getHeight ();
 	int ch = padGetChannel (row, start);
 	int ctrl = padGetControl (row, start);
-	double vel = (pd.velocity <= 1 ?  pd.velocity - 1 : (pd.velocity - 1) * 0.5);
+	const int velBucket = LIMIT (int (round (pd.velocity * 100.0)), 0, 200);	// 1/100 resolution
+	const double velocity = double (velBucket) / 100.0;
+	double vel = (velocity <= 1 ?  velocity - 1 : (velocity - 1) * 0.5);
 	int oct = pd.pitchOctave;
 
 	if ((ch >= 0) && (ch <= NR_SEQUENCER_CHS) && (ctrl >= 0) && (ctrl < NR_CTRL_BUTTONS))
 	{
+		const bool dimmed = (rowLength > 0) && (start >= rowLength);
 		BColors::Color color = chButtonStyles[ch].color;
 		if (ch > 0) color.applyBrightness(vel);
-		int i = 0;
-		do
+		if (dimmed) color.applyBrightness (-0.5);
+		if (playing)
 		{
-			if (cursorBits[start + i] & (1 << row))
-			{
-				color.setAlpha (1.0);
-				color.applyBrightness (0.75);
-				break;
-			}
-			++i;
+			color.setAlpha (1.0);
+			color.applyBrightness (0.75);
 		}
-		while (pattern.padHasSuccessor (row, start + i - 1));
 
 		int symbol = ctrlButtonStyles[ctrl].symbol;
+		const float fraction = (pd.duration == 0 ? 1 : pd.duration / ceil (pd.duration));
+		const int bw = wr - 2;
+		const int bh = hr - 2;
+
+		// Full size buttons: Blit pre-rendered sprite
+		if ((fraction == 1.0f) && (bw > 0) && (bh > 0) && (bw < 0x1000) && (bh < 0x1000))
+		{
+			const uint64_t key =
+				uint64_t (bw) | (uint64_t (bh) << 12) | (uint64_t (ch) << 24) | (uint64_t (ctrl) << 28) |
+				(uint64_t (velBucket) << 32) | (uint64_t (dimmed) << 40) | (uint64_t (playing) << 41);
 
-		drawButton (cr, xr + 1, yr + 1, wr - 2, hr - 2, color, symbol, (pd.duration == 0 ? 1 : pd.duration / ceil (pd.duration)));
+			cairo_surface_t* sprite = padSprites.find (key);
+			if (!sprite)
+			{
+				sprite = padSprites.add (key, bw, bh);
+				if (sprite)
+				{
+					cairo_t* scr = cairo_create (sprite);
+					drawButton (scr, 0, 0, bw, bh, color, symbol);
+					cairo_destroy (scr);
+				}
+			}
+
+			if (sprite)
+			{
+				cairo_save (cr);
+				cairo_set_source_surface (cr, sprite, xr + 1, yr + 1);
+				cairo_rectangle (cr, xr + 1, yr + 1, bw, bh);
+				cairo_fill (cr);
+				cairo_restore (cr);
+			}
+			else drawButton (cr, xr + 1, yr + 1, wr - 2, hr - 2, color, symbol, fraction);
+		}
+
+		else drawButton (cr, xr + 1, yr + 1, wr - 2, hr - 2, color, symbol, fraction);
 
 		// Displays pitch octave
 		if ((pd.duration > 0.0) && (pd.velocity > 0.0))
 		{
-			cairo_surface_t* surface = padSurface.getDrawingSurface();
+			cairo_surface_t* surface = cairo_get_target (cr);
 			cairo_t* cr = cairo_create (surface);
 			double h = 0.75 * lfLabelFont.getFontSize ();
 
@@ -1859,6 +2630,63 @@ void BSEQuencer_GUI::drawPad (cairo_t* cr, const int row, const int step)
 	}
 }
 
+void BSEQuencer_GUI::drawPadCursor (const int row, const int step)
+{
+	int start = step;
+	while (pattern.padHasAntecessor (row, start)) --start;
+	if ((row < 0) || (row >= ROWS) || (start < 0) || (start >= (int (controllerWidgets[NR_OF_STEPS]->getValue ())))) return;
+
+	cairo_surface_t* surface = padSurface.getOverlaySurface ();
+	cairo_t* cr = cairo_create (surface);
+	if (cairo_status (cr) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_destroy (cr);
+		return;
+	}
+
+	const BUtilities::RectArea area = getPadArea (row, start);
+
+	// Clear
+	cairo_save (cr);
+	cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+	cairo_rectangle (cr, area.getX (), area.getY (), area.getWidth (), area.getHeight ());
+	cairo_fill (cr);
+	cairo_restore (cr);
+
+	// Highlight the whole pad if the cursor is on any of its steps
+	if (playingPattern == controllers[PATTERN])
+	{
+		int i = 0;
+		do
+		{
+			if (cursorBits[start + i] & (1 << row))
+			{
+				drawPadBackground (cr, row, start);
+				drawPadButton (cr, row, start, area, true);
+				break;
+			}
+			++i;
+		}
+		while (pattern.padHasSuccessor (row, start + i - 1));
+	}
+
+	cairo_destroy (cr);
+}
+
+BUtilities::RectArea BSEQuencer_GUI::getPadArea (const int row, const int start)
+{
+	const int nrSteps = controllerWidgets[NR_OF_STEPS]->getValue ();
+	const double w = padSurface.getEffectiveWidth () / nrSteps;
+	const double h = padSurface.getEffectiveHeight () / ROWS;
+	const double x = start * w;
+	const double y = (ROWS - row - 1) * h;
+	const double xr = round (x);
+	const double yr = round (y);
+	int ps = pattern.padGetSize (row, start);
+	if (start + ps > nrSteps) ps = nrSteps - start;
+	return BUtilities::RectArea (xr, yr, round (x + w * ps) - xr, round (y + h) - yr);
+}
+
 bool BSEQuencer_GUI::padIsSelected (const int row, const int step)
 {
 	int s = step;
@@ -1913,6 +2741,32 @@ void BSEQuencer_GUI::padClip (const int row, const int step)
 	}
 }
 
+std::string BSEQuencer_GUI::getConditionLabel (const int condition)
+{
+	switch (condition)
+	{
+		case COND_NONE:		return "-";
+		case COND_FIRST:	return BSEQUENCER_LABEL_FIRST;
+		case COND_NOT_FIRST:	return BSEQUENCER_LABEL_NOT_FIRST;
+		case COND_FILL:		return BSEQUENCER_LABEL_FILL;
+		case COND_NOT_FILL:	return BSEQUENCER_LABEL_NOT_FILL;
+		case COND_PRE:		return BSEQUENCER_LABEL_PRE;
+		case COND_NOT_PRE:	return BSEQUENCER_LABEL_NOT_PRE;
+		default:		break;
+	}
+
+	// A:B loop conditions
+	for (int b = 2; b <= MAX_CONDITION_LOOPS; ++b)
+	{
+		for (int a = 1; a <= b; ++a)
+		{
+			if (COND_LOOP (a, b) == condition) return std::to_string (a) + ":" + std::to_string (b);
+		}
+	}
+
+	return "?";
+}
+
 static LV2UI_Handle instantiate (const LV2UI_Descriptor *descriptor,
 						  const char *plugin_uri,
 						  const char *bundle_path,
@@ -1924,7 +2778,7 @@ static LV2UI_Handle instantiate (const LV2UI_Descriptor *descriptor,
 	PuglNativeView parentWindow = 0;
 	LV2UI_Resize* resize = NULL;
 
-	if (strcmp(plugin_uri, BSEQUENCER_URI) != 0)
+	if ((strcmp(plugin_uri, BSEQUENCER_URI) != 0) && (strcmp(plugin_uri, BSEQUENCER_MULTIOUT_URI) != 0))
 	{
 		std::cerr << "BSEQuencer.lv2#GUI: GUI does not support plugin with URI " << plugin_uri << std::endl;
 		return NULL;
@@ -43,6 +43,9 @@
 #include "BWidgets/Text.hpp"
 #include "BWidgets/PopupListBox.hpp"
 #include "BWidgets/ImageIcon.hpp"
+#include "BWidgets/TextButton.hpp"
+#include "BWidgets/FileChooser.hpp"
+#include "BWidgets/ImageCache.hpp"
 #include "screen.h"
 
 #ifdef LOCALEFILE
@@ -61,13 +64,21 @@
 #include "UndoButton.hpp"
 #include "RedoButton.hpp"
 #include "PadSurface.hpp"
+#include "SpriteCache.hpp"
 #include "DialRangeValue.hpp"
 #include "definitions.h"
 #include "ports.h"
 #include "urids.h"
 #include "Pad.hpp"
 #include "PadMessage.hpp"
+#include "RowProperties.hpp"
+#include "RowMessage.hpp"
+#include "PresetBank.hpp"
+#include "AutomationLane.hpp"
+#include "AutomationMessage.hpp"
 #include "ScaleEditor.hpp"
+#include "SMFImport.hpp"
+#include "AutomationEditor.hpp"
 #include "Journal.hpp"
 #include "Pattern.hpp"
 
@@ -87,6 +98,9 @@ public:
 	void send_ui_on ();
 	void send_ui_off ();
 	void send_pad (int row, int step);
+	void send_row (int row);
+	void send_chain ();
+	void send_automation (int ch);
 	void send_scaleMaps (int scaleNr);
 	virtual void onConfigureRequest (BEvents::ExposeEvent* event) override;
 	virtual void onCloseRequest (BEvents::WidgetEvent* event) override;
@@ -107,21 +121,35 @@ private:
 	static void padsPressedCallback (BEvents::Event* event);
 	static void padsScrolledCallback (BEvents::Event* event);
 	static void padsFocusedCallback (BEvents::Event* event);
+	static void captionScrolledCallback (BEvents::Event* event);
+	static void chainChangedCallback (BEvents::Event* event);
+	static void automationPressedCallback (BEvents::Event* event);
+	static void importPressedCallback (BEvents::Event* event);
 	void scale ();
 	void scaleFocus ();
 	void drawCaption ();
 	void drawPad ();
 	void drawPad (const int row, const int step);
 	void drawPad (cairo_t* cr, const int row, const int step);
+	void drawPad (const uint32_t* dirty);
+	void drawPadBackground (cairo_t* cr, const int row, const int start);
+	void drawPadButton (cairo_t* cr, const int row, const int start, const BUtilities::RectArea& area, const bool playing);
+	void drawPadCursor (const int row, const int step);
+	void drawCursors ();
+	void drawCursors (const uint32_t* dirty);
+	void markPad (const int row, const int step, uint32_t* dirty);
+	void updatePads (const uint32_t* dirty);
+	BUtilities::RectArea getPadArea (const int row, const int start);
 	bool padIsSelected (const int row, const int step);
 	int padGetChannel (const int row, const int step);
 	int padGetControl (const int row, const int step);
 	void padClip (const int row, const int step);
+	static std::string getConditionLabel (const int condition);
+	void importSMF (const std::string& path);
 
 
 	std::string pluginPath;
 	double sz;
-	cairo_surface_t* bgImageSurface;
 
 	BSEQuencerURIs uris;
 	LV2_Atom_Forge forge;
@@ -132,6 +160,15 @@ private:
 
 	//Pads
 	Pattern pattern;
+	bool padSync;		// Full pad sync from the plugin in progress
+	SpriteCache padSprites;	// Pre-rendered pad buttons
+
+	// Pattern chain and pattern currently played by the plugin
+	int patternChain[NR_PATTERNS];
+	int playingPattern;
+
+	// Automation lanes of the edited pattern
+	std::array<AutomationLane, NR_SEQUENCER_CHS> automationLanes;
 
 	struct ClipBoard
 	{
@@ -170,6 +207,19 @@ private:
 	PadSurface padSurface;
 	BWidgets::DrawingSurface captionSurface;
 
+	BWidgets::Label presetLabel;
+	BWidgets::PopupListBox presetListBox;
+	BWidgets::Label patternLabel;
+	BWidgets::PopupListBox patternListBox;
+	BWidgets::Label patternNextLabel;
+	BWidgets::PopupListBox patternNextListBox;
+	BWidgets::Label patternSwitchLabel;
+	BWidgets::PopupListBox patternSwitchListBox;
+	BWidgets::Label patternSelectLabel;
+	BWidgets::PopupListBox patternSelectListBox;
+	BWidgets::PopupListBox patternKeysListBox;
+	BWidgets::Label patternPlayingLabel;
+
 	BWidgets::Widget modeBox;
 	BWidgets::Label modeBoxLabel;
 	BWidgets::Label modeLabel;
@@ -183,6 +233,8 @@ private:
 	BWidgets::Label modeOnKeyLabel;
 	BWidgets::PopupListBox modeOnKeyListBox;
 	BWidgets::Label modePlayLabel;
+	BWidgets::TextToggleButton modeFillButton;
+	BWidgets::TextToggleButton modeRecordButton;
 	PlayStopButton modePlayButton;
 
 	BWidgets::Widget toolBox;
@@ -192,6 +244,10 @@ private:
 	ResetButton toolResetButton;
 	UndoButton toolUndoButton;
 	RedoButton toolRedoButton;
+	BWidgets::TextButton toolImportButton;
+	BWidgets::PopupListBox toolRatchetListBox;
+	BWidgets::PopupListBox toolRatchetCurveListBox;
+	BWidgets::PopupListBox toolConditionListBox;
 	BWidgets::Label toolButtonBoxCtrlLabel;
 	BWidgets::Label toolButtonBoxChLabel;
 	BWidgets::Label toolButtonBoxEditLabel;
@@ -217,8 +273,10 @@ private:
 	BWidgets::Label propertiesRootLabel;
 	BWidgets::PopupListBox propertiesRootListBox;
 	BWidgets::PopupListBox propertiesSignatureListBox;
-	BWidgets::Label propertiesOctaveLabel;
 	BWidgets::PopupListBox propertiesOctaveListBox;
+	BWidgets::Label propertiesGrooveLabel;
+	BWidgets::PopupListBox propertiesGrooveListBox;
+	BWidgets::HSliderValue propertiesSwingSlider;
 	BWidgets::Label propertiesScaleLabel;
 	BWidgets::ImageIcon propertiesScaleEditIcon;
 	BWidgets::PopupListBox propertiesScaleListBox;
@@ -228,6 +286,7 @@ private:
 		BWidgets::Widget box;
 		BWidgets::Label chLabel;
 		BWidgets::DrawingSurface chSymbol;
+		BWidgets::TextButton automationButton;
 		BWidgets::Label pitchLabel;
 		BWidgets::HSwitch pitchSwitch;
 		BWidgets::Widget pitchScreen;
@@ -244,6 +303,8 @@ private:
 	HaloButton helpButton;
 	HaloButton ytButton;
 	ScaleEditor* scaleEditor;
+	AutomationEditor* automationEditor;
+	BWidgets::FileChooser* fileChooser;
 
 	// Definition of styles
 	BColors::ColorSet fgColors = {{{0.0, 0.25, 0.75, 1.0}, {0.25, 0.75, 0.75, 1.0}, {0.0, 0.0, 0.1, 1.0}, {0.0, 0.0, 0.0, 0.0}}};
@@ -410,7 +471,51 @@ private:
 					 {"font", STYLEPTR (&lfLabelFont)}}},
 		{"menu/listbox//button",{{"border", STYLEPTR (&menuBorder)},
 					 {"background", STYLEPTR (&menuBg)},
-					 {"bgcolors", STYLEPTR (&bgColors)}}}
+					 {"bgcolors", STYLEPTR (&bgColors)}}},
+		{"filechooser",	 	{{"background", STYLEPTR (&boxBg)},
+					 {"border", STYLEPTR (&border)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/label", 	{{"uses", STYLEPTR (&labelStyles)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/textbox",	{{"background", STYLEPTR (&menuBg)},
+					 {"border", STYLEPTR (&menuBorder)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/listbox",	{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)}}},
+		{"filechooser/listbox/item/dir",
+					{{"uses", STYLEPTR (&defaultStyles)},
+					 {"border", STYLEPTR (&labelborder)},
+					 {"textcolors", STYLEPTR (&tgColors)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/listbox/item/file",
+					{{"uses", STYLEPTR (&defaultStyles)},
+					 {"border", STYLEPTR (&labelborder)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/listbox/button",
+					{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)},
+					 {"bgcolors", STYLEPTR (&bgColors)}}},
+		{"filechooser/popup",	{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)}}},
+		{"filechooser/popup/listbox",
+					{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)}}},
+		{"filechooser/popup/listbox/item",
+					{{"uses", STYLEPTR (&defaultStyles)},
+					 {"border", STYLEPTR (&labelborder)},
+					 {"textcolors", STYLEPTR (&BColors::whites)},
+					 {"font", STYLEPTR (&lfLabelFont)}}},
+		{"filechooser/popup/button",
+					{{"border", STYLEPTR (&menuBorder)},
+					 {"background", STYLEPTR (&menuBg)},
+					 {"bgcolors", STYLEPTR (&bgColors)}}},
+		{"filechooser/button",	{{"border", STYLEPTR (&menuBorder)},
+					 {"textcolors", STYLEPTR (&tgColors)},
+					 {"bgcolors", STYLEPTR (&tgBgColors)},
+					 {"font", STYLEPTR (&tgLabelFont)}}}
 	});
 };
 
@@ -19,6 +19,8 @@
 #define BEVENTS_HPP_
 
 #include <cstdint>
+#include <cstddef>
+#include <new>
 #include <string>
 #include "BDevices.hpp"
 #include "../BUtilities/Any.hpp"
@@ -57,6 +59,112 @@ enum EventType
 	NO_EVENT
 };
 
+#define BEVENTS_POOL_BLOCK_SIZE 16	// Granularity of pooled event sizes in bytes
+#define BEVENTS_POOL_NR_CLASSES 16	// Pooled event sizes up to 256 bytes
+#define BEVENTS_POOL_MAX_BLOCKS 64	// Max. free blocks kept per size class
+
+/**
+ * Class BEvents::EventPool
+ *
+ * Free lists of recycled event memory, one list per event size class. Events
+ * are created and deleted for each pointer motion, expose request or value
+ * change. Recycling their memory omits a malloc / free pair per event. The
+ * lists are thread local and limited to BEVENTS_POOL_MAX_BLOCKS free blocks
+ * per size class. The free blocks are released on thread exit.
+ */
+class EventPool
+{
+public:
+	static void* allocate (const size_t size)
+	{
+		const size_t sizeClass = getSizeClass (size);
+		if (sizeClass >= BEVENTS_POOL_NR_CLASSES) return ::operator new (size);
+
+		FreeLists& lists = getFreeLists ();
+		Block* block = lists.heads[sizeClass];
+		if (!block) return ::operator new ((sizeClass + 1) * BEVENTS_POOL_BLOCK_SIZE);
+
+		lists.heads[sizeClass] = block->next;
+		--lists.counts[sizeClass];
+		return block;
+	}
+
+	static void deallocate (void* ptr, const size_t size)
+	{
+		if (!ptr) return;
+
+		const size_t sizeClass = getSizeClass (size);
+		if (sizeClass < BEVENTS_POOL_NR_CLASSES)
+		{
+			FreeLists& lists = getFreeLists ();
+			if (lists.counts[sizeClass] < BEVENTS_POOL_MAX_BLOCKS)
+			{
+				Block* block = static_cast<Block*> (ptr);
+				block->next = lists.heads[sizeClass];
+				lists.heads[sizeClass] = block;
+				++lists.counts[sizeClass];
+				return;
+			}
+		}
+
+		::operator delete (ptr);
+	}
+
+	/**
+	 * Releases all free blocks of the calling thread.
+	 */
+	static void clear () {getFreeLists ().clear ();}
+
+private:
+	struct Block
+	{
+		Block* next;
+	};
+
+	struct FreeLists
+	{
+		Block* heads[BEVENTS_POOL_NR_CLASSES];
+		size_t counts[BEVENTS_POOL_NR_CLASSES];
+
+		~FreeLists ()
+		{
+			clear ();
+
+			// Events deleted later on (e.g., by static destructors) aren't
+			// pooled anymore
+			for (size_t i = 0; i < BEVENTS_POOL_NR_CLASSES; ++i) counts[i] = BEVENTS_POOL_MAX_BLOCKS;
+		}
+
+		void clear ()
+		{
+			for (size_t i = 0; i < BEVENTS_POOL_NR_CLASSES; ++i)
+			{
+				while (heads[i])
+				{
+					Block* block = heads[i];
+					heads[i] = block->next;
+					::operator delete (block);
+				}
+				counts[i] = 0;
+			}
+		}
+	};
+
+	static size_t getSizeClass (const size_t size)
+	{
+		return (size == 0 ? 0 : (size - 1) / BEVENTS_POOL_BLOCK_SIZE);
+	}
+
+	static FreeLists& getFreeLists ()
+	{
+		static thread_local FreeLists lists = {{nullptr}, {0}};
+		return lists;
+	}
+};
+/*
+ * End of class BEvents::EventPool
+ *****************************************************************************/
+
 /**
  * Class BEvents::Event
  *
@@ -78,6 +186,15 @@ public:
 
 	virtual ~Event () {}
 
+	/**
+	 * Allocation of events (and all derived events) from the EventPool.
+	 */
+	static void* operator new (size_t size)
+	{return EventPool::allocate (size);}
+
+	static void operator delete (void* ptr, size_t size)
+	{EventPool::deallocate (ptr, size);}
+
 	/**
 	 * Gets a pointer to the widget which caused the event.
 	 * @return Pointer to the widget
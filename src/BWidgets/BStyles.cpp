@@ -16,6 +16,8 @@
  */
 
 #include "BStyles.hpp"
+#include "ImageCache.hpp"
+#include <mutex>
 
 namespace BStyles
 {
@@ -71,10 +73,11 @@ Fill::Fill (const std::string& filename) : fillColor (BColors::invisible), fillS
 	loadFillFromFile (filename);
 }
 
+// Fill surfaces are never drawn into and thus shared between copies
 Fill::Fill (const Fill& that)
 {
 	fillColor = that.fillColor;
-	if (that.fillSurface) fillSurface = cairo_image_surface_clone_from_image_surface (that.fillSurface);
+	if (that.fillSurface) fillSurface = cairo_surface_reference (that.fillSurface);
 	else fillSurface = nullptr;
 }
 
@@ -83,7 +86,8 @@ Fill& Fill::operator= (const Fill& that)
 	if (this != &that)
 	{
 		fillColor = that.fillColor;
-		if (that.fillSurface) fillSurface = cairo_image_surface_clone_from_image_surface (that.fillSurface);
+		if (fillSurface) cairo_surface_destroy (fillSurface);
+		if (that.fillSurface) fillSurface = cairo_surface_reference (that.fillSurface);
 		else fillSurface = nullptr;
 	}
 
@@ -102,13 +106,13 @@ BColors::Color* Fill::getColor () {return &fillColor;}
 void Fill::loadFillFromFile (const std::string& filename)
 {
 	if (fillSurface) cairo_surface_destroy (fillSurface);
-	fillSurface = cairo_image_surface_create_from_png (filename.c_str());
+	fillSurface = BWidgets::ImageCache::load (filename);
 }
 
 void Fill::loadFillFromCairoSurface (cairo_surface_t* surface)
 {
 	if (fillSurface) cairo_surface_destroy (fillSurface);
-	fillSurface = cairo_image_surface_clone_from_image_surface (surface);
+	fillSurface = cairo_surface_reference (surface);
 }
 
 cairo_surface_t* Fill::getCairoSurface () {return fillSurface;}
@@ -168,16 +172,34 @@ cairo_text_extents_t Font::getTextExtents (cairo_t* cr, const std::string& text)
  *****************************************************************************/
 
 
+StyleId getStyleId (const std::string& styleName)
+{
+	static std::unordered_map<std::string, StyleId> styleIds;
+	static std::mutex styleIdsMutex;
+
+	std::lock_guard<std::mutex> lock (styleIdsMutex);
+	std::unordered_map<std::string, StyleId>::iterator it = styleIds.find (styleName);
+	if (it != styleIds.end ()) return it->second;
+
+	const StyleId id = styleIds.size ();
+	styleIds[styleName] = id;
+	return id;
+}
+
 /*****************************************************************************
  * Class BStyles::StyleSet
  *****************************************************************************/
 
-StyleSet::StyleSet () {}
-StyleSet::StyleSet (const std::string& name, const std::vector<Style>& styles) : stylesetName (name), styleVector (styles) {}
+StyleSet::StyleSet () : usedSet (nullptr) {}
+StyleSet::StyleSet (const std::string& name, const std::vector<Style>& styles) :
+		stylesetName (name), styleVector (styles), usedSet (nullptr)
+{
+	buildIndex ();
+}
 
 void StyleSet::addStyle (const std::string& styleName, void* ptr)
 {
-	for (Style style : styleVector)
+	for (Style& style : styleVector)
 	{
 		if (style.name == styleName)
 		{
@@ -185,6 +207,7 @@ void StyleSet::addStyle (const std::string& styleName, void* ptr)
 			std::cerr << "Msg from BStyles::StyleSet::addStyle(): Overwrite existing " << stylesetName << "/" << styleName
 					  << "." << std:: endl;
 			style.stylePtr = ptr;
+			buildIndex ();
 			return;
 		}
 	}
@@ -192,6 +215,7 @@ void StyleSet::addStyle (const std::string& styleName, void* ptr)
 	// No hit for styleName? Append style to existing styleset
 	Style newStyle = {styleName, ptr};
 	styleVector.push_back (newStyle);
+	buildIndex ();
 	return;
 }
 
@@ -203,6 +227,7 @@ void StyleSet::removeStyle (const std::string& styleName)
 		{
 			// Delete existing style
 			styleVector.erase (it);
+			buildIndex ();
 			return;
 		}
 	}
@@ -213,31 +238,35 @@ void StyleSet::removeStyle (const std::string& styleName)
 	return;
 }
 
-void* StyleSet::getStyle (const std::string& styleName)
+void* StyleSet::getStyle (const std::string& styleName) {return getStyle (getStyleId (styleName));}
+
+void* StyleSet::getStyle (const StyleId styleId)
 {
-	void* ptr = nullptr;
-	for (Style style : styleVector)
-	{
-		if (style.name == "uses")
-		{
-			StyleSet* usedSet = (StyleSet*) style.stylePtr;
-			ptr = usedSet->getStyle (styleName);
+	std::unordered_map<StyleId, void*>::const_iterator it = styleIndex.find (styleId);
+	if (it != styleIndex.end ()) return it->second;
 
-		}
-		if (style.name == styleName)
-		{
-			return ptr = style.stylePtr;
-		}
-	}
+	// No hit? Try the used StyleSet
+	if (usedSet) return usedSet->getStyle (styleId);
 
-	// No hit?
 	// if (!ptr) std::cerr << "Msg from BStyles::StyleSet::getStyle(): " << stylesetName << "/" << styleName << " doesn't exist." << std:: endl;
-	return ptr;
+	return nullptr;
 }
 
 void StyleSet::setName (const std::string& name) {stylesetName = name;}
 std::string StyleSet::getName () const {return stylesetName;}
 
+void StyleSet::buildIndex ()
+{
+	styleIndex.clear ();
+	usedSet = nullptr;
+	for (const Style& style : styleVector)
+	{
+		// First style of a name wins, the last "uses" StyleSet is used
+		styleIndex.emplace (getStyleId (style.name), style.stylePtr);
+		if (style.name == "uses") usedSet = (StyleSet*) style.stylePtr;
+	}
+}
+
 /*
  * End of class BWidgets::StyleSet
  *****************************************************************************/
@@ -247,33 +276,30 @@ std::string StyleSet::getName () const {return stylesetName;}
  *****************************************************************************/
 
 Theme::Theme () {};
-Theme::Theme (const std::vector<StyleSet>& theme): stylesetVector (theme) {};
+Theme::Theme (const std::vector<StyleSet>& theme): stylesetVector (theme) {buildIndex ();};
 
 void Theme::addStyle (const std::string& setName, const std::string& styleName, void* ptr)
 {
-	for (StyleSet styleSet : stylesetVector)
+	std::unordered_map<std::string, size_t>::const_iterator it = stylesetIndex.find (setName);
+	if (it != stylesetIndex.end ())
 	{
-		if (styleSet.getName () == setName)
-		{
-			styleSet.addStyle (styleName, ptr);
-			return;
-		}
+		stylesetVector[it->second].addStyle (styleName, ptr);
+		return;
 	}
 
 	// No hit for styleset? Append styleset to existing theme
 	StyleSet newSet = {setName, {{styleName, ptr}}};
 	stylesetVector.push_back (newSet);
+	buildIndex ();
 }
 
 void Theme::removeStyle (const std::string& setName, const std::string& styleName)
 {
-	for (StyleSet styleSet : stylesetVector)
+	std::unordered_map<std::string, size_t>::const_iterator it = stylesetIndex.find (setName);
+	if (it != stylesetIndex.end ())
 	{
-		if (styleSet.getName () == setName)
-		{
-			styleSet.removeStyle (styleName);
-			return;
-		}
+		stylesetVector[it->second].removeStyle (styleName);
+		return;
 	}
 
 	// No hit?
@@ -282,15 +308,12 @@ void Theme::removeStyle (const std::string& setName, const std::string& styleNam
 	return;
 }
 
-void* Theme::getStyle (const std::string& setName, const std::string& styleName)
+void* Theme::getStyle (const std::string& setName, const std::string& styleName) {return getStyle (setName, getStyleId (styleName));}
+
+void* Theme::getStyle (const std::string& setName, const StyleId styleId)
 {
-	for (StyleSet styleSet : stylesetVector)
-	{
-		if (styleSet.getName () == setName)
-		{
-			return styleSet.getStyle (styleName);
-		}
-	}
+	std::unordered_map<std::string, size_t>::const_iterator it = stylesetIndex.find (setName);
+	if (it != stylesetIndex.end ()) return stylesetVector[it->second].getStyle (styleId);
 
 	// No hit?
 	// std::cerr << "Msg from BStyles::Theme::getStyle(): " << setName << "/" << styleName
@@ -298,6 +321,13 @@ void* Theme::getStyle (const std::string& setName, const std::string& styleName)
 	return nullptr;
 }
 
+void Theme::buildIndex ()
+{
+	// First StyleSet of a name wins
+	stylesetIndex.clear ();
+	for (size_t i = 0; i < stylesetVector.size (); ++i) stylesetIndex.emplace (stylesetVector[i].getName (), i);
+}
+
 /*
  * End of class BWidgets::Theme
  *****************************************************************************/
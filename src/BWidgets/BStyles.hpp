@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <cstring>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <cairo/cairo.h>
 #include "cairoplus.h"
 #include <iostream>
@@ -195,13 +197,14 @@ public:
 
 	/**
 	 * Loads a PNG file into a Cairo image surface and uses it for the fill
-	 * style.
+	 * style. The image is taken from (and shared with) BWidgets::ImageCache.
 	 * @param filename File name of the PNG file
 	 */
 	void loadFillFromFile (const std::string& filename);
 
 	/**
-	 * Copies a Cairo image surface and uses it for the fill style.
+	 * Uses a Cairo image surface for the fill style. The surface is
+	 * shared (referenced), not copied. Don't draw into it afterwards.
 	 * @param surface Pointer to the source cairo image surface
 	 */
 	void loadFillFromCairoSurface (cairo_surface_t* surface);
@@ -382,6 +385,19 @@ typedef struct {
 	void* stylePtr;
 } Style;
 
+/**
+ * Unique integer ID of a style name (interned style name).
+ */
+typedef size_t StyleId;
+
+/**
+ * Gets the ID of a style name. A new ID is assigned on the first call for
+ * a style name.
+ * @param styleName Name of the style
+ * @return ID of the style name
+ */
+StyleId getStyleId (const std::string& styleName);
+
 /**
  * Class BStyles::StyleSet
  *
@@ -430,6 +446,31 @@ public:
 	 */
 	void* getStyle (const std::string& styleName);
 
+	/**
+	 * Gets a pointer to an existing style from the BStyles::StyleSet by the
+	 * ID of its name. O(1) lookup.
+	 * @param styleId ID of the style name.
+	 */
+	void* getStyle (const StyleId styleId);
+
+	/**
+	 * Typed access to an existing style.
+	 * @param styleName Name of the style.
+	 * @return Pointer to the style element of type T or nullptr if the
+	 * 	   style doesn't exist.
+	 */
+	template <class T> T* getStyle (const std::string& styleName)
+	{return static_cast<T*> (getStyle (styleName));}
+
+	/**
+	 * Typed access to an existing style by the ID of its name.
+	 * @param styleId ID of the style name.
+	 * @return Pointer to the style element of type T or nullptr if the
+	 * 	   style doesn't exist.
+	 */
+	template <class T> T* getStyle (const StyleId styleId)
+	{return static_cast<T*> (getStyle (styleId));}
+
 	/**
 	 * Sets the name of the BStyles::StyleSet
 	 * @param name Name of the BStyles::StyleSet.
@@ -443,8 +484,14 @@ public:
 	std::string getName () const;
 
 protected:
+	void buildIndex ();
+
 	std::string stylesetName;
 	std::vector<Style> styleVector;
+
+	// Styles by their name IDs and the StyleSet used by this StyleSet
+	std::unordered_map<StyleId, void*> styleIndex;
+	StyleSet* usedSet;
 };
 /*
  * End of class BWidgets::StyleSet
@@ -493,8 +540,38 @@ public:
 	 */
 	void* getStyle (const std::string& setName, const std::string& styleName);
 
+	/**
+	 * Gets an existing style by the ID of its name.
+	 * @param setName Name of the BStyles::StyleSet
+	 * @param styleId ID of the style name.
+	 */
+	void* getStyle (const std::string& setName, const StyleId styleId);
+
+	/**
+	 * Typed access to an existing style.
+	 * @param setName Name of the BStyles::StyleSet
+	 * @param styleName Name of the style.
+	 * @return Pointer to the style element of type T or nullptr if the
+	 * 	   style doesn't exist.
+	 */
+	template <class T> T* getStyle (const std::string& setName, const std::string& styleName)
+	{return static_cast<T*> (getStyle (setName, styleName));}
+
+	/**
+	 * Typed access to an existing style by the ID of its name.
+	 * @param setName Name of the BStyles::StyleSet
+	 * @param styleId ID of the style name.
+	 * @return Pointer to the style element of type T or nullptr if the
+	 * 	   style doesn't exist.
+	 */
+	template <class T> T* getStyle (const std::string& setName, const StyleId styleId)
+	{return static_cast<T*> (getStyle (setName, styleId));}
+
 protected:
+	void buildIndex ();
+
 	std::vector<StyleSet> stylesetVector;
+	std::unordered_map<std::string, size_t> stylesetIndex;	// Position in stylesetVector
 };
 /*
  * End of class BWidgets::Theme
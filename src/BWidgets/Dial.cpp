@@ -148,12 +148,12 @@ void Dial::applyTheme (BStyles::Theme& theme, const std::string& name)
 	focusLabel.applyTheme (theme, name + BWIDGETS_DEFAULT_FOCUS_NAME);
 
 	// Foreground colors (active part arc, dot)
-	void* fgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_FGCOLORS);
-	if (fgPtr) fgColors = *((BColors::ColorSet*) fgPtr);
+	BColors::ColorSet* fgPtr = theme.getStyle<BColors::ColorSet> (name, fgColorsStyleId);
+	if (fgPtr) fgColors = *fgPtr;
 
 	// Background colors (passive part arc)
-	void* bgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BGCOLORS);
-	if (bgPtr) bgColors = *((BColors::ColorSet*) bgPtr);
+	BColors::ColorSet* bgPtr = theme.getStyle<BColors::ColorSet> (name, bgColorsStyleId);
+	if (bgPtr) bgColors = *bgPtr;
 
 	if (fgPtr || bgPtr)
 	{
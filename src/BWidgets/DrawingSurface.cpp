@@ -53,6 +53,26 @@ Widget* DrawingSurface::clone () const {return new DrawingSurface (*this);}
 
 cairo_surface_t* DrawingSurface::getDrawingSurface () {return drawingSurface;}
 
+void DrawingSurface::update (const BUtilities::RectArea& area)
+{
+	if (scheduleDraw_ || (!isVisible ()) || (!main_))
+	{
+		update ();
+		return;
+	}
+
+	// Drawing surface to widget coordinates
+	BUtilities::RectArea a = area;
+	a.moveTo (area.getX () + getXOffset (), area.getY () + getYOffset ());
+	a.intersect (BUtilities::RectArea (0, 0, getWidth (), getHeight ()));
+	if (a == BUtilities::RectArea ()) return;
+
+	draw (a);
+
+	a.moveTo (a.getPosition () + getAbsolutePosition ());
+	postRedisplay (a);
+}
+
 void DrawingSurface::setWidth (const double width)
 {
 	double oldEffectiveWidth = getEffectiveWidth ();
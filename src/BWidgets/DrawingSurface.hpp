@@ -66,6 +66,17 @@ public:
 	 */
 	cairo_surface_t* getDrawingSurface ();
 
+	/**
+	 * Redraws only an area of the widget and emits a BEvents::ExposeEvent
+	 * for this area if the widget is visible. Use this method instead of
+	 * update () if only a small part of the drawing surface has been
+	 * changed. Falls back to update () if a full redraw is already
+	 * scheduled.
+	 * @param area Changed area in drawing surface coordinates
+	 */
+	using Widget::update;
+	void update (const BUtilities::RectArea& area);
+
 	/**
 	 * Resizes the widget and the drawing surface, redraw and emits a
 	 * BEvents::ExposeEvent if the widget is visible.
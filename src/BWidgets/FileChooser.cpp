@@ -474,8 +474,8 @@ void FileChooser::applyTheme (BStyles::Theme& theme, const std::string& name)
 	}
 
 	// Color
-	void* bgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BGCOLORS);
-	if (bgPtr) bgColors = *((BColors::ColorSet*) bgPtr);
+	BColors::ColorSet* bgPtr = theme.getStyle<BColors::ColorSet> (name, bgColorsStyleId);
+	if (bgPtr) bgColors = *bgPtr;
 
 	// TODO Store dir and file styles
 
@@ -64,12 +64,12 @@ void HScale::applyTheme (BStyles::Theme& theme, const std::string& name)
 	Widget::applyTheme (theme, name);
 
 	// Foreground colors (scale)
-	void* fgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_FGCOLORS);
-	if (fgPtr) fgColors = *((BColors::ColorSet*) fgPtr);
+	BColors::ColorSet* fgPtr = theme.getStyle<BColors::ColorSet> (name, fgColorsStyleId);
+	if (fgPtr) fgColors = *fgPtr;
 
 	// Background colors (scale background, knob)
-	void* bgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BGCOLORS);
-	if (bgPtr) bgColors = *((BColors::ColorSet*) bgPtr);
+	BColors::ColorSet* bgPtr = theme.getStyle<BColors::ColorSet> (name, bgColorsStyleId);
+	if (bgPtr) bgColors = *bgPtr;
 
 	if (fgPtr || bgPtr) update ();
 
@@ -29,11 +29,11 @@ Icon::Icon (const double x, const double y, const double width, const double hei
 
 Icon::Icon (const Icon& that) : Widget (that)
 {
-	// Copy icons
+	// Copy icons (shared, icon surfaces are never drawn into)
 	for (cairo_surface_t* s : that.iconSurface)
 	{
 		cairo_surface_t* n = nullptr;
-		if (s) n = cairo_image_surface_clone_from_image_surface (s);
+		if (s) n = cairo_surface_reference (s);
 		iconSurface.push_back (n);
 	}
 }
@@ -64,7 +64,7 @@ Icon& Icon::operator= (const Icon& that)
 	for (cairo_surface_t* s : that.iconSurface)
 	{
 		cairo_surface_t* n = nullptr;
-		if (s) n = cairo_image_surface_clone_from_image_surface (s);
+		if (s) n = cairo_surface_reference (s);
 		iconSurface.push_back (n);
 	}
 
@@ -0,0 +1,133 @@
+/* ImageCache.hpp
+ * Copyright (C) 2019  Sven Jähnichen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BWIDGETS_IMAGECACHE_HPP_
+#define BWIDGETS_IMAGECACHE_HPP_
+
+#include <cairo/cairo.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace BWidgets
+{
+
+/**
+ * Class BWidgets::ImageCache
+ *
+ * Process-wide cache of PNG images identified by their path and scale
+ * factor. Each image is decoded (and scaled) once and the Cairo surface is
+ * shared by all users (e.g., all open plugin GUIs). The surfaces are
+ * reference counted by Cairo: Each call of load returns a new reference
+ * which has to be released by cairo_surface_destroy. Images not used
+ * anymore are removed from the cache on the next load or purge. Shared
+ * surfaces must not be drawn into.
+ */
+class ImageCache
+{
+public:
+	/**
+	 * Gets an image.
+	 * @param path	Path of the PNG file
+	 * @param scale	Scale factor
+	 * @return	New reference to a Cairo image surface. Release it
+	 *		with cairo_surface_destroy.
+	 */
+	static cairo_surface_t* load (const std::string& path, const double scale = 1.0)
+	{
+		Images& images = getImages ();
+		std::lock_guard<std::mutex> lock (images.mutex);
+		purge (images);
+
+		const std::pair<std::string, double> key = std::make_pair (path, scale);
+		std::map<std::pair<std::string, double>, cairo_surface_t*>::iterator it = images.surfaces.find (key);
+		if (it != images.surfaces.end ()) return cairo_surface_reference (it->second);
+
+		cairo_surface_t* surface = cairo_image_surface_create_from_png (path.c_str ());
+		if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS) return surface;	// Don't cache errors
+
+		if (scale != 1.0)
+		{
+			cairo_surface_t* scaled = cairo_image_surface_create
+			(
+				CAIRO_FORMAT_ARGB32,
+				cairo_image_surface_get_width (surface) * scale,
+				cairo_image_surface_get_height (surface) * scale
+			);
+			cairo_t* cr = cairo_create (scaled);
+			cairo_scale (cr, scale, scale);
+			cairo_set_source_surface (cr, surface, 0, 0);
+			cairo_paint (cr);
+			cairo_destroy (cr);
+			cairo_surface_destroy (surface);
+			surface = scaled;
+			if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS) return surface;
+		}
+
+		// Hold one reference in the cache, return another one
+		images.surfaces[key] = surface;
+		return cairo_surface_reference (surface);
+	}
+
+	/**
+	 * Removes all images not used anymore from the cache.
+	 */
+	static void purge ()
+	{
+		Images& images = getImages ();
+		std::lock_guard<std::mutex> lock (images.mutex);
+		purge (images);
+	}
+
+protected:
+	struct Images
+	{
+		std::map<std::pair<std::string, double>, cairo_surface_t*> surfaces;
+		std::mutex mutex;
+
+		~Images ()
+		{
+			for (std::map<std::pair<std::string, double>, cairo_surface_t*>::value_type& s : surfaces) cairo_surface_destroy (s.second);
+		}
+	};
+
+	static Images& getImages ()
+	{
+		static Images images;
+		return images;
+	}
+
+	// Only the reference of the cache left? Remove. New references are
+	// only taken with the lock held, so the count can't rise meanwhile.
+	static void purge (Images& images)
+	{
+		for (std::map<std::pair<std::string, double>, cairo_surface_t*>::iterator it = images.surfaces.begin (); it != images.surfaces.end (); )
+		{
+			if (cairo_surface_get_reference_count (it->second) <= 1)
+			{
+				cairo_surface_destroy (it->second);
+				it = images.surfaces.erase (it);
+			}
+			else ++it;
+		}
+	}
+};
+
+}
+
+#endif /* BWIDGETS_IMAGECACHE_HPP_ */
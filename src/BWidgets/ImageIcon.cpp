@@ -16,6 +16,7 @@
  */
 
 #include "ImageIcon.hpp"
+#include "ImageCache.hpp"
 
 namespace BWidgets
 {
@@ -75,7 +76,7 @@ void ImageIcon::loadImage (BColors::State state, cairo_surface_t* surface)
 		iconSurface[state] = nullptr;
 	}
 
-	iconSurface[state] = cairo_image_surface_clone_from_image_surface (surface);
+	iconSurface[state] = cairo_surface_reference (surface);
 }
 
 void ImageIcon::loadImage (BColors::State state, const std::string& filename)
@@ -90,7 +91,7 @@ void ImageIcon::loadImage (BColors::State state, const std::string& filename)
 		iconSurface[state] = nullptr;
 	}
 
-	iconSurface[state] = cairo_image_surface_create_from_png (filename.c_str());
+	iconSurface[state] = ImageCache::load (filename);
 }
 
 }
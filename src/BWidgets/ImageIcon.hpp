@@ -44,7 +44,9 @@ public:
 	virtual Widget* clone () const override;
 
 	/**
-	 * Loads an image from a Cairo surface or an image file.
+	 * Loads an image from a Cairo surface or an image file. Surfaces are
+	 * shared (referenced), not copied. Image files are taken from
+	 * BWidgets::ImageCache.
 	 * @param surface	Cairo surface
 	 * @param filename	Filename
 	 */
@@ -59,10 +59,10 @@ void Knob::applyTheme (BStyles::Theme& theme, const std::string& name)
 {
 	Widget::applyTheme (theme, name);
 
-	void* bgPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BGCOLORS);
+	BColors::ColorSet* bgPtr = theme.getStyle<BColors::ColorSet> (name, bgColorsStyleId);
 	if (bgPtr)
 	{
-		bgColors = *((BColors::ColorSet*) bgPtr);
+		bgColors = *bgPtr;
 		update ();
 	}
 
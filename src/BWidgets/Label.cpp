@@ -107,7 +107,7 @@ double Label::getTextWidth (std::string& text)
 {
 	double textwidth = 0.0;
 	cairo_t* cr = cairo_create (widgetSurface_);
-	cairo_text_extents_t ext = labelFont.getTextExtents(cr, text.c_str ());
+	cairo_text_extents_t ext = getTextExtents (cr, labelFont, text);
 	textwidth = ext.width;
 	cairo_destroy (cr);
 	return textwidth;
@@ -117,7 +117,7 @@ void Label::resize ()
 {
 	// Get label text size
 	cairo_t* cr = cairo_create (widgetSurface_);
-	cairo_text_extents_t ext = labelFont.getTextExtents(cr, labelText.c_str ());
+	cairo_text_extents_t ext = getTextExtents (cr, labelFont, labelText);
 	double w = ext.width;
 	double h = (ext.height > labelFont.getFontSize() ? ext.height : labelFont.getFontSize());
 	BUtilities::Point contExt = BUtilities::Point (w + 2 * getXOffset () + 2, h + 2 * getYOffset () + 2);
@@ -143,12 +143,12 @@ void Label::applyTheme (BStyles::Theme& theme, const std::string& name)
 	Widget::applyTheme (theme, name);
 
 	// Color
-	void* colorsPtr = theme.getStyle(name, BWIDGETS_KEYWORD_TEXTCOLORS);
-	if (colorsPtr) labelColors = *((BColors::ColorSet*) colorsPtr);
+	BColors::ColorSet* colorsPtr = theme.getStyle<BColors::ColorSet> (name, textColorsStyleId);
+	if (colorsPtr) labelColors = *colorsPtr;
 
 	// Font
-	void* fontPtr = theme.getStyle(name, BWIDGETS_KEYWORD_FONT);
-	if (fontPtr) labelFont = *((BStyles::Font*) fontPtr);
+	BStyles::Font* fontPtr = theme.getStyle<BStyles::Font> (name, fontStyleId);
+	if (fontPtr) labelFont = *fontPtr;
 
 	if (colorsPtr || fontPtr) update ();
 }
@@ -406,8 +406,8 @@ void Label::draw (const BUtilities::RectArea& area)
 		double w = getEffectiveWidth ();
 		double h = getEffectiveHeight ();
 
-		cairo_text_extents_t ext = labelFont.getTextExtents(cr, "|" + labelText + "|");
-		cairo_text_extents_t ext0 = labelFont.getTextExtents(cr, "|");
+		cairo_text_extents_t ext = getTextExtents (cr, labelFont, "|" + labelText + "|");
+		cairo_text_extents_t ext0 = getTextExtents (cr, labelFont, "|");
 		cairo_select_font_face (cr, labelFont.getFontFamily ().c_str (), labelFont.getFontSlant (), labelFont.getFontWeight ());
 		cairo_set_font_size (cr, labelFont.getFontSize ());
 
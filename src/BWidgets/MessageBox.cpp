@@ -149,7 +149,7 @@ void MessageBox::addButton (const std::string& label)
 	if (b)
 	{
 		cairo_t* cr = cairo_create (widgetSurface_);
-		cairo_text_extents_t ext = b->getLabel()->getFont()->getTextExtents (cr, label);
+		cairo_text_extents_t ext = getTextExtents (cr, *b->getLabel()->getFont(), label);
 		cairo_destroy (cr);
 		b->setWidth (ext.width > BWIDGETS_DEFAULT_BUTTON_WIDTH - BWIDGETS_DEFAULT_MENU_PADDING ?
 				ext.width + BWIDGETS_DEFAULT_MENU_PADDING :
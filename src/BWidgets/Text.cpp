@@ -110,12 +110,12 @@ void Text::applyTheme (BStyles::Theme& theme, const std::string& name)
 	Widget::applyTheme (theme, name);
 
 	// Color
-	void* colorsPtr = theme.getStyle(name, BWIDGETS_KEYWORD_TEXTCOLORS);
-	if (colorsPtr) textColors = *((BColors::ColorSet*) colorsPtr);
+	BColors::ColorSet* colorsPtr = theme.getStyle<BColors::ColorSet> (name, textColorsStyleId);
+	if (colorsPtr) textColors = *colorsPtr;
 
 	// Font
-	void* fontPtr = theme.getStyle(name, BWIDGETS_KEYWORD_FONT);
-	if (fontPtr) setFont (*((BStyles::Font*) fontPtr));
+	BStyles::Font* fontPtr = theme.getStyle<BStyles::Font> (name, fontStyleId);
+	if (fontPtr) setFont (*fontPtr);
 
 	else if (colorsPtr) update ();
 }
@@ -126,28 +126,14 @@ std::vector<std::string> Text::getTextBlock ()
 	double w = getEffectiveWidth ();
 	double h = getEffectiveHeight ();
 	cairo_t* cr = cairo_create (widgetSurface_);
-	cairo_text_decorations decorations;
-	strncpy (decorations.family, textFont.getFontFamily ().c_str (), 63);
-	decorations.size = textFont.getFontSize ();
-	decorations.slant = textFont.getFontSlant ();
-	decorations.weight = textFont.getFontWeight ();
-
-	char* textCString = (char*) malloc (strlen (textString.c_str ()) + 1);
-	if (textCString)
-	{
-		strcpy (textCString, textString.c_str ());
+	std::vector<TextLayoutLine> lines = getTextLayout (cr, textFont, textString, w);
 
-		for (double y = 0; (yResizable || (y <= h)) && (strlen (textCString) > 0); )
-		{
-			char* outputtext = cairo_create_text_fitted (cr, w, decorations, textCString);
-			if (outputtext[0] == '\0') break;
-			cairo_text_extents_t ext = textFont.getTextExtents(cr, outputtext);
-			textblock.push_back (std::string (outputtext));
-			y += (ext.height * textFont.getLineSpacing ());
-			cairo_text_destroy (outputtext);
-		}
-
-		free (textCString);
+	double y = 0;
+	for (const TextLayoutLine& line : lines)
+	{
+		if ((!yResizable) && (y > h)) break;
+		textblock.push_back (line.text);
+		y += (line.extents.height * textFont.getLineSpacing ());
 	}
 
 	cairo_destroy (cr);
@@ -216,7 +202,7 @@ void Text::draw (const BUtilities::RectArea& area)
 
 		for (std::string textline : textblock)
 		{
-			cairo_text_extents_t ext = textFont.getTextExtents (cr, textline);
+			cairo_text_extents_t ext = getTextExtents (cr, textFont, textline);
 
 			double x0;
 			switch (textFont.getTextAlign ())
@@ -0,0 +1,183 @@
+/* TextLayoutCache.hpp
+ * Copyright (C) 2019  Sven Jähnichen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BWIDGETS_TEXTLAYOUTCACHE_HPP_
+#define BWIDGETS_TEXTLAYOUTCACHE_HPP_
+
+#define BWIDGETS_TEXTLAYOUTCACHE_MAX_SIZE 1024
+
+#include <cairo/cairo.h>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cairoplus.h"
+#include "BStyles.hpp"
+
+namespace BWidgets
+{
+
+/**
+ * Line of a text layout with its output dimensions.
+ */
+typedef struct {
+	std::string text;
+	cairo_text_extents_t extents;
+} TextLayoutLine;
+
+/**
+ * Class BWidgets::TextLayoutCache
+ *
+ * Cache of text extents and of texts fitted (broken into lines) to a given
+ * width. Entries are identified by font, text and width. Thus widgets
+ * showing static texts only measure their texts once. The cache is cleared
+ * if it exceeds BWIDGETS_TEXTLAYOUTCACHE_MAX_SIZE entries and should be
+ * cleared on changes which affect the text rendering (e.g., theme or scale).
+ */
+class TextLayoutCache
+{
+public:
+	TextLayoutCache () : layouts_ (), invalid_ () {}
+
+	/**
+	 * Gets the output dimensions of a text.
+	 * @param cr	Cairo context used to measure the text (if not cached)
+	 * @param font	Font
+	 * @param text	Text
+	 * @return	Output dimensions as Cairo text extents
+	 */
+	cairo_text_extents_t getTextExtents (cairo_t* cr, const BStyles::Font& font, const std::string& text)
+	{
+		const std::vector<TextLayoutLine>& lines = getLayout (cr, font, text, -1.0);
+		return (lines.empty () ? cairo_text_extents_t {0.0, 0.0, 0.0, 0.0, 0.0, 0.0} : lines.front ().extents);
+	}
+
+	/**
+	 * Gets a text fitted to a width.
+	 * @param cr	Cairo context used to fit the text (if not cached)
+	 * @param font	Font
+	 * @param text	Text
+	 * @param width	Maximum width of the lines
+	 * @return	Text lines with their output dimensions
+	 */
+	std::vector<TextLayoutLine> getTextBlock (cairo_t* cr, const BStyles::Font& font, const std::string& text, const double width)
+	{
+		return getLayout (cr, font, text, width);
+	}
+
+	void clear () {layouts_.clear ();}
+
+	size_t size () const {return layouts_.size ();}
+
+	/**
+	 * Measures a text (width < 0) or fits a text to a width without
+	 * caching.
+	 */
+	static std::vector<TextLayoutLine> layout (cairo_t* cr, const BStyles::Font& font, const std::string& text, const double width)
+	{
+		std::vector<TextLayoutLine> lines;
+
+		if (width < 0.0)
+		{
+			lines.push_back ({text, font.getTextExtents (cr, text)});
+			return lines;
+		}
+
+		cairo_text_decorations decorations;
+		strncpy (decorations.family, font.getFontFamily ().c_str (), 63);
+		decorations.family[63] = '\0';
+		decorations.size = font.getFontSize ();
+		decorations.slant = font.getFontSlant ();
+		decorations.weight = font.getFontWeight ();
+
+		char* textCString = (char*) malloc (text.size () + 1);
+		if (!textCString) return lines;
+		strcpy (textCString, text.c_str ());
+
+		while (strlen (textCString) > 0)
+		{
+			char* outputtext = cairo_create_text_fitted (cr, width, decorations, textCString);
+			if (!outputtext) break;
+			if (outputtext[0] == '\0')
+			{
+				cairo_text_destroy (outputtext);
+				break;
+			}
+
+			lines.push_back ({std::string (outputtext), font.getTextExtents (cr, outputtext)});
+			cairo_text_destroy (outputtext);
+		}
+
+		free (textCString);
+		return lines;
+	}
+
+protected:
+	struct TextLayoutKey
+	{
+		std::string family;
+		cairo_font_slant_t slant;
+		cairo_font_weight_t weight;
+		double size;
+		double width;
+		std::string text;
+
+		bool operator== (const TextLayoutKey& that) const
+		{
+			return	(slant == that.slant) && (weight == that.weight) && (size == that.size) &&
+				(width == that.width) && (family == that.family) && (text == that.text);
+		}
+	};
+
+	struct TextLayoutHash
+	{
+		size_t operator() (const TextLayoutKey& key) const
+		{
+			return	std::hash<std::string> () (key.text) ^ (std::hash<std::string> () (key.family) << 1) ^
+				(std::hash<double> () (key.size) << 2) ^ (std::hash<double> () (key.width) << 3) ^
+				(std::hash<int> () (key.slant) << 4) ^ (std::hash<int> () (key.weight) << 5);
+		}
+	};
+
+	const std::vector<TextLayoutLine>& getLayout (cairo_t* cr, const BStyles::Font& font, const std::string& text, const double width)
+	{
+		TextLayoutKey key = {font.getFontFamily (), font.getFontSlant (), font.getFontWeight (), font.getFontSize (), width, text};
+		std::unordered_map<TextLayoutKey, std::vector<TextLayoutLine>, TextLayoutHash>::const_iterator it = layouts_.find (key);
+		if (it != layouts_.end ()) return it->second;
+
+		// Don't cache results of invalid contexts
+		if ((!cr) || cairo_status (cr))
+		{
+			invalid_ = layout (cr, font, text, width);
+			return invalid_;
+		}
+
+		if (layouts_.size () >= BWIDGETS_TEXTLAYOUTCACHE_MAX_SIZE) clear ();
+		std::vector<TextLayoutLine>& lines = layouts_[key];
+		lines = layout (cr, font, text, width);
+		return lines;
+	}
+
+	std::unordered_map<TextLayoutKey, std::vector<TextLayoutLine>, TextLayoutHash> layouts_;
+	std::vector<TextLayoutLine> invalid_;
+};
+
+}
+
+#endif /* BWIDGETS_TEXTLAYOUTCACHE_HPP_ */
@@ -23,6 +23,13 @@
 namespace BWidgets
 {
 
+const BStyles::StyleId Widget::borderStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_BORDER);
+const BStyles::StyleId Widget::backgroundStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_BACKGROUND);
+const BStyles::StyleId Widget::fontStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_FONT);
+const BStyles::StyleId Widget::fgColorsStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_FGCOLORS);
+const BStyles::StyleId Widget::bgColorsStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_BGCOLORS);
+const BStyles::StyleId Widget::textColorsStyleId = BStyles::getStyleId (BWIDGETS_KEYWORD_TEXTCOLORS);
+
 Widget::Widget () : Widget (0.0, 0.0, BWIDGETS_DEFAULT_WIDTH, BWIDGETS_DEFAULT_HEIGHT, "widget") {}
 
 Widget::Widget (const double x, const double y, const double width, const double height) : Widget (x, y, width, height, "widget") {}
@@ -88,6 +95,7 @@ Widget& Widget::operator= (const Widget& that)
 	name_ = that.name_;
 	cbfunction_ = that.cbfunction_;
 	widgetState_ = that.widgetState_;
+	if (main_) main_->invalidateWidgetIndex ();
 
 	if (widgetSurface_) cairo_surface_destroy (widgetSurface_);
 	widgetSurface_ = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, that.area_.getWidth (), that.area_.getHeight ());
@@ -147,6 +155,7 @@ void Widget::add (Widget& child)
 	child.parent_ = this;
 
 	children_.push_back (&child);
+	if (main_) main_->invalidateWidgetIndex ();
 
 	// Link all children of child to main_ and update children of child as
 	// they may become visible too
@@ -199,6 +208,7 @@ void Widget::release (Widget* child)
 
 			// Delete from children_ vector
 			children_.erase (it);
+			if (main_) main_->invalidateWidgetIndex ();
 
 			// Restore visibility information
 			if (wasVisible) postRedisplay (child->getArea());
@@ -219,6 +229,7 @@ void Widget::moveTo (const BUtilities::Point& position)
 	if ((area_.getX () != position.x) || (area_.getY () != position.y))
 	{
 		area_.moveTo (position);
+		if (main_) main_->invalidateWidgetIndex ();
 		if (stacking_ == STACKING_CATCH) stackingCatch();
 		if (isVisible () && parent_) parent_->postRedisplay ();
 	}
@@ -246,6 +257,7 @@ void Widget::raiseFrontwards ()
 				Widget* w = parent_->children_[i + 1];
 				parent_->children_[i + 1] = parent_->children_[i];
 				parent_->children_[i] = w;
+				if (main_) main_->invalidateWidgetIndex ();
 
 				if (parent_->isVisible ()) parent_->postRedisplay ();
 				return;
@@ -267,6 +279,7 @@ void Widget::pushBackwards ()
 				Widget* w = parent_->children_[i];
 				parent_->children_[i] = parent_->children_[i - 1];
 				parent_->children_[i - 1] = w;
+				if (main_) main_->invalidateWidgetIndex ();
 
 				if (parent_->isVisible ()) parent_->postRedisplay ();
 				return;
@@ -291,6 +304,7 @@ void Widget::pushToBottom ()
 			}
 		}
 		parent_->children_.insert (parent_->children_.begin(), this);
+		if (main_) main_->invalidateWidgetIndex ();
 
 		if (parent_->isVisible ()) parent_->postRedisplay ();
 	}
@@ -310,6 +324,7 @@ void Widget::raiseToTop ()
 			}
 		}
 		parent_->children_.push_back (this);
+		if (main_) main_->invalidateWidgetIndex ();
 
 		if (parent_->isVisible ()) parent_->postRedisplay ();
 	}
@@ -320,6 +335,7 @@ void Widget::setWidth (const double width)
 	if (getWidth () != width)
 	{
 		area_.resize (width, getHeight ());
+		if (main_) main_->invalidateWidgetIndex ();
 		cairo_surface_destroy (widgetSurface_);	// destroy old surface first
 		widgetSurface_ = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, getWidth (), getHeight ());
 		update ();
@@ -339,6 +355,7 @@ void Widget::setHeight (const double height)
 	if (getHeight () != height)
 	{
 		area_.resize (getWidth (), height);
+		if (main_) main_->invalidateWidgetIndex ();
 		cairo_surface_destroy (widgetSurface_);	// destroy old surface first
 		widgetSurface_ = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, getWidth (), getHeight ());
 		update ();
@@ -373,6 +390,7 @@ void Widget::resize (const BUtilities::Point extends)
 	if (area_.getExtends () != extends)
 	{
 		area_.resize (extends.x, extends.y);
+		if (main_) main_->invalidateWidgetIndex ();
 		cairo_surface_destroy (widgetSurface_);	// destroy old surface first
 		widgetSurface_ = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, getWidth (), getHeight ());
 		update ();
@@ -392,6 +410,7 @@ void Widget::setState (const BColors::State state)
 	if (state != widgetState_)
 	{
 		widgetState_ = state;
+		if (main_) main_->invalidateWidgetIndex ();	// State may be used in filter ()
 		update ();
 	}
 }
@@ -478,7 +497,11 @@ void Widget::setMergeable (const BEvents::EventType eventType, const bool status
 
 bool Widget::isMergeable (const BEvents::EventType eventType) const {return mergeable_[eventType];}
 
-void Widget::setStacking (const WidgetStacking stacking) {stacking_ = stacking;}
+void Widget::setStacking (const WidgetStacking stacking)
+{
+	stacking_ = stacking;
+	if (main_) main_->invalidateWidgetIndex ();
+}
 
 WidgetStacking Widget::getStacking () const {return stacking_;};
 
@@ -565,17 +588,35 @@ Widget* Widget::getWidgetAt (const BUtilities::Point& abspos, const BUtilities::
 	else return nullptr;
 }
 
+void Widget::indexWidgets (std::vector<std::pair<Widget*, BUtilities::RectArea>>& index,
+			   const BUtilities::RectArea& outerArea, const BUtilities::RectArea& area)
+{
+	// Same clipping as getWidgetAt
+	BUtilities::RectArea a = (getStacking() == STACKING_OVERSIZE? outerArea : area);
+	BUtilities::RectArea thisArea = area_;
+	thisArea.moveTo (getAbsolutePosition());
+	thisArea.intersect (a);
+	if (!main_) return;
+
+	if (thisArea != BUtilities::RectArea ()) index.push_back (std::make_pair (this, thisArea));
+
+	for (Widget* w : children_)
+	{
+		if (w && filter (w)) w->indexWidgets (index, outerArea, thisArea);
+	}
+}
+
 void Widget::applyTheme (BStyles::Theme& theme) {applyTheme (theme, name_);}
 
 void Widget::applyTheme (BStyles::Theme& theme, const std::string& name)
 {
 	// Border
-	void* borderPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BORDER);
-	if (borderPtr) setBorder (*((BStyles::Border*) borderPtr));
+	BStyles::Border* borderPtr = theme.getStyle<BStyles::Border> (name, borderStyleId);
+	if (borderPtr) setBorder (*borderPtr);
 
 	// Background
-	void* backgroundPtr = theme.getStyle(name, BWIDGETS_KEYWORD_BACKGROUND);
-	if (backgroundPtr) setBackground (*((BStyles::Fill*) backgroundPtr));
+	BStyles::Fill* backgroundPtr = theme.getStyle<BStyles::Fill> (name, backgroundStyleId);
+	if (backgroundPtr) setBackground (*backgroundPtr);
 
 	if (borderPtr || backgroundPtr)
 	{
@@ -717,7 +758,17 @@ void Widget::redisplay (cairo_surface_t* surface, const BUtilities::RectArea& ou
 
 		for (Widget* w : children_)
 		{
-			if (w && filter (w)) w->redisplay (surface, outerArea, a);
+			if ((!w) || (!filter (w))) continue;
+
+			// Cull leaf widgets outside the area
+			if (w->children_.empty () && (w->getStacking () != STACKING_OVERSIZE))
+			{
+				BUtilities::RectArea wa = w->area_;
+				wa.moveTo (w->getAbsolutePosition ());
+				if (!wa.overlaps (a)) continue;
+			}
+
+			w->redisplay (surface, outerArea, a);
 		}
 	}
 }
@@ -737,17 +788,29 @@ void Widget::stackingCatch ()
 		if (a != area_)
 		{
 			area_ = a;
+			if (main_) main_->invalidateWidgetIndex ();
 			if (isVisible()) parent_->postRedisplay ();
 		}
 	}
 }
 
+cairo_text_extents_t Widget::getTextExtents (cairo_t* cr, const BStyles::Font& font, const std::string& text)
+{
+	if (main_) return main_->getTextLayoutCache ()->getTextExtents (cr, font, text);
+	return font.getTextExtents (cr, text);
+}
+
+std::vector<TextLayoutLine> Widget::getTextLayout (cairo_t* cr, const BStyles::Font& font, const std::string& text, const double width)
+{
+	if (main_) return main_->getTextLayoutCache ()->getTextBlock (cr, font, text, width);
+	return TextLayoutCache::layout (cr, font, text, width);
+}
+
 bool Widget::filter (Widget* widget) {return true;}
 
 void Widget::draw (const BUtilities::RectArea& area)
 {
 	if ((!widgetSurface_) || (cairo_surface_status (widgetSurface_) != CAIRO_STATUS_SUCCESS)) return;
-	cairo_surface_clear (widgetSurface_);
 	cairo_t* cr = cairo_create (widgetSurface_);
 
 	if (cairo_status (cr) == CAIRO_STATUS_SUCCESS)
@@ -758,6 +821,12 @@ void Widget::draw (const BUtilities::RectArea& area)
 		cairo_rectangle (cr, area.getX (), area.getY (), area.getWidth (), area.getHeight ());
 		cairo_clip (cr);
 
+		// Clear the drawing area only
+		cairo_save (cr);
+		cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (cr);
+		cairo_restore (cr);
+
 		double radius = border_.getRadius ();
 
 		// Draw background
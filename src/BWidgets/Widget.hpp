@@ -59,6 +59,7 @@
 #include <stdint.h>
 #include <array>
 #include <vector>
+#include <utility>
 #include <string>
 #include <iostream>
 #include <functional>
@@ -68,6 +69,7 @@
 #include "BColors.hpp"
 #include "BStyles.hpp"
 #include "BEvents.hpp"
+#include "TextLayoutCache.hpp"
 
 namespace BWidgets
 {
@@ -667,8 +669,28 @@ protected:
 
 	Widget* getWidgetAt (const BUtilities::Point& position, std::function<bool (Widget* widget)> func = [] (Widget* widget) {return true;});
 
+	/*
+	 * Appends this widget and all its (unfiltered) children in stacking
+	 * order to a hit test index. Each entry contains the absolute area of
+	 * the widget clipped like in getWidgetAt.
+	 */
+	void indexWidgets (std::vector<std::pair<Widget*, BUtilities::RectArea>>& index,
+			   const BUtilities::RectArea& outerArea, const BUtilities::RectArea& area);
+
 	void stackingCatch ();
 
+	/*
+	 * Gets the output dimensions of a text. Uses the text layout cache of
+	 * the main window, if available.
+	 */
+	cairo_text_extents_t getTextExtents (cairo_t* cr, const BStyles::Font& font, const std::string& text);
+
+	/*
+	 * Fits a text to a width (see cairo_create_text_fitted). Uses the text
+	 * layout cache of the main window, if available.
+	 */
+	std::vector<TextLayoutLine> getTextLayout (cairo_t* cr, const BStyles::Font& font, const std::string& text, const double width);
+
 	void postMessage (const std::string& name, const BUtilities::Any content);
 
 	void postRedisplay (const BUtilities::RectArea& area);
@@ -698,6 +720,14 @@ protected:
 	cairo_surface_t* widgetSurface_;
 	BColors::State widgetState_;
 
+	// Interned theme keywords
+	static const BStyles::StyleId borderStyleId;
+	static const BStyles::StyleId backgroundStyleId;
+	static const BStyles::StyleId fontStyleId;
+	static const BStyles::StyleId fgColorsStyleId;
+	static const BStyles::StyleId bgColorsStyleId;
+	static const BStyles::StyleId textColorsStyleId;
+
 private:
 	void redisplay (cairo_surface_t* surface, const BUtilities::RectArea& outerArea, const BUtilities::RectArea& area);
 	Widget* getWidgetAt (const BUtilities::Point& abspos, const BUtilities::RectArea& outerArea,
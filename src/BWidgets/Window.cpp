@@ -22,6 +22,8 @@
 
 #include "Window.hpp"
 #include "Focusable.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace BWidgets
 {
@@ -34,7 +36,9 @@ Window::Window (const double width, const double height, const std::string& titl
 		keyGrabStack_ (), buttonGrabStack_ (),
 		title_ (title), world_ (NULL), view_ (NULL), nativeWindow_ (nativeWindow),
 		quit_ (false), focused_ (false), pointer_ (),
-		eventQueue_ ()
+		eventQueue_ (), pendingEvents_ (), textLayoutCache_ (), widgetIndex_ (), widgetGrid_ (),
+		widgetGridColumns_ (0), widgetGridRows_ (0), widgetIndexValid_ (false),
+		damage_ (), damagePosted_ (true), storageSurface_ (nullptr)
 {
 	main_ = this;
 
@@ -71,6 +75,7 @@ Window::~Window ()
 	buttonGrabStack_.clear ();
 	puglFreeView (view_);
 	puglFreeWorld (world_);
+	if (storageSurface_) cairo_surface_destroy (storageSurface_);
 	main_ = nullptr;	// Important switch for the super destructor. It took
 				// days of debugging ...
 
@@ -110,136 +115,265 @@ void Window::onExposeRequest (BEvents::ExposeEvent* event)
 	if (event)
 	{
 		BEvents::ExposeEvent* ee = (BEvents::ExposeEvent*)event;
-		puglPostRedisplayRect (view_, {ee->getArea().getX(), ee->getArea().getY(), ee->getArea().getWidth(), ee->getArea().getHeight()});
+		addDamage (ee->getArea());
 	}
 }
 
-void Window::addEventToQueue (BEvents::Event* event)
+void Window::invalidateWidgetIndex () {widgetIndexValid_ = false;}
+
+TextLayoutCache* Window::getTextLayoutCache () {return &textLayoutCache_;}
+
+void Window::buildWidgetIndex ()
 {
-	// Try to merge with precursor event
-	if
-	(
-		(event) &&
-		(event->getWidget()) &&
-		(!eventQueue_.empty ()) &&
-		(eventQueue_.back())
-	)
+	widgetIndex_.clear ();
+	BUtilities::RectArea absarea = getAbsoluteArea ();
+	indexWidgets (widgetIndex_, absarea, absarea);
+
+	// Sort widgets into grid cells
+	widgetGridColumns_ = int (ceil (getWidth () / BWIDGETS_WIDGET_INDEX_CELL_SIZE));
+	widgetGridRows_ = int (ceil (getHeight () / BWIDGETS_WIDGET_INDEX_CELL_SIZE));
+	if (widgetGridColumns_ < 1) widgetGridColumns_ = 1;
+	if (widgetGridRows_ < 1) widgetGridRows_ = 1;
+	widgetGrid_.resize (widgetGridColumns_ * widgetGridRows_);
+	for (std::vector<size_t>& c : widgetGrid_) c.clear ();
+
+	const BUtilities::Point origin = getAbsolutePosition ();
+	for (size_t i = 0; i < widgetIndex_.size (); ++i)
 	{
-		BEvents::EventType eventType = event->getEventType();
+		const BUtilities::RectArea& a = widgetIndex_[i].second;
+		const int x1 = std::max (0, std::min (int ((a.getX () - origin.x) / BWIDGETS_WIDGET_INDEX_CELL_SIZE), widgetGridColumns_ - 1));
+		const int x2 = std::max (0, std::min (int ((a.getX () + a.getWidth () - origin.x) / BWIDGETS_WIDGET_INDEX_CELL_SIZE), widgetGridColumns_ - 1));
+		const int y1 = std::max (0, std::min (int ((a.getY () - origin.y) / BWIDGETS_WIDGET_INDEX_CELL_SIZE), widgetGridRows_ - 1));
+		const int y2 = std::max (0, std::min (int ((a.getY () + a.getHeight () - origin.y) / BWIDGETS_WIDGET_INDEX_CELL_SIZE), widgetGridRows_ - 1));
+		for (int y = y1; y <= y2; ++y)
+		{
+			for (int x = x1; x <= x2; ++x) widgetGrid_[y * widgetGridColumns_ + x].push_back (i);
+		}
+	}
 
-		if
-		(
-			(event->getWidget ()->isMergeable(eventType)) &&
-			(
-				(eventType == BEvents::CONFIGURE_REQUEST_EVENT) ||
-				(eventType == BEvents::EXPOSE_REQUEST_EVENT) ||
-				(eventType == BEvents::POINTER_MOTION_EVENT) ||
-				(eventType == BEvents::POINTER_DRAG_EVENT) ||
-				(eventType == BEvents::WHEEL_SCROLL_EVENT) ||
-				(eventType == BEvents::VALUE_CHANGED_EVENT)
-			)
-		)
+	widgetIndexValid_ = true;
+}
+
+Widget* Window::getWidgetAt (const BUtilities::Point& position, std::function<bool (Widget* widget)> func)
+{
+	if (!widgetIndexValid_) buildWidgetIndex ();
+
+	const BUtilities::Point origin = getAbsolutePosition ();
+	const BUtilities::Point abspos = origin + position;
+	const int x = int (floor (position.x / BWIDGETS_WIDGET_INDEX_CELL_SIZE));
+	const int y = int (floor (position.y / BWIDGETS_WIDGET_INDEX_CELL_SIZE));
+	if ((x < 0) || (x >= widgetGridColumns_) || (y < 0) || (y >= widgetGridRows_)) return nullptr;
+
+	// Top most matching widget
+	const std::vector<size_t>& cell = widgetGrid_[y * widgetGridColumns_ + x];
+	for (std::vector<size_t>::const_reverse_iterator it = cell.rbegin (); it != cell.rend (); ++it)
+	{
+		const std::pair<Widget*, BUtilities::RectArea>& entry = widgetIndex_[*it];
+		if (entry.second.contains (abspos) && func (entry.first)) return entry.first;
+	}
+
+	return nullptr;
+}
+
+void Window::addDamage (const BUtilities::RectArea& area)
+{
+	BUtilities::RectArea a = area;
+	a.intersect (BUtilities::RectArea (0, 0, getWidth (), getHeight ()));
+	if (a == BUtilities::RectArea ()) return;
+
+	// Coalesce with overlapping damage regions
+	for (std::vector<BUtilities::RectArea>::iterator it = damage_.begin (); it != damage_.end (); )
+	{
+		if (it->overlaps (a))
 		{
-			// Check for mergeable precursor events
-			for (std::deque<BEvents::Event*>::reverse_iterator rit = eventQueue_.rbegin(); rit != eventQueue_.rend(); ++rit)
-			{
-				BEvents::Event* precursor = *rit;
+			a.extend (*it);
+			damage_.erase (it);
+			it = damage_.begin ();
+		}
+		else ++it;
+	}
 
-				if ((precursor->getEventType() == eventType) && (event->getWidget () == precursor->getWidget ()))
-				{
-					// CONFIGURE_EVENT
-					if (eventType == BEvents::CONFIGURE_REQUEST_EVENT)
-					{
-						BEvents::ExposeEvent* firstEvent = (BEvents::ExposeEvent*) precursor;
-						BEvents::ExposeEvent* nextEvent = (BEvents::ExposeEvent*) event;
+	damage_.push_back (a);
+
+	// Too much regions: Use the bounding rectangle
+	if (damage_.size () > BWIDGETS_MAX_DAMAGE_REGIONS)
+	{
+		for (const BUtilities::RectArea& d : damage_) a.extend (d);
+		damage_.clear ();
+		damage_.push_back (a);
+	}
 
-						BUtilities::RectArea area = nextEvent->getArea ();
-						firstEvent->setArea (area);
+	damagePosted_ = false;
+}
 
-						delete event;
-						return;
-					}
+void Window::postDamage ()
+{
+	if (damagePosted_) return;
 
-					// EXPOSE_EVENT
-					if (eventType == BEvents::EXPOSE_REQUEST_EVENT)
-					{
-						BEvents::ExposeEvent* firstEvent = (BEvents::ExposeEvent*) precursor;
-						BEvents::ExposeEvent* nextEvent = (BEvents::ExposeEvent*) event;
+	for (const BUtilities::RectArea& d : damage_)
+	{
+		puglPostRedisplayRect (view_, {d.getX(), d.getY(), d.getWidth(), d.getHeight()});
+	}
+	damagePosted_ = true;
+}
 
-						BUtilities::RectArea area = firstEvent->getArea ();
-						area.extend (nextEvent->getArea ());
-						firstEvent->setArea (area);
+void Window::redisplayDamage ()
+{
+	const int width = getWidth ();
+	const int height = getHeight ();
 
-						delete event;
-						return;
-					}
+	// (Re-)create storage surface on size change and redisplay all
+	if
+	(
+		(!storageSurface_) ||
+		(cairo_image_surface_get_width (storageSurface_) != width) ||
+		(cairo_image_surface_get_height (storageSurface_) != height)
+	)
+	{
+		if (storageSurface_) cairo_surface_destroy (storageSurface_);
+		storageSurface_ = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+		damage_.clear ();
+		damage_.push_back (BUtilities::RectArea (0, 0, width, height));
+	}
 
+	if (cairo_surface_status (storageSurface_) != CAIRO_STATUS_SUCCESS) return;
 
-					// POINTER_MOTION_EVENT
-					else if (eventType == BEvents::POINTER_MOTION_EVENT)
-					{
-						BEvents::PointerEvent* firstEvent = (BEvents::PointerEvent*) precursor;
-						BEvents::PointerEvent* nextEvent = (BEvents::PointerEvent*) event;
+	cairo_t* cr = cairo_create (storageSurface_);
+	if (cairo_status (cr) == CAIRO_STATUS_SUCCESS)
+	{
+		for (const BUtilities::RectArea& d : damage_)
+		{
+			// Clear damaged region and redisplay the intersecting widgets
+			cairo_save (cr);
+			cairo_rectangle (cr, d.getX (), d.getY (), d.getWidth (), d.getHeight ());
+			cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+			cairo_fill (cr);
+			cairo_restore (cr);
+
+			redisplay (storageSurface_, d);
+		}
+		damage_.clear ();
+	}
+	cairo_destroy (cr);
+}
 
-						firstEvent->setPosition (nextEvent->getPosition ());
-						firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+void Window::addEventToQueue (BEvents::Event* event)
+{
+	if (!event) return;
 
-						delete event;
-						return;
-					}
+	BEvents::EventType eventType = event->getEventType();
+	const bool mergeable =
+	(
+		(event->getWidget()) &&
+		(event->getWidget ()->isMergeable(eventType)) &&
+		(
+			(eventType == BEvents::CONFIGURE_REQUEST_EVENT) ||
+			(eventType == BEvents::POINTER_MOTION_EVENT) ||
+			(eventType == BEvents::POINTER_DRAG_EVENT) ||
+			(eventType == BEvents::WHEEL_SCROLL_EVENT) ||
+			(eventType == BEvents::VALUE_CHANGED_EVENT)
+		)
+	);
 
-					// POINTER_DRAG_EVENT
-					else if (eventType == BEvents::POINTER_DRAG_EVENT)
-					{
-						BEvents::PointerEvent* firstEvent = (BEvents::PointerEvent*) precursor;
-						BEvents::PointerEvent* nextEvent = (BEvents::PointerEvent*) event;
+	if (mergeable)
+	{
+		// Try to merge with the latest pending event of the same widget
+		// and type
+		const PendingEventKey key = {event->getWidget (), eventType};
+		std::unordered_map<PendingEventKey, BEvents::Event*, PendingEventHash>::iterator it = pendingEvents_.find (key);
+		if ((it != pendingEvents_.end ()) && mergeEvents (it->second, event))
+		{
+			delete event;
+			return;
+		}
 
-						if
-						(
-							(nextEvent->getButton() == firstEvent->getButton()) &&
-							(nextEvent->getOrigin() == firstEvent->getOrigin())
-						)
-						{
-							firstEvent->setPosition (nextEvent->getPosition ());
-							firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+		pendingEvents_[key] = event;
+	}
 
-							delete event;
-							return;
-						}
-					}
+	eventQueue_.push_back (event);
+}
 
+bool Window::mergeEvents (BEvents::Event* precursor, BEvents::Event* event)
+{
+	switch (event->getEventType ())
+	{
+		// CONFIGURE_EVENT
+		case BEvents::CONFIGURE_REQUEST_EVENT:
+		{
+			BEvents::ExposeEvent* firstEvent = (BEvents::ExposeEvent*) precursor;
+			BEvents::ExposeEvent* nextEvent = (BEvents::ExposeEvent*) event;
 
-					// WHEEL_SCROLL_EVENT
-					else if (eventType == BEvents::WHEEL_SCROLL_EVENT)
-					{
-						BEvents::WheelEvent* firstEvent = (BEvents::WheelEvent*) precursor;
-						BEvents::WheelEvent* nextEvent = (BEvents::WheelEvent*) event;
+			BUtilities::RectArea area = nextEvent->getArea ();
+			firstEvent->setArea (area);
+			return true;
+		}
 
-						if (nextEvent->getPosition() == firstEvent->getPosition())
-						{
-							firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+		// POINTER_MOTION_EVENT
+		case BEvents::POINTER_MOTION_EVENT:
+		{
+			BEvents::PointerEvent* firstEvent = (BEvents::PointerEvent*) precursor;
+			BEvents::PointerEvent* nextEvent = (BEvents::PointerEvent*) event;
 
-							delete event;
-							return;
-						}
-					}
+			firstEvent->setPosition (nextEvent->getPosition ());
+			firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+			return true;
+		}
 
-					// VALUE_CHANGED_EVENT
-					else if (eventType == BEvents::VALUE_CHANGED_EVENT)
-					{
-						BEvents::ValueChangedEvent* firstEvent = (BEvents::ValueChangedEvent*) precursor;
-						BEvents::ValueChangedEvent* nextEvent = (BEvents::ValueChangedEvent*) event;
+		// POINTER_DRAG_EVENT
+		case BEvents::POINTER_DRAG_EVENT:
+		{
+			BEvents::PointerEvent* firstEvent = (BEvents::PointerEvent*) precursor;
+			BEvents::PointerEvent* nextEvent = (BEvents::PointerEvent*) event;
 
-						firstEvent->setValue (nextEvent->getValue());
-						delete event;
-						return;
-					}
-				}
+			if
+			(
+				(nextEvent->getButton() == firstEvent->getButton()) &&
+				(nextEvent->getOrigin() == firstEvent->getOrigin())
+			)
+			{
+				firstEvent->setPosition (nextEvent->getPosition ());
+				firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+				return true;
+			}
+			return false;
+		}
+
+		// WHEEL_SCROLL_EVENT
+		case BEvents::WHEEL_SCROLL_EVENT:
+		{
+			BEvents::WheelEvent* firstEvent = (BEvents::WheelEvent*) precursor;
+			BEvents::WheelEvent* nextEvent = (BEvents::WheelEvent*) event;
+
+			if (nextEvent->getPosition() == firstEvent->getPosition())
+			{
+				firstEvent->setDelta (firstEvent->getDelta () + nextEvent->getDelta ());
+				return true;
 			}
+			return false;
 		}
+
+		// VALUE_CHANGED_EVENT
+		case BEvents::VALUE_CHANGED_EVENT:
+		{
+			BEvents::ValueChangedEvent* firstEvent = (BEvents::ValueChangedEvent*) precursor;
+			BEvents::ValueChangedEvent* nextEvent = (BEvents::ValueChangedEvent*) event;
+
+			firstEvent->setValue (nextEvent->getValue());
+			return true;
+		}
+
+		default:
+			return false;
 	}
+}
 
-	eventQueue_.push_back (event);
+void Window::removePendingEvent (BEvents::Event* event)
+{
+	if ((!event) || pendingEvents_.empty ()) return;
+
+	const PendingEventKey key = {event->getWidget (), event->getEventType ()};
+	std::unordered_map<PendingEventKey, BEvents::Event*, PendingEventHash>::iterator it = pendingEvents_.find (key);
+	if ((it != pendingEvents_.end ()) && (it->second == event)) pendingEvents_.erase (it);
 }
 
 BDevices::DeviceGrabStack<uint32_t>* Window::getKeyGrabStack () {return &keyGrabStack_;}
@@ -255,6 +389,7 @@ void Window::handleEvents ()
 	{
 		BEvents::Event* event = eventQueue_.front ();
 		eventQueue_.pop_front ();
+		removePendingEvent (event);
 
 		if (event)
 		{
@@ -397,6 +532,8 @@ void Window::handleEvents ()
 			delete event;
 		}
 	}
+
+	postDamage ();
 }
 
 PuglStatus Window::translatePuglEvent (PuglView* view, const PuglEvent* puglEvent)
@@ -647,23 +784,24 @@ PuglStatus Window::translatePuglEvent (PuglView* view, const PuglEvent* puglEven
 		{
 			BUtilities::RectArea area = BUtilities::RectArea (puglEvent->expose.x, puglEvent->expose.y, puglEvent->expose.width, puglEvent->expose.height);
 
-			// Create a temporal storage surface and store all children surfaces on this
-			cairo_surface_t* storageSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, w->getWidth(), w->getHeight());
-			if (cairo_surface_status (storageSurface) == CAIRO_STATUS_SUCCESS)
-			{
-				w->redisplay (storageSurface, area);
+			// Update the damaged regions of the storage surface
+			w->redisplayDamage ();
 
-				// Copy storage surface onto pugl provided surface
+			// Copy the exposed area of the storage surface onto pugl
+			// provided surface
+			if (w->storageSurface_ && (cairo_surface_status (w->storageSurface_) == CAIRO_STATUS_SUCCESS))
+			{
 				cairo_t* cr = w->getPuglContext ();
 				if (cairo_status (cr) == CAIRO_STATUS_SUCCESS)
 				{
 					cairo_save (cr);
-					cairo_set_source_surface (cr, storageSurface, 0, 0);
+					cairo_rectangle (cr, area.getX (), area.getY (), area.getWidth (), area.getHeight ());
+					cairo_clip (cr);
+					cairo_set_source_surface (cr, w->storageSurface_, 0, 0);
 					cairo_paint (cr);
 					cairo_restore (cr);
 				}
 			}
-			cairo_surface_destroy (storageSurface);
 		}
 		break;
 
@@ -767,6 +905,7 @@ void Window::purgeEventQueue (Widget* widget)
 		)
 		{
 			it = eventQueue_.erase (it);
+			removePendingEvent (event);
 			delete event;
 		}
 		else ++it;
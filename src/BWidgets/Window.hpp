@@ -20,11 +20,17 @@
 
 // Default BWidgets::Window settings (Note: use non-transparent backgrounds only)
 #define BWIDGETS_DEFAULT_WINDOW_BACKGROUND BStyles::blackFill
+#define BWIDGETS_MAX_DAMAGE_REGIONS 16
+#define BWIDGETS_WIDGET_INDEX_CELL_SIZE 32
 
 #include <chrono>
 #include <deque>
 #include <list>
+#include <unordered_map>
+#include <vector>
+#include <functional>
 #include "Widget.hpp"
+#include "TextLayoutCache.hpp"
 
 namespace BWidgets
 {
@@ -127,6 +133,19 @@ public:
 	 */
 	void purgeEventQueue (Widget* widget = nullptr);
 
+	/*
+	 * Invalidates the hit test index. Called on changes of the widget
+	 * tree, of the widget positions, extends, stacking or state.
+	 */
+	void invalidateWidgetIndex ();
+
+	/*
+	 * Gets (the pointer to) the text layout cache of this window. Clear
+	 * the cache on changes of the text rendering (e.g., theme or scale).
+	 * @return	Pointer to textLayoutCache_.
+	 */
+	TextLayoutCache* getTextLayoutCache ();
+
 protected:
 
 	/**
@@ -136,7 +155,48 @@ protected:
 	static PuglStatus translatePuglEvent (PuglView* view, const PuglEvent* event);
 
 	void translateTimeEvent ();
-	void mergeEvents ();
+
+	/*
+	 * Finds the top widget at a position. Uses the hit test index
+	 * instead of walking through the widget tree. The index is rebuilt
+	 * on demand.
+	 * @param position	Position relative to the window
+	 * @param func		Widget must match this condition
+	 * @return		Pointer to the widget or nullptr if no widget
+	 *			found
+	 */
+	Widget* getWidgetAt (const BUtilities::Point& position, std::function<bool (Widget* widget)> func = [] (Widget* widget) {return true;});
+
+	void buildWidgetIndex ();
+
+	/*
+	 * Adds an area to the damage regions. Overlapping regions are
+	 * coalesced.
+	 */
+	void addDamage (const BUtilities::RectArea& area);
+
+	/*
+	 * Requests pugl to expose the damage regions. Called once per
+	 * handleEvents round.
+	 */
+	void postDamage ();
+
+	/*
+	 * Redisplays the damage regions onto the storage surface.
+	 */
+	void redisplayDamage ();
+
+	/*
+	 * Merges an event into a pending precursor event of the same widget
+	 * and type.
+	 * @return	True if merged, otherwise false
+	 */
+	bool mergeEvents (BEvents::Event* precursor, BEvents::Event* event);
+
+	/*
+	 * Removes an event from the index of pending mergeable events.
+	 */
+	void removePendingEvent (BEvents::Event* event);
 
 	void unfocus();
 
@@ -149,6 +209,43 @@ protected:
 	BUtilities::Point pointer_;
 
 	std::deque<BEvents::Event*> eventQueue_;		// TODO: std::list ?
+
+	// Index of the latest pending mergeable event for each widget and
+	// event type
+	struct PendingEventKey
+	{
+		Widget* widget;
+		BEvents::EventType eventType;
+
+		bool operator== (const PendingEventKey& that) const
+		{return (widget == that.widget) && (eventType == that.eventType);}
+	};
+
+	struct PendingEventHash
+	{
+		size_t operator() (const PendingEventKey& key) const
+		{return std::hash<Widget*> () (key.widget) ^ (std::hash<int> () (key.eventType) << 1);}
+	};
+
+	std::unordered_map<PendingEventKey, BEvents::Event*, PendingEventHash> pendingEvents_;
+
+	// Measured and fitted texts of all widgets
+	TextLayoutCache textLayoutCache_;
+
+	// Hit test index: Widgets with their clipped absolute areas in stacking
+	// order and a uniform grid of cells containing the indexes of the
+	// overlapping widgets
+	std::vector<std::pair<Widget*, BUtilities::RectArea>> widgetIndex_;
+	std::vector<std::vector<size_t>> widgetGrid_;
+	int widgetGridColumns_;
+	int widgetGridRows_;
+	bool widgetIndexValid_;
+
+	// Damage regions not yet redisplayed and persistent storage surface
+	// containing the composited widgets
+	std::vector<BUtilities::RectArea> damage_;
+	bool damagePosted_;
+	cairo_surface_t* storageSurface_;
 };
 
 }
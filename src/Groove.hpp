@@ -0,0 +1,63 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef GROOVE_HPP_
+#define GROOVE_HPP_
+
+#include "definitions.h"
+#include <array>
+
+#define MAX_GROOVE_TIMING 0.5f
+#define MIN_GROOVE_VELOCITY 0.0f
+#define MAX_GROOVE_VELOCITY 2.0f
+
+/*
+ * Groove template: Timing offsets (in fractions of a step, positive = late)
+ * and velocity factors for a cycle of size steps. Steps are counted from
+ * the beginning of the song (host) or from the autoplay start.
+ */
+struct Groove
+{
+	int size;
+	float timing[MAXSTEPS];
+	float velocity[MAXSTEPS];
+};
+
+// Built-in templates, index = GrooveIndex (the user groove is stored in
+// the plugin state)
+const std::array<Groove, NR_GROOVES> defaultGrooves =
+{{
+	// GROOVE_OFF
+	{1, {0.0f}, {1.0f}},
+
+	// GROOVE_SHUFFLE
+	{4, {0.0f, 0.17f, 0.0f, 0.17f}, {1.0f, 0.8f, 0.95f, 0.8f}},
+
+	// GROOVE_LAID_BACK
+	{8, {0.0f, 0.04f, 0.06f, 0.04f, 0.02f, 0.06f, 0.08f, 0.06f}, {1.0f, 0.85f, 0.9f, 0.85f, 1.0f, 0.85f, 0.9f, 0.85f}},
+
+	// GROOVE_PUSH
+	{8, {0.0f, -0.04f, -0.06f, -0.04f, -0.02f, -0.06f, -0.08f, -0.06f}, {1.0f, 0.9f, 1.05f, 0.9f, 1.0f, 0.9f, 1.1f, 0.9f}},
+
+	// GROOVE_USER (default: no groove)
+	{1, {0.0f}, {1.0f}}
+}};
+
+#endif /* GROOVE_HPP_ */
@@ -0,0 +1,96 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef GROOVEIMPORT_HPP_
+#define GROOVEIMPORT_HPP_
+
+#include <cmath>
+#include <string>
+#include "definitions.h"
+#include "Groove.hpp"
+#include "SMFReader.hpp"
+
+/*
+ * Extracts a groove template from the notes of a Standard MIDI File (e.g.,
+ * MPC grooves exported as MIDI files). Each note on is assigned to the
+ * nearest step of the step grid. The timing offset of a groove step is the
+ * mean distance (in steps) of its notes from the straight grid, the
+ * velocity factor is the mean velocity of its notes relative to the mean
+ * velocity of all notes. Steps without notes are straight.
+ * @param path		Path of the Standard MIDI File
+ * @param stepsPerBeat	Step grid
+ * @param size		Groove cycle size in steps (1..MAXSTEPS)
+ * @param groove	Groove template to be set
+ * @return		True on success, false if the file can't be read or
+ *			doesn't contain notes
+ */
+inline bool readGroove (const std::string& path, const double stepsPerBeat, const int size, Groove& groove)
+{
+	SMFReader reader;
+	if (!reader.open (path)) return false;
+
+	const int n = LIMIT (size, 1, MAXSTEPS);
+	const double ticksPerStep = double (reader.getDivision ()) / stepsPerBeat;
+	if (ticksPerStep <= 0.0) return false;
+
+	double timingSum[MAXSTEPS] = {0.0};
+	double velocitySum[MAXSTEPS] = {0.0};
+	int count[MAXSTEPS] = {0};
+	double totalVelocity = 0.0;
+	int totalCount = 0;
+
+	for (int t = 0; reader.selectTrack (t); ++t)
+	{
+		SMFEvent ev;
+		while (reader.next (ev))
+		{
+			if (((ev.msg[0] & 0xF0) != 0x90) || (ev.msg[2] == 0)) continue;
+
+			const double stepPos = double (ev.tick) / ticksPerStep;
+			const double step = floor (stepPos + 0.5);
+			const int i = int64_t (step) % n;
+			timingSum[i] += stepPos - step;
+			velocitySum[i] += ev.msg[2];
+			++count[i];
+			totalVelocity += ev.msg[2];
+			++totalCount;
+		}
+	}
+
+	if (totalCount == 0)
+	{
+		fprintf (stderr, "BSEQuencer: No notes found in %s.\n", path.c_str ());
+		return false;
+	}
+
+	const double meanVelocity = totalVelocity / totalCount;
+	groove.size = n;
+	for (int i = 0; i < n; ++i)
+	{
+		const float timing = (count[i] ? timingSum[i] / count[i] : 0.0);
+		const float velocity = (count[i] ? velocitySum[i] / count[i] / meanVelocity : 1.0);
+		groove.timing[i] = LIMIT (timing, -MAX_GROOVE_TIMING, MAX_GROOVE_TIMING);
+		groove.velocity[i] = LIMIT (velocity, MIN_GROOVE_VELOCITY, MAX_GROOVE_VELOCITY);
+	}
+
+	return true;
+}
+
+#endif /* GROOVEIMPORT_HPP_ */
@@ -61,5 +61,53 @@
 #define BSEQUENCER_LABEL_CANCEL "Abbruch"
 #define BSEQUENCER_LABEL_APPLY "Anwenden"
 #define BSEQUENCER_LABEL_USES_SCALE "wie Tonart"
+#define BSEQUENCER_LABEL_PATTERN "Pattern"
+#define BSEQUENCER_LABEL_THEN "dann"
+#define BSEQUENCER_LABEL_REPEAT "Wiederholen"
+#define BSEQUENCER_LABEL_SWITCH "Wechsel"
+#define BSEQUENCER_LABEL_NEXT_STEP "Schritt"
+#define BSEQUENCER_LABEL_NEXT_BAR "Takt"
+#define BSEQUENCER_LABEL_NEXT_STEP_CUT "Schritt & Stopp"
+#define BSEQUENCER_LABEL_NEXT_BAR_CUT "Takt & Stopp"
+#define BSEQUENCER_LABEL_PLAYING "Spielt"
+#define BSEQUENCER_LABEL_MIDI "MIDI"
+#define BSEQUENCER_LABEL_OFF "Aus"
+#define BSEQUENCER_LABEL_PROGRAM "Programm"
+#define BSEQUENCER_LABEL_KEYS "Tasten"
+#define BSEQUENCER_LABEL_PROGRAM_AND_KEYS "Prg & Tasten"
+#define BSEQUENCER_LABEL_PRESET "Preset"
+#define BSEQUENCER_LABEL_PRESET_AND_KEYS "Pre & Tasten"
+#define BSEQUENCER_LABEL_RECORD "Aufn."
+#define BSEQUENCER_LABEL_GROOVE "Groove"
+#define BSEQUENCER_LABEL_SHUFFLE "Shuffle"
+#define BSEQUENCER_LABEL_LAID_BACK "Laid back"
+#define BSEQUENCER_LABEL_PUSH "Treibend"
+#define BSEQUENCER_LABEL_USER "Benutzer"
+#define BSEQUENCER_LABEL_RATCHET "Ratsche"
+#define BSEQUENCER_LABEL_ACCEL "Accel."
+#define BSEQUENCER_LABEL_EVEN "Gleich"
+#define BSEQUENCER_LABEL_RITARD "Ritard."
+#define BSEQUENCER_LABEL_CONDITION "Bedingung"
+#define BSEQUENCER_LABEL_FIRST "1."
+#define BSEQUENCER_LABEL_NOT_FIRST "Nicht 1."
+#define BSEQUENCER_LABEL_FILL "Fill"
+#define BSEQUENCER_LABEL_NOT_FILL "Kein Fill"
+#define BSEQUENCER_LABEL_PRE "Vorh."
+#define BSEQUENCER_LABEL_NOT_PRE "Nicht vorh."
+#define BSEQUENCER_LABEL_AUTO "Auto"
+#define BSEQUENCER_LABEL_AUTOMATION "Automation"
+#define BSEQUENCER_LABEL_TYPE "Typ"
+#define BSEQUENCER_LABEL_CC "CC"
+#define BSEQUENCER_LABEL_PITCH_BEND "Pitch Bend"
+#define BSEQUENCER_LABEL_AFTERTOUCH "Aftertouch"
+#define BSEQUENCER_LABEL_INTERPOLATION "Interpolation"
+#define BSEQUENCER_LABEL_STEP "Stufen"
+#define BSEQUENCER_LABEL_LINEAR "Linear"
+#define BSEQUENCER_LABEL_EXPONENTIAL "Exponentiell"
+#define BSEQUENCER_LABEL_RATE "Rate"
+#define BSEQUENCER_LABEL_IMPORT "Import"
+#define BSEQUENCER_LABEL_OPEN "Öffnen"
+#define BSEQUENCER_LABEL_NEW_FOLDER "Neuer Ordner:"
+#define BSEQUENCER_LABEL_CANT_CREATE_FOLDER "Fehler: Ordner kann nicht erstellt werden"
 
 #endif
@@ -61,5 +61,53 @@
 #define BSEQUENCER_LABEL_CANCEL "Cancel"
 #define BSEQUENCER_LABEL_APPLY "Apply"
 #define BSEQUENCER_LABEL_USES_SCALE "uses scale"
+#define BSEQUENCER_LABEL_PATTERN "Pattern"
+#define BSEQUENCER_LABEL_THEN "then"
+#define BSEQUENCER_LABEL_REPEAT "Repeat"
+#define BSEQUENCER_LABEL_SWITCH "Switch"
+#define BSEQUENCER_LABEL_NEXT_STEP "Next step"
+#define BSEQUENCER_LABEL_NEXT_BAR "Next bar"
+#define BSEQUENCER_LABEL_NEXT_STEP_CUT "Step & cut"
+#define BSEQUENCER_LABEL_NEXT_BAR_CUT "Bar & cut"
+#define BSEQUENCER_LABEL_PLAYING "Playing"
+#define BSEQUENCER_LABEL_MIDI "MIDI"
+#define BSEQUENCER_LABEL_OFF "Off"
+#define BSEQUENCER_LABEL_PROGRAM "Program"
+#define BSEQUENCER_LABEL_KEYS "Keys"
+#define BSEQUENCER_LABEL_PROGRAM_AND_KEYS "Prg & keys"
+#define BSEQUENCER_LABEL_PRESET "Preset"
+#define BSEQUENCER_LABEL_PRESET_AND_KEYS "Pre & keys"
+#define BSEQUENCER_LABEL_RECORD "Rec"
+#define BSEQUENCER_LABEL_GROOVE "Groove"
+#define BSEQUENCER_LABEL_SHUFFLE "Shuffle"
+#define BSEQUENCER_LABEL_LAID_BACK "Laid back"
+#define BSEQUENCER_LABEL_PUSH "Push"
+#define BSEQUENCER_LABEL_USER "User"
+#define BSEQUENCER_LABEL_RATCHET "Ratchet"
+#define BSEQUENCER_LABEL_ACCEL "Accel."
+#define BSEQUENCER_LABEL_EVEN "Even"
+#define BSEQUENCER_LABEL_RITARD "Ritard."
+#define BSEQUENCER_LABEL_CONDITION "Condition"
+#define BSEQUENCER_LABEL_FIRST "1st"
+#define BSEQUENCER_LABEL_NOT_FIRST "Not 1st"
+#define BSEQUENCER_LABEL_FILL "Fill"
+#define BSEQUENCER_LABEL_NOT_FILL "Not fill"
+#define BSEQUENCER_LABEL_PRE "Pre"
+#define BSEQUENCER_LABEL_NOT_PRE "Not pre"
+#define BSEQUENCER_LABEL_AUTO "Auto"
+#define BSEQUENCER_LABEL_AUTOMATION "Automation"
+#define BSEQUENCER_LABEL_TYPE "Type"
+#define BSEQUENCER_LABEL_CC "CC"
+#define BSEQUENCER_LABEL_PITCH_BEND "Pitch bend"
+#define BSEQUENCER_LABEL_AFTERTOUCH "Aftertouch"
+#define BSEQUENCER_LABEL_INTERPOLATION "Interpolation"
+#define BSEQUENCER_LABEL_STEP "Step"
+#define BSEQUENCER_LABEL_LINEAR "Linear"
+#define BSEQUENCER_LABEL_EXPONENTIAL "Exponential"
+#define BSEQUENCER_LABEL_RATE "Rate"
+#define BSEQUENCER_LABEL_IMPORT "Import"
+#define BSEQUENCER_LABEL_OPEN "Open"
+#define BSEQUENCER_LABEL_NEW_FOLDER "New folder:"
+#define BSEQUENCER_LABEL_CANT_CREATE_FOLDER "Error: Can't create folder"
 
 #endif
@@ -61,5 +61,53 @@
 #define BSEQUENCER_LABEL_CANCEL "Annulla"
 #define BSEQUENCER_LABEL_APPLY "Applica"
 #define BSEQUENCER_LABEL_USES_SCALE "usa la scala"
+#define BSEQUENCER_LABEL_PATTERN "Pattern"
+#define BSEQUENCER_LABEL_THEN "poi"
+#define BSEQUENCER_LABEL_REPEAT "Ripeti"
+#define BSEQUENCER_LABEL_SWITCH "Cambio"
+#define BSEQUENCER_LABEL_NEXT_STEP "Passo"
+#define BSEQUENCER_LABEL_NEXT_BAR "Battuta"
+#define BSEQUENCER_LABEL_NEXT_STEP_CUT "Passo e taglia"
+#define BSEQUENCER_LABEL_NEXT_BAR_CUT "Battuta e taglia"
+#define BSEQUENCER_LABEL_PLAYING "In riproduzione"
+#define BSEQUENCER_LABEL_MIDI "MIDI"
+#define BSEQUENCER_LABEL_OFF "Off"
+#define BSEQUENCER_LABEL_PROGRAM "Programma"
+#define BSEQUENCER_LABEL_KEYS "Tasti"
+#define BSEQUENCER_LABEL_PROGRAM_AND_KEYS "Prg e tasti"
+#define BSEQUENCER_LABEL_PRESET "Preset"
+#define BSEQUENCER_LABEL_PRESET_AND_KEYS "Pre e tasti"
+#define BSEQUENCER_LABEL_RECORD "Reg"
+#define BSEQUENCER_LABEL_GROOVE "Groove"
+#define BSEQUENCER_LABEL_SHUFFLE "Shuffle"
+#define BSEQUENCER_LABEL_LAID_BACK "Rilassato"
+#define BSEQUENCER_LABEL_PUSH "Spinto"
+#define BSEQUENCER_LABEL_USER "Utente"
+#define BSEQUENCER_LABEL_RATCHET "Ratchet"
+#define BSEQUENCER_LABEL_ACCEL "Accel."
+#define BSEQUENCER_LABEL_EVEN "Pari"
+#define BSEQUENCER_LABEL_RITARD "Ritard."
+#define BSEQUENCER_LABEL_CONDITION "Condizione"
+#define BSEQUENCER_LABEL_FIRST "1°"
+#define BSEQUENCER_LABEL_NOT_FIRST "Non 1°"
+#define BSEQUENCER_LABEL_FILL "Fill"
+#define BSEQUENCER_LABEL_NOT_FILL "No fill"
+#define BSEQUENCER_LABEL_PRE "Prec."
+#define BSEQUENCER_LABEL_NOT_PRE "Non prec."
+#define BSEQUENCER_LABEL_AUTO "Auto"
+#define BSEQUENCER_LABEL_AUTOMATION "Automazione"
+#define BSEQUENCER_LABEL_TYPE "Tipo"
+#define BSEQUENCER_LABEL_CC "CC"
+#define BSEQUENCER_LABEL_PITCH_BEND "Pitch bend"
+#define BSEQUENCER_LABEL_AFTERTOUCH "Aftertouch"
+#define BSEQUENCER_LABEL_INTERPOLATION "Interpolazione"
+#define BSEQUENCER_LABEL_STEP "Gradini"
+#define BSEQUENCER_LABEL_LINEAR "Lineare"
+#define BSEQUENCER_LABEL_EXPONENTIAL "Esponenziale"
+#define BSEQUENCER_LABEL_RATE "Frequenza"
+#define BSEQUENCER_LABEL_IMPORT "Importa"
+#define BSEQUENCER_LABEL_OPEN "Apri"
+#define BSEQUENCER_LABEL_NEW_FOLDER "Nuova cartella:"
+#define BSEQUENCER_LABEL_CANT_CREATE_FOLDER "Errore: impossibile creare la cartella"
 
 #endif
@@ -27,6 +27,10 @@
 
 #define MIDIBUFFERSIZE 256
 
+// Stack space kept free for note messages: Automation messages are only
+// appended while more than MIDIBUFFER_NOTE_RESERVE entries are left
+#define MIDIBUFFER_NOTE_RESERVE 128
+
  class MidiStack : private std::array<MidiData, MIDIBUFFERSIZE>
  {
  private:
@@ -39,6 +43,8 @@
 
  	size_t size () {return sz;}
 
+ 	size_t space () {return MIDIBUFFERSIZE - sz;}
+
  	void append (const int64_t frames, const uint8_t ch, const uint8_t status, const int note, const uint8_t velocity, uint8_t size = 3)
  	{
  		if (sz < MIDIBUFFERSIZE)
@@ -6,9 +6,11 @@ struct Pad
 	Pad () : Pad (0, 0, 0, 0, 0, 0, 0, 0, 0, 0) {}
 
 	Pad	(float ch, float pitchNote, float pitchOctave, float velocity, float duration,
-		float randGate, float randNote, float randOctave, float randVelocity, float randDuration) :
+		float randGate, float randNote, float randOctave, float randVelocity, float randDuration,
+		float ratchet = 1, float ratchetCurve = 0, float condition = 0) :
 			ch (ch), pitchNote (pitchNote), pitchOctave (pitchOctave), velocity (velocity), duration (duration),
-			randGate (randGate), randNote (randNote), randOctave (randOctave), randVelocity (randVelocity), randDuration (randDuration)
+			randGate (randGate), randNote (randNote), randOctave (randOctave), randVelocity (randVelocity), randDuration (randDuration),
+			ratchet (ratchet), ratchetCurve (ratchetCurve), condition (condition)
 	{}
 
 	bool operator== (const Pad& that)
@@ -18,7 +20,8 @@ struct Pad
 			(ch == that.ch) && (pitchNote == that.pitchNote) && (pitchOctave == that.pitchOctave) &&
 			(velocity == that.velocity) && (duration == that.duration) &&
 			(randGate == that.randGate) && (randNote == that.randNote) && (randOctave == that.randOctave) &&
-			(randVelocity == that.randVelocity) && (randDuration == that.randDuration)
+			(randVelocity == that.randVelocity) && (randDuration == that.randDuration) &&
+			(ratchet == that.ratchet) && (ratchetCurve == that.ratchetCurve) && (condition == that.condition)
 		);
 	}
 
@@ -34,6 +37,9 @@ struct Pad
 	float randOctave;
 	float randVelocity;
 	float randDuration;
+	float ratchet;			// Number of notes per step (1..MAX_RATCHETS)
+	float ratchetCurve;		// Ratchet timing: < 0 accelerating, 0 even, > 0 decelerating
+	float condition;		// Trig condition (ConditionIndex), 0 = always
 };
 
 #endif /* PAD_HPP_ */
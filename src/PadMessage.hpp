@@ -3,7 +3,7 @@
 
 #include "Pad.hpp"
 
-#define ENDPADMESSAGE -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0
+#define ENDPADMESSAGE -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0
 
 struct PadMessage : Pad
 {
@@ -14,8 +14,10 @@ struct PadMessage : Pad
 	{}
 
 	PadMessage	(float step, float row, float ch, float pitchNote, float pitchOctave, float velocity, float duration,
-			float randGate, float randNote, float randOctave, float randVelocity, float randDuration) :
-				Pad (ch, pitchNote, pitchOctave, velocity, duration, randGate, randNote, randOctave, randVelocity, randDuration),
+			float randGate, float randNote, float randOctave, float randVelocity, float randDuration,
+			float ratchet, float ratchetCurve, float condition) :
+				Pad (ch, pitchNote, pitchOctave, velocity, duration, randGate, randNote, randOctave, randVelocity, randDuration,
+				     ratchet, ratchetCurve, condition),
 				step (step), row (row)
 	{}
 
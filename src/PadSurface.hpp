@@ -25,6 +25,12 @@
 #include "BWidgets/Focusable.hpp"
 #include "BWidgets/Text.hpp"
 
+/*
+ * Drawing surface with two layers: The static pads are drawn to the drawing
+ * surface, the playback cursors to the overlay surface. Both layers are
+ * composited on drawing. Thus, cursor movements only need to redraw the
+ * overlay and to redisplay the changed area.
+ */
 class PadSurface : public BWidgets::DrawingSurface, public BWidgets::Focusable
 {
 public:
@@ -35,13 +41,42 @@ public:
                 DrawingSurface (x, y, width, height, name),
                 Focusable (std::chrono::milliseconds (BWIDGETS_DEFAULT_FOCUS_IN_MS),
 			std::chrono::milliseconds (BWIDGETS_DEFAULT_FOCUS_OUT_MS)),
-                focusText (0, 0, 400, 100, name + "/focus", "")
+                focusText (0, 0, 400, 100, name + "/focus", ""),
+                overlaySurface (nullptr)
         {
                 focusText.setStacking (BWidgets::STACKING_OVERSIZE);
                 focusText.hide ();
                 add (focusText);
         }
 
+        PadSurface (const PadSurface& that) = delete;
+
+        ~PadSurface ()
+        {
+                if (overlaySurface) cairo_surface_destroy (overlaySurface);
+        }
+
+        PadSurface& operator= (const PadSurface& that) = delete;
+
+        /*
+         * Gets the overlay surface. The overlay surface is (re-)created
+         * on demand with the size of the drawing surface.
+         */
+        cairo_surface_t* getOverlaySurface ()
+        {
+                if (!overlayFits ())
+                {
+                        if (overlaySurface) cairo_surface_destroy (overlaySurface);
+                        overlaySurface = cairo_image_surface_create
+                        (
+                                CAIRO_FORMAT_ARGB32,
+                                cairo_image_surface_get_width (drawingSurface),
+                                cairo_image_surface_get_height (drawingSurface)
+                        );
+                }
+                return overlaySurface;
+        }
+
         virtual void onFocusIn (BEvents::FocusEvent* event) override
         {
                 Widget::onFocusIn (event);
@@ -71,6 +106,37 @@ public:
 		applyTheme (theme, name_);
 	}
 
+protected:
+        virtual void draw (const BUtilities::RectArea& area) override
+        {
+                DrawingSurface::draw (area);
+
+                // Composite overlay (if not outdated by resizing)
+                if ((!overlayFits ()) || (!widgetSurface_) || (cairo_surface_status (widgetSurface_) != CAIRO_STATUS_SUCCESS)) return;
+                if ((getWidth () < 4) || (getHeight () < 4)) return;
+
+                cairo_t* cr = cairo_create (widgetSurface_);
+                if (cairo_status (cr) == CAIRO_STATUS_SUCCESS)
+                {
+                        cairo_rectangle (cr, area.getX (), area.getY (), area.getWidth (), area.getHeight ());
+                        cairo_clip (cr);
+                        cairo_set_source_surface (cr, overlaySurface, getXOffset (), getYOffset ());
+                        cairo_paint (cr);
+                }
+                cairo_destroy (cr);
+        }
+
+        bool overlayFits () const
+        {
+                return
+                (
+                        overlaySurface && drawingSurface &&
+                        (cairo_image_surface_get_width (overlaySurface) == cairo_image_surface_get_width (drawingSurface)) &&
+                        (cairo_image_surface_get_height (overlaySurface) == cairo_image_surface_get_height (drawingSurface))
+                );
+        }
+
+        cairo_surface_t* overlaySurface;
 };
 
 #endif /*PADSURFACE_HPP_*/
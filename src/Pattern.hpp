@@ -26,6 +26,7 @@
 #include "definitions.h"
 #include "Pad.hpp"
 #include "PadMessage.hpp"
+#include "RowProperties.hpp"
 #include "Journal.hpp"
 
 #define MAXUNDO 20
@@ -69,6 +70,18 @@ public:
         	pads[r][s] = pad;
         }
 
+        RowProperties getRow (const size_t row) const
+        {
+        	size_t r = LIMIT (row, 0, ROWS - 1);
+        	return rows[r];
+        }
+
+        void setRow (const size_t row, const RowProperties& props)
+        {
+        	size_t r = LIMIT (row, 0, ROWS - 1);
+        	rows[r] = props;
+        }
+
         std::vector<PadMessage> undo ()
         {
         	if (!changes.newMessage.empty ()) store ();
@@ -151,6 +164,7 @@ public:
 private:
         Journal<std::vector<PadMessage>, MAXUNDO> journal;
         Pad pads [ROWS] [MAXSTEPS];
+        RowProperties rows [ROWS];
         struct
         {
                 std::vector<PadMessage> oldMessage;
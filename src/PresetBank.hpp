@@ -0,0 +1,209 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef PRESETBANK_HPP_
+#define PRESETBANK_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "definitions.h"
+#include "ports.h"
+#include "Pad.hpp"
+#include "RowProperties.hpp"
+#include "AutomationLane.hpp"
+#include "Groove.hpp"
+#include "ScaleMap.hpp"
+
+#define PRESET_BANK_ID "BSEQBNK"
+#define PRESET_BANK_VERSION 1
+
+/*
+ * Binary preset bank. Compiled from the bundled .ttl presets by
+ * PresetBankCompiler at build time and linked into the plugin. The same
+ * format can be used for user bank files.
+ *
+ * Layout: PresetBankHeader followed by nrPresets presets. Each preset
+ * starts with a PresetBankPreset followed by nrPads PresetBankPad, nrRows
+ * PresetBankRow, nrLanes PresetBankLane and nrScaleMaps PresetBankScaleMap
+ * records. Only non-empty pads and non-default rows, automation lanes and
+ * scale maps are stored. All records are 4-byte aligned.
+ */
+struct PresetBankHeader
+{
+	char id[8];			// PRESET_BANK_ID
+	uint32_t version;		// PRESET_BANK_VERSION
+	uint32_t nrPresets;
+	uint32_t presetSize;		// Record sizes, used to reject incompatible banks
+	uint32_t padSize;
+	uint32_t rowSize;
+	uint32_t laneSize;
+	uint32_t scaleMapSize;
+};
+
+struct PresetBankPreset
+{
+	char name[64];
+	uint32_t size;			// Total size incl. the following records
+	uint32_t nrPads;
+	uint32_t nrRows;
+	uint32_t nrLanes;
+	uint32_t nrScaleMaps;
+	float controllers[KNOBS_SIZE];
+	int32_t chain[NR_PATTERNS];
+	Groove groove;
+};
+
+struct PresetBankPad
+{
+	int32_t id;			// Same as in the plugin state: (pattern * MAXSTEPS + step) * ROWS + row
+	Pad pad;
+};
+
+struct PresetBankRow
+{
+	int32_t id;			// pattern * ROWS + row
+	RowProperties props;
+};
+
+struct PresetBankLane
+{
+	int32_t id;			// pattern * NR_SEQUENCER_CHS + ch
+	AutomationLane lane;
+};
+
+struct PresetBankScaleMap
+{
+	int32_t index;			// Index in the scale map list
+	RTScaleMap map;
+};
+
+class PresetBank
+{
+public:
+	PresetBank () : presets (), fileData () {}
+
+	/*
+	 * Validates the bank data and indexes its presets. The data are NOT
+	 * copied and must stay valid. Not real time safe.
+	 * @return	True on success, otherwise the bank is empty
+	 */
+	bool setData (const void* bankData, const size_t bankSize)
+	{
+		presets.clear ();
+
+		if ((!bankData) || (bankSize < sizeof (PresetBankHeader))) return false;
+
+		const PresetBankHeader* header = (const PresetBankHeader*) bankData;
+		if
+		(
+			(strncmp (header->id, PRESET_BANK_ID, 8) != 0) ||
+			(header->version != PRESET_BANK_VERSION) ||
+			(header->presetSize != sizeof (PresetBankPreset)) ||
+			(header->padSize != sizeof (PresetBankPad)) ||
+			(header->rowSize != sizeof (PresetBankRow)) ||
+			(header->laneSize != sizeof (PresetBankLane)) ||
+			(header->scaleMapSize != sizeof (PresetBankScaleMap))
+		)
+		{
+			fprintf (stderr, "BSEQuencer.lv2: Incompatible preset bank.\n");
+			return false;
+		}
+
+		const uint8_t* bytes = (const uint8_t*) bankData;
+		size_t pos = sizeof (PresetBankHeader);
+		for (uint32_t i = 0; (i < header->nrPresets) && (i < MAX_BANK_PRESETS); ++i)
+		{
+			if (bankSize - pos < sizeof (PresetBankPreset)) break;
+			const PresetBankPreset* preset = (const PresetBankPreset*) (bytes + pos);
+			if
+			(
+				(preset->nrPads > NR_PATTERNS * ROWS * MAXSTEPS) ||
+				(preset->nrRows > NR_PATTERNS * ROWS) ||
+				(preset->nrLanes > NR_PATTERNS * NR_SEQUENCER_CHS) ||
+				(preset->nrScaleMaps > NR_SYSTEM_SCALES + NR_USER_SCALES) ||
+				(preset->size != getSize (preset)) ||
+				(preset->size > bankSize - pos)
+			) break;
+			presets.push_back (preset);
+			pos += preset->size;
+		}
+
+		if (presets.size () != header->nrPresets)
+		{
+			fprintf (stderr, "BSEQuencer.lv2: Preset bank incomplete. %i of %i presets loaded.\n", int (presets.size ()), int (header->nrPresets));
+		}
+
+		return true;
+	}
+
+	/*
+	 * Loads a (user) bank file. Not real time safe.
+	 */
+	bool load (const std::string& path)
+	{
+		FILE* file = fopen (path.c_str (), "rb");
+		if (!file)
+		{
+			fprintf (stderr, "BSEQuencer.lv2: Can't open preset bank %s.\n", path.c_str ());
+			return false;
+		}
+
+		fseek (file, 0, SEEK_END);
+		long size = ftell (file);
+		fseek (file, 0, SEEK_SET);
+		fileData.resize (size > 0 ? (size + 3) / 4 : 0);
+		size_t nr = (size > 0 ? fread (fileData.data (), 1, size, file) : 0);
+		fclose (file);
+
+		return setData (fileData.data (), nr);
+	}
+
+	size_t size () const {return presets.size ();}
+
+	const PresetBankPreset* getPreset (const size_t index) const {return (index < presets.size () ? presets[index] : nullptr);}
+
+	static const PresetBankPad* getPads (const PresetBankPreset* preset) {return (const PresetBankPad*) (preset + 1);}
+
+	static const PresetBankRow* getRows (const PresetBankPreset* preset) {return (const PresetBankRow*) (getPads (preset) + preset->nrPads);}
+
+	static const PresetBankLane* getLanes (const PresetBankPreset* preset) {return (const PresetBankLane*) (getRows (preset) + preset->nrRows);}
+
+	static const PresetBankScaleMap* getScaleMaps (const PresetBankPreset* preset) {return (const PresetBankScaleMap*) (getLanes (preset) + preset->nrLanes);}
+
+	// Calculated in 64 bit: Record counts of corrupt files must not overflow
+	static uint64_t getSize (const PresetBankPreset* preset)
+	{
+		return
+		(
+			uint64_t (sizeof (PresetBankPreset)) + uint64_t (preset->nrPads) * sizeof (PresetBankPad) +
+			uint64_t (preset->nrRows) * sizeof (PresetBankRow) + uint64_t (preset->nrLanes) * sizeof (PresetBankLane) +
+			uint64_t (preset->nrScaleMaps) * sizeof (PresetBankScaleMap)
+		);
+	}
+
+private:
+	std::vector<const PresetBankPreset*> presets;
+	std::vector<uint32_t> fileData;
+};
+
+#endif /* PRESETBANK_HPP_ */
@@ -0,0 +1,95 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Build tool: Compiles .ttl presets into a binary preset bank (see
+ * PresetBank.hpp). The presets are restored by the plugin's own
+ * state_restore, thus the bank contains exactly what the host would load.
+ *
+ * Usage: PresetBankCompiler [-b] OUTPUT PLUGIN_TTL PRESET_TTL...
+ *	-b	Write a binary bank file (user bank) instead of a C header
+ *		defining presetBankData[]
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "BSEQuencer.cpp"	// Single translation unit, like the plugin itself
+#include "ToolHost.hpp"
+
+/*
+ * Restores a preset .ttl in a new plugin instance and appends it to the bank.
+ */
+static bool compilePreset (ToolHost& host, const std::string& path, std::vector<uint32_t>& bank)
+{
+	if (!host.readPreset (path)) return false;
+
+	BSEQuencer plugin (48000.0, host.features);
+	host.restore (plugin);
+	plugin.appendBankPreset (bank, host.name, host.controllers);
+	return true;
+}
+
+int main (int argc, char** argv)
+{
+	int arg = 1;
+	bool binary = false;
+	if ((argc > 1) && (strcmp (argv[1], "-b") == 0))
+	{
+		binary = true;
+		++arg;
+	}
+
+	if (argc < arg + 2)
+	{
+		fprintf (stderr, "Usage: PresetBankCompiler [-b] OUTPUT PLUGIN_TTL PRESET_TTL...\n");
+		return 1;
+	}
+
+	const std::string output = argv[arg];
+	ToolHost host;
+	if (!host.readPlugin (argv[arg + 1])) return 1;
+
+	std::vector<uint32_t> bank;
+	for (int i = arg + 2; (i < argc) && (i < arg + 2 + MAX_BANK_PRESETS); ++i)
+	{
+		if (!compilePreset (host, argv[i], bank)) return 1;
+	}
+
+	FILE* file = fopen (output.c_str (), (binary ? "wb" : "w"));
+	if (!file)
+	{
+		fprintf (stderr, "PresetBankCompiler: Can't write %s.\n", output.c_str ());
+		return 1;
+	}
+
+	if (binary) fwrite (bank.data (), sizeof (uint32_t), bank.size (), file);
+	else
+	{
+		fprintf (file, "// Generated by PresetBankCompiler, do not edit.\n\n");
+		fprintf (file, "static const uint32_t presetBankData[] =\n{");
+		for (size_t i = 0; i < bank.size (); ++i) fprintf (file, "%s0x%08x,", (i % 8 == 0 ? "\n\t" : " "), bank[i]);
+		fprintf (file, "\n};\n");
+	}
+
+	fclose (file);
+	return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef ROWMESSAGE_HPP_
+#define ROWMESSAGE_HPP_
+
+#include "RowProperties.hpp"
+
+struct RowMessage : RowProperties
+{
+	RowMessage () : RowMessage (-1, RowProperties ()) {}
+
+	RowMessage (float row, RowProperties props) :
+		RowProperties (props), row (row)
+	{}
+
+	RowMessage (float row, float length, float multiplier, float divider) :
+		RowProperties (length, multiplier, divider), row (row)
+	{}
+
+	float row;
+};
+
+#endif /* ROWMESSAGE_HPP_ */
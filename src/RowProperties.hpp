@@ -0,0 +1,24 @@
+#ifndef ROWPROPERTIES_HPP_
+#define ROWPROPERTIES_HPP_
+
+struct RowProperties
+{
+	RowProperties () : RowProperties (0, 1, 1) {}
+
+	RowProperties (float length, float multiplier, float divider) :
+		length (length), multiplier (multiplier), divider (divider)
+	{}
+
+	bool operator== (const RowProperties& that)
+	{
+		return ((length == that.length) && (multiplier == that.multiplier) && (divider == that.divider));
+	}
+
+	bool operator!= (const RowProperties& that) {return (!operator== (that));}
+
+	float length;			// Number of steps (1..MAXSTEPS), 0 = all steps
+	float multiplier;		// Row clock multiplier (1..MAX_ROW_MULTIPLIER)
+	float divider;			// Row clock divider (1..MAX_ROW_DIVIDER)
+};
+
+#endif /* ROWPROPERTIES_HPP_ */
@@ -0,0 +1,380 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Command line tool: Renders a preset to a Standard MIDI File as fast as
+ * possible. The plugin itself is run block by block (same run () and
+ * runSequencer () as in a host), thus the output matches the plugin.
+ *
+ * Usage: SMFExport [OPTIONS] OUTPUT PRESET
+ *	PRESET		.ttl preset file or number of a built-in bank preset
+ *	-d PLUGIN_TTL	Plugin .ttl for the control port defaults
+ *			(default: BSEQuencer.ttl next to the preset)
+ *	-t BPM		Tempo (default: autoplay tempo of the preset)
+ *	-l BEATS	Length in beats (default: 16)
+ *	-k KEY		Held key BEAT:NOTE[:VELOCITY[:LENGTH]], LENGTH in beats
+ *			(default: until the end). Can be used multiple times.
+ *	-s FILE		Key script, one KEY per line, # comments
+ *	-r RATE		Render sample rate (default: 48000)
+ *	-b FRAMES	Render block size (default: 4096)
+ *	-x SEED		Random generator seed (default: time based)
+ *	-e		Write a text event list (frame, status, data bytes)
+ *			instead of a MIDI file
+ *
+ * Without keys, the preset is rendered in autoplay mode. With keys, it is
+ * rendered in host controlled mode and the keys are sent as MIDI input.
+ *
+ * The output doesn't depend on the block size. Event lists rendered with a
+ * fixed seed at different block sizes (e.g. 1, 17, 64, 4096) can be used to
+ * check changes of the sequencer for regressions.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include "BSEQuencer.cpp"	// Single translation unit, like the plugin itself
+#include "ToolHost.hpp"
+#include "SMFWriter.hpp"
+
+#define EXPORT_BLOCK_SIZE 4096
+#define EXPORT_MAX_BLOCK_SIZE 8192
+#define EXPORT_BUFFER_SIZE 65536
+#define EXPORT_DIVISION 960
+
+struct KeyEvent
+{
+	double beat;
+	uint8_t msg[3];
+
+	bool operator< (const KeyEvent& that) const
+	{
+		// Note off first
+		if (beat != that.beat) return beat < that.beat;
+		return (msg[0] & 0xF0) < (that.msg[0] & 0xF0);
+	}
+};
+
+static bool parseKey (const std::string& text, const uint8_t channel, std::vector<KeyEvent>& keys, const double length)
+{
+	double beat = 0.0, note = -1.0, velocity = 100.0, duration = -1.0;
+	if (sscanf (text.c_str (), "%lf:%lf:%lf:%lf", &beat, &note, &velocity, &duration) < 2) return false;
+	if ((beat < 0.0) || (note < 0.0) || (note > 127.0)) return false;
+
+	velocity = LIMIT (velocity, 1.0, 127.0);
+	const double end = (duration > 0.0 ? std::min (beat + duration, length) : length);
+	keys.push_back (KeyEvent {beat, {uint8_t (LV2_MIDI_MSG_NOTE_ON | channel), uint8_t (note), uint8_t (velocity)}});
+	keys.push_back (KeyEvent {end, {uint8_t (LV2_MIDI_MSG_NOTE_OFF | channel), uint8_t (note), 0}});
+	return true;
+}
+
+static void usage ()
+{
+	fprintf
+	(
+		stderr,
+		"Usage: SMFExport [OPTIONS] OUTPUT PRESET\n"
+		"  PRESET         .ttl preset file or number of a built-in bank preset\n"
+		"  -d PLUGIN_TTL  Plugin .ttl for the control port defaults\n"
+		"  -t BPM         Tempo (default: autoplay tempo of the preset)\n"
+		"  -l BEATS       Length in beats (default: 16)\n"
+		"  -k KEY         Held key BEAT:NOTE[:VELOCITY[:LENGTH]]\n"
+		"  -s FILE        Key script, one KEY per line\n"
+		"  -r RATE        Render sample rate (default: 48000)\n"
+		"  -b FRAMES      Render block size (default: 4096)\n"
+		"  -x SEED        Random generator seed (default: time based)\n"
+		"  -e             Write a text event list instead of a MIDI file\n"
+	);
+}
+
+int main (int argc, char** argv)
+{
+	std::string pluginTtl = "";
+	double bpm = 0.0;
+	double length = 16.0;
+	double rate = 48000.0;
+	int blockSize = EXPORT_BLOCK_SIZE;
+	long seed = -1;
+	bool eventList = false;
+	std::vector<std::string> keySpecs;
+
+	int arg = 1;
+	for (; (arg < argc) && (argv[arg][0] == '-') && (argv[arg][1] != 0); ++arg)
+	{
+		const char opt = argv[arg][1];
+		if (opt == 'e')
+		{
+			eventList = true;
+			continue;
+		}
+
+		if (arg + 1 >= argc) {usage (); return 1;}
+		const std::string val = argv[++arg];
+
+		switch (opt)
+		{
+			case 'd':	pluginTtl = val;
+					break;
+
+			case 't':	bpm = atof (val.c_str ());
+					break;
+
+			case 'l':	length = atof (val.c_str ());
+					break;
+
+			case 'k':	keySpecs.push_back (val);
+					break;
+
+			case 's':	{
+						std::ifstream script (val);
+						if (!script)
+						{
+							fprintf (stderr, "SMFExport: Can't open %s.\n", val.c_str ());
+							return 1;
+						}
+						std::string line;
+						while (std::getline (script, line))
+						{
+							line = line.substr (0, line.find ('#'));
+							if (line.find_first_not_of (" \t\r") != std::string::npos) keySpecs.push_back (line);
+						}
+					}
+					break;
+
+			case 'r':	rate = atof (val.c_str ());
+					break;
+
+			case 'b':	blockSize = atoi (val.c_str ());
+					break;
+
+			case 'x':	seed = atol (val.c_str ());
+					break;
+
+			default:	usage ();
+					return 1;
+		}
+	}
+
+	if ((argc - arg != 2) || (length <= 0.0) || (rate <= 0.0) || (blockSize < 1) || (blockSize > EXPORT_MAX_BLOCK_SIZE))
+	{
+		usage ();
+		return 1;
+	}
+	const std::string output = argv[arg];
+	const std::string preset = argv[arg + 1];
+	const bool ttl = (preset.size () > 4) && (preset.compare (preset.size () - 4, 4, ".ttl") == 0);
+
+	// Control port defaults
+	if (pluginTtl.empty ())
+	{
+		const size_t slash = preset.rfind ('/');
+		pluginTtl = (ttl && (slash != std::string::npos) ? preset.substr (0, slash + 1) : std::string ("")) + "BSEQuencer.ttl";
+	}
+	ToolHost host;
+	if (!host.readPlugin (pluginTtl)) return 1;
+
+	// Preset controllers
+	int bankNr = 0;
+	if (ttl)
+	{
+		if (!host.readPreset (preset)) return 1;
+	}
+	else
+	{
+#ifdef PRESETBANKFILE
+		PresetBank bank;
+		bank.setData (presetBankData, sizeof (presetBankData));
+		bankNr = atoi (preset.c_str ());
+		const PresetBankPreset* p = bank.getPreset (bankNr - 1);
+		if (!p)
+		{
+			fprintf (stderr, "SMFExport: No bank preset #%s (1..%i).\n", preset.c_str (), int (bank.size ()));
+			return 1;
+		}
+		host.name = p->name;
+		memcpy (host.controllers, p->controllers, sizeof (host.controllers));
+#else
+		fprintf (stderr, "SMFExport: Built without preset bank. Use a .ttl preset.\n");
+		return 1;
+#endif
+	}
+
+	if (bpm <= 0.0) bpm = host.controllers[AUTOPLAY_BPM];
+	const int beatsPerBar = host.controllers[AUTOPLAY_BPB];
+	const double framesPerBeat = rate * 60.0 / bpm;
+	const uint64_t totalFrames = length * framesPerBeat;
+
+	// Held keys
+	const uint8_t channel = (host.controllers[MIDI_IN_CHANNEL] > 0 ? host.controllers[MIDI_IN_CHANNEL] - 1 : 0);
+	std::vector<KeyEvent> keys;
+	for (const std::string& spec : keySpecs)
+	{
+		if (!parseKey (spec, channel, keys, length))
+		{
+			fprintf (stderr, "SMFExport: Invalid key %s.\n", spec.c_str ());
+			return 1;
+		}
+	}
+	std::stable_sort (keys.begin (), keys.end ());
+
+	float ports[KNOBS_SIZE];
+	memcpy (ports, host.controllers, sizeof (ports));
+	ports[PLAY] = 0.0f;
+	ports[PRESET] = bankNr;
+
+	// Plugin
+	BSEQuencer plugin (rate, host.features);
+	std::vector<uint32_t> inBuffer (EXPORT_BUFFER_SIZE / 4);
+	std::vector<uint32_t> outBuffer (EXPORT_BUFFER_SIZE / 4);
+	std::vector<uint32_t> notifyBuffer (EXPORT_BUFFER_SIZE / 4);
+	LV2_Atom_Sequence* inSeq = (LV2_Atom_Sequence*) inBuffer.data ();
+	LV2_Atom_Sequence* outSeq = (LV2_Atom_Sequence*) outBuffer.data ();
+	LV2_Atom_Sequence* notifySeq = (LV2_Atom_Sequence*) notifyBuffer.data ();
+	plugin.connect_port (INPUT, inSeq);
+	plugin.connect_port (OUTPUT, outSeq);
+	plugin.connect_port (NOTIFY, notifySeq);
+	for (int i = 0; i < KNOBS_SIZE; ++i) plugin.connect_port (KNOBS + i, &ports[i]);
+	plugin.activate ();
+	if (ttl) host.restore (plugin);
+	if (seed >= 0) plugin.seed (seed);
+
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init (&forge, &host.map);
+	const LV2_URID midiEvent = host.map_uri (LV2_MIDI__MidiEvent);
+
+	// Bank preset: Load it in an empty cycle first. The plugin takes over
+	// the preset controllers until the ports are changed, like below.
+	if (bankNr > 0)
+	{
+		LV2_Atom_Forge_Frame seqFrame;
+		lv2_atom_forge_set_buffer (&forge, (uint8_t*) inSeq, EXPORT_BUFFER_SIZE);
+		lv2_atom_forge_sequence_head (&forge, &seqFrame, 0);
+		lv2_atom_forge_pop (&forge, &seqFrame);
+		outSeq->atom.size = EXPORT_BUFFER_SIZE - sizeof (LV2_Atom);
+		notifySeq->atom.size = EXPORT_BUFFER_SIZE - sizeof (LV2_Atom);
+		plugin.run (0);
+	}
+
+	// Mode: Autoplay without keys, host controlled with keys
+	ports[PLAY] = 1.0f;
+	ports[MODE] = (keys.empty () ? AUTOPLAY : HOST_CONTROLLED);
+	ports[AUTOPLAY_BPM] = bpm;
+
+	SMFWriter smf;
+	FILE* list = nullptr;
+	if (eventList)
+	{
+		list = fopen (output.c_str (), "w");
+		if (!list)
+		{
+			fprintf (stderr, "SMFExport: Can't write %s.\n", output.c_str ());
+			return 1;
+		}
+		fprintf (list, "# %s\n# frame status data\n", host.name.c_str ());
+	}
+	else
+	{
+		if (!smf.open (output, EXPORT_DIVISION)) return 1;
+		smf.writeTrackName (0, host.name);
+		smf.writeTempo (0, bpm);
+		smf.writeTimeSignature (0, beatsPerBar);
+	}
+
+	// Render
+	size_t keyNr = 0;
+	bool stop = false;
+	for (uint64_t frame = 0; !stop; frame += blockSize)
+	{
+		// Last block: Stop playback, plugin sends note offs
+		if (frame >= totalFrames)
+		{
+			ports[PLAY] = 0.0f;
+			frame = totalFrames;
+			stop = true;
+		}
+		const uint32_t nrFrames = (stop ? 1 : std::min<uint64_t> (blockSize, totalFrames - frame));
+
+		// Input: Transport (first block) and keys
+		LV2_Atom_Forge_Frame seqFrame;
+		lv2_atom_forge_set_buffer (&forge, (uint8_t*) inSeq, EXPORT_BUFFER_SIZE);
+		lv2_atom_forge_sequence_head (&forge, &seqFrame, 0);
+
+		if (frame == 0)
+		{
+			LV2_Atom_Forge_Frame posFrame;
+			lv2_atom_forge_frame_time (&forge, 0);
+			lv2_atom_forge_object (&forge, &posFrame, 0, host.map_uri (LV2_TIME__Position));
+			lv2_atom_forge_key (&forge, host.map_uri (LV2_TIME__beatsPerMinute));
+			lv2_atom_forge_float (&forge, bpm);
+			lv2_atom_forge_key (&forge, host.map_uri (LV2_TIME__beatsPerBar));
+			lv2_atom_forge_float (&forge, beatsPerBar);
+			lv2_atom_forge_key (&forge, host.map_uri (LV2_TIME__speed));
+			lv2_atom_forge_float (&forge, 1.0f);
+			lv2_atom_forge_pop (&forge, &posFrame);
+		}
+
+		while ((keyNr < keys.size ()) && (!stop))
+		{
+			const uint64_t keyFrame = keys[keyNr].beat * framesPerBeat;
+			if (keyFrame >= frame + nrFrames) break;
+			lv2_atom_forge_frame_time (&forge, keyFrame - frame);
+			lv2_atom_forge_atom (&forge, 3, midiEvent);
+			lv2_atom_forge_write (&forge, keys[keyNr].msg, 3);
+			++keyNr;
+		}
+
+		lv2_atom_forge_pop (&forge, &seqFrame);
+
+		outSeq->atom.size = EXPORT_BUFFER_SIZE - sizeof (LV2_Atom);
+		notifySeq->atom.size = EXPORT_BUFFER_SIZE - sizeof (LV2_Atom);
+		plugin.run (nrFrames);
+
+		// Output: Stream MIDI to file
+		LV2_ATOM_SEQUENCE_FOREACH (outSeq, ev)
+		{
+			if ((ev->body.type != midiEvent) || (ev->body.size == 0)) continue;
+			const uint8_t* msg = (const uint8_t*) (ev + 1);
+			if (msg[0] >= 0xF0) continue;	// SMF: Channel messages only
+
+			if (list)
+			{
+				fprintf (list, "%llu", (unsigned long long) (frame + ev->time.frames));
+				for (uint32_t i = 0; i < ev->body.size; ++i) fprintf (list, " %02x", msg[i]);
+				fprintf (list, "\n");
+			}
+			else
+			{
+				const double beat = double (frame + ev->time.frames) / framesPerBeat;
+				smf.writeMidi (uint32_t (beat * EXPORT_DIVISION + 0.5), msg, ev->body.size);
+			}
+		}
+	}
+
+	if (list)
+	{
+		const bool ok = (ferror (list) == 0);
+		fclose (list);
+		return (ok ? 0 : 1);
+	}
+
+	return (smf.close () ? 0 : 1);
+}
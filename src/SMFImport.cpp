@@ -0,0 +1,164 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Command line tool: Converts Standard MIDI Files into a preset bank. Each
+ * MIDI file becomes a preset based on a .ttl preset (scale map, step grid,
+ * channels, ...). The notes are imported into a pattern of the base preset
+ * by the plugin itself (see BSEQuencer::importSMF and SMFImport.hpp).
+ *
+ * Usage: SMFImport [OPTIONS] OUTPUT PLUGIN_TTL BASE_PRESET_TTL MIDI...
+ *	-b		Write a binary bank file (user bank) instead of a C
+ *			header defining presetBankData[]
+ *	-t TRACK	SMF track (default: first track containing notes)
+ *	-m CHANNEL	MIDI channel filter 1..16 (default: all)
+ *	-c CHANNEL	Sequencer channel 1..4 (default: 1)
+ *	-p PATTERN	Target pattern 1..16 (default: 1)
+ *	-g GROOVE_MIDI	Extract the user groove from a MIDI file and select it
+ *			(see GrooveImport.hpp)
+ *	-s SIZE		Groove size in steps (default: one 4/4 bar)
+ *
+ * The step grid (steps per beat) and the number of steps are taken from
+ * the base preset.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "BSEQuencer.cpp"	// Single translation unit, like the plugin itself
+#include "ToolHost.hpp"
+
+static void usage ()
+{
+	fprintf
+	(
+		stderr,
+		"Usage: SMFImport [OPTIONS] OUTPUT PLUGIN_TTL BASE_PRESET_TTL MIDI...\n"
+		"  -b             Write a binary bank file instead of a C header\n"
+		"  -t TRACK       SMF track (default: first track containing notes)\n"
+		"  -m CHANNEL     MIDI channel filter 1..16 (default: all)\n"
+		"  -c CHANNEL     Sequencer channel 1..4 (default: 1)\n"
+		"  -p PATTERN     Target pattern 1..16 (default: 1)\n"
+		"  -g GROOVE_MIDI Extract the user groove from a MIDI file\n"
+		"  -s SIZE        Groove size in steps (default: one 4/4 bar)\n"
+	);
+}
+
+// File name without directory and extension
+static std::string getPresetName (const std::string& path)
+{
+	const size_t slash = path.rfind ('/');
+	std::string name = (slash == std::string::npos ? path : path.substr (slash + 1));
+	const size_t dot = name.rfind ('.');
+	return (dot == std::string::npos ? name : name.substr (0, dot));
+}
+
+int main (int argc, char** argv)
+{
+	bool binary = false;
+	int pattern = 0;
+	std::string groovePath = "";
+	int grooveSize = 0;
+	SMFImportSettings settings;
+
+	int arg = 1;
+	for (; (arg < argc) && (argv[arg][0] == '-') && (argv[arg][1] != 0); ++arg)
+	{
+		const char opt = argv[arg][1];
+		if (opt == 'b')
+		{
+			binary = true;
+			continue;
+		}
+
+		if (arg + 1 >= argc) {usage (); return 1;}
+		if (opt == 'g')
+		{
+			groovePath = argv[++arg];
+			continue;
+		}
+
+		const int val = atoi (argv[++arg]);
+
+		switch (opt)
+		{
+			case 't':	settings.track = val;
+					break;
+
+			case 'm':	settings.midiChannel = LIMIT (val, 0, 16);
+					break;
+
+			case 'c':	settings.ch = LIMIT (val, 1, NR_SEQUENCER_CHS);
+					break;
+
+			case 'p':	pattern = LIMIT (val, 1, NR_PATTERNS) - 1;
+					break;
+
+			case 's':	grooveSize = LIMIT (val, 1, MAXSTEPS);
+					break;
+
+			default:	usage ();
+					return 1;
+		}
+	}
+
+	if (argc - arg < 4) {usage (); return 1;}
+	const std::string output = argv[arg];
+	ToolHost host;
+	if (!host.readPlugin (argv[arg + 1])) return 1;
+	if (!host.readPreset (argv[arg + 2])) return 1;
+
+	// Step grid from the base preset
+	const float* c = host.controllers;
+	settings.stepsPerBeat = (c[BASE] == PER_BEAT ? c[STEPS_PER] : c[STEPS_PER] / c[AUTOPLAY_BPB]);
+	settings.nrSteps = c[NR_OF_STEPS];
+	if (grooveSize == 0) grooveSize = LIMIT (int (4.0 * settings.stepsPerBeat + 0.5), 1, MAXSTEPS);
+	if (groovePath != "") host.controllers[GROOVE] = GROOVE_USER;
+
+	std::vector<uint32_t> bank;
+	for (int i = arg + 3; (i < argc) && (i < arg + 3 + MAX_BANK_PRESETS); ++i)
+	{
+		BSEQuencer plugin (48000.0, host.features);
+		host.restore (plugin);
+		if ((groovePath != "") && (!plugin.importGroove (groovePath, settings.stepsPerBeat, grooveSize))) return 1;
+		if (!plugin.importSMF (argv[i], settings, pattern, host.controllers)) return 1;
+		plugin.appendBankPreset (bank, getPresetName (argv[i]), host.controllers);
+	}
+
+	FILE* file = fopen (output.c_str (), (binary ? "wb" : "w"));
+	if (!file)
+	{
+		fprintf (stderr, "SMFImport: Can't write %s.\n", output.c_str ());
+		return 1;
+	}
+
+	if (binary) fwrite (bank.data (), sizeof (uint32_t), bank.size (), file);
+	else
+	{
+		fprintf (file, "// Generated by SMFImport, do not edit.\n\n");
+		fprintf (file, "static const uint32_t presetBankData[] =\n{");
+		for (size_t i = 0; i < bank.size (); ++i) fprintf (file, "%s0x%08x,", (i % 8 == 0 ? "\n\t" : " "), bank[i]);
+		fprintf (file, "\n};\n");
+	}
+
+	fclose (file);
+	return 0;
+}
@@ -0,0 +1,212 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SMFIMPORT_HPP_
+#define SMFIMPORT_HPP_
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include "definitions.h"
+#include "BScale.hpp"
+#include "Pad.hpp"
+#include "SMFReader.hpp"
+
+struct SMFImportSettings
+{
+	int track = -1;			// SMF track number, -1 = first track containing notes
+	int midiChannel = 0;		// MIDI channel filter (1..16), 0 = all
+	double stepsPerBeat = 4.0;	// Step grid
+	int nrSteps = 16;		// Notes starting after the last step are skipped
+	int ch = 1;			// Sequencer channel (1..4) of the imported pads
+};
+
+/*
+ * Imports the notes of a Standard MIDI File track into a pad matrix. Notes
+ * are quantized to the nearest step and mapped to the rows of a scale map
+ * (see getRow). Velocity and duration are taken from the notes. Notes
+ * longer than a step are tied over the following pads.
+ */
+class SMFImport
+{
+public:
+	/*
+	 * @param elements	Scale map elements of all rows (0x100 flag:
+	 *			absolute MIDI note, drumkit)
+	 * @param scale		Scale used for the scale map elements
+	 * @param noteOffset	Note offset of the sequencer channel
+	 */
+	SMFImport (const int* elements, const BScale& scale, const int noteOffset) :
+		elements (elements), scale (scale), noteOffset (noteOffset), nrImported (0), nrSkipped (0)
+	{}
+
+	/*
+	 * Imports a track. The pad matrix is cleared before.
+	 * @param path		Path of the Standard MIDI File
+	 * @param settings	Import settings
+	 * @param pads		Pad matrix [ROWS][MAXSTEPS]
+	 * @return		True on success
+	 */
+	bool import (const std::string& path, const SMFImportSettings& settings, Pad (*pads) [MAXSTEPS])
+	{
+		nrImported = 0;
+		nrSkipped = 0;
+
+		SMFReader reader;
+		if (!reader.open (path)) return false;
+
+		for (int r = 0; r < ROWS; ++r)
+		{
+			for (int s = 0; s < MAXSTEPS; ++s) pads[r][s] = Pad ();
+		}
+
+		const double ticksPerStep = double (reader.getDivision ()) / settings.stepsPerBeat;
+		if (ticksPerStep <= 0.0) return false;
+
+		const int firstTrack = (settings.track >= 0 ? settings.track : 0);
+		const int lastTrack = (settings.track >= 0 ? settings.track : reader.getNrTracks () - 1);
+		for (int t = firstTrack; (t <= lastTrack) && reader.selectTrack (t); ++t)
+		{
+			int64_t noteOn[NR_MIDI_KEYS];
+			uint8_t velocity[NR_MIDI_KEYS];
+			for (int i = 0; i < NR_MIDI_KEYS; ++i) noteOn[i] = -1;
+			bool notes = false;
+			uint32_t lastTick = 0;
+
+			SMFEvent ev;
+			while (reader.next (ev))
+			{
+				lastTick = ev.tick;
+				const int type = ev.msg[0] & 0xF0;
+				const int note = ev.msg[1];
+				if ((type != 0x80) && (type != 0x90)) continue;
+				if ((settings.midiChannel != 0) && (settings.midiChannel - 1 != (ev.msg[0] & 0x0F))) continue;
+
+				// Note off (or note on with zero velocity)
+				if ((type == 0x80) || (ev.msg[2] == 0))
+				{
+					if (noteOn[note] < 0) continue;
+					setNote (settings, ticksPerStep, note, velocity[note], noteOn[note], ev.tick, pads);
+					noteOn[note] = -1;
+				}
+
+				// Note on: Retriggered notes end the previous one
+				else
+				{
+					if (noteOn[note] >= 0) setNote (settings, ticksPerStep, note, velocity[note], noteOn[note], ev.tick, pads);
+					noteOn[note] = ev.tick;
+					velocity[note] = ev.msg[2];
+					notes = true;
+				}
+			}
+
+			// Notes held until the end of the track
+			for (int i = 0; i < NR_MIDI_KEYS; ++i)
+			{
+				if (noteOn[i] >= 0) setNote (settings, ticksPerStep, i, velocity[i], noteOn[i], lastTick, pads);
+			}
+
+			if (notes && (settings.track < 0)) break;
+		}
+
+		return true;
+	}
+
+	/*
+	 * Finds the row which plays a MIDI note. Rows playing the note itself
+	 * are preferred. Otherwise the row playing the same note with the
+	 * least octave shift is used (scale rows only).
+	 * @param note		MIDI note
+	 * @param octave	Pointer to an int which receives the octave shift
+	 * @return		Row number or -1 if no row plays this note
+	 */
+	int getRow (const int note, int* octave)
+	{
+		return getRow (note, elements, scale, noteOffset, octave);
+	}
+
+	static int getRow (const int note, const int* elements, BScale& scale, const int noteOffset, int* octave)
+	{
+		int bestRow = -1;
+		int bestOctave = 0;
+
+		for (int row = 0; row < ROWS; ++row)
+		{
+			const int element = elements[row];
+			const bool drum = element & 0x100;
+			const int rowNote = (drum ? element & 0x0FF : scale.getMIDInote (element & 0x0FF));
+			if (rowNote == ENOTE) continue;
+
+			const int diff = note - rowNote - noteOffset;
+			if (diff == 0)
+			{
+				*octave = 0;
+				return row;
+			}
+
+			if ((!drum) && (diff % 12 == 0) && (abs (diff / 12) <= 8) && ((bestRow < 0) || (abs (diff / 12) < abs (bestOctave))))
+			{
+				bestRow = row;
+				bestOctave = diff / 12;
+			}
+		}
+
+		*octave = bestOctave;
+		return bestRow;
+	}
+
+	int getNrImported () const {return nrImported;}
+
+	int getNrSkipped () const {return nrSkipped;}
+
+private:
+	void setNote (const SMFImportSettings& settings, const double ticksPerStep, const int note, const uint8_t velocity,
+		      const uint32_t startTick, const uint32_t endTick, Pad (*pads) [MAXSTEPS])
+	{
+		const int step = floor (double (startTick) / ticksPerStep + 0.5);
+		int octave = 0;
+		const int row = getRow (note, &octave);
+		if ((step >= settings.nrSteps) || (step >= MAXSTEPS) || (row < 0))
+		{
+			++nrSkipped;
+			return;
+		}
+
+		// Duration in steps (1/100 resolution, like recorded notes), tied
+		// over the following pads if longer than one step
+		float duration = round (100.0 * double (endTick - startTick) / ticksPerStep) / 100.0;
+		duration = LIMIT (duration, 0.01f, float (std::min (settings.nrSteps, MAXSTEPS) - step));
+		const float vel = LIMIT (float (velocity) / 64.0f, 0.0f, 2.0f);
+
+		for (int i = 0; i < int (ceil (duration)); ++i)
+		{
+			pads[row][step + i] = Pad (settings.ch, 0, octave, vel, duration - i, 1.0, 0, 0, 0, 0);
+		}
+		++nrImported;
+	}
+
+	const int* elements;
+	BScale scale;
+	const int noteOffset;
+	int nrImported;
+	int nrSkipped;
+};
+
+#endif /* SMFIMPORT_HPP_ */
@@ -0,0 +1,232 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SMFREADER_HPP_
+#define SMFREADER_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+struct SMFEvent
+{
+	uint32_t tick;			// Absolute time in ticks
+	uint8_t msg[3];			// MIDI channel message
+	uint8_t size;
+};
+
+/*
+ * Reads the channel messages of a single track of a Standard MIDI File.
+ * The file is streamed event by event, chunks of other tracks are skipped
+ * without reading them. Meta and SysEx events are skipped, too. Only
+ * tick based (not SMPTE) time divisions are supported.
+ */
+class SMFReader
+{
+public:
+	SMFReader () : file (nullptr), format (0), nrTracks (0), division (0), dataStart (0), trackEnd (0), runningStatus (0), tick (0) {}
+
+	~SMFReader () {close ();}
+
+	bool open (const std::string& path)
+	{
+		close ();
+		file = fopen (path.c_str (), "rb");
+		if (!file)
+		{
+			fprintf (stderr, "BSEQuencer: Can't open %s.\n", path.c_str ());
+			return false;
+		}
+
+		char id[4];
+		uint32_t size;
+		if ((!readChunkHeader (id, &size)) || (memcmp (id, "MThd", 4) != 0) || (size < 6))
+		{
+			fprintf (stderr, "BSEQuencer: %s is not a Standard MIDI File.\n", path.c_str ());
+			close ();
+			return false;
+		}
+
+		format = readInt (2);
+		nrTracks = readInt (2);
+		division = readInt (2);
+		if (division & 0x8000)
+		{
+			fprintf (stderr, "BSEQuencer: SMPTE time division in %s not supported.\n", path.c_str ());
+			close ();
+			return false;
+		}
+
+		fseek (file, size - 6, SEEK_CUR);
+		dataStart = ftell (file);
+		return true;
+	}
+
+	void close ()
+	{
+		if (file) fclose (file);
+		file = nullptr;
+	}
+
+	int getFormat () const {return format;}
+
+	int getNrTracks () const {return nrTracks;}
+
+	// Ticks per quarter note
+	int getDivision () const {return division;}
+
+	/*
+	 * Moves to the start of a track.
+	 * @param nr	Track number, starting with 0
+	 * @return	True if the track exists
+	 */
+	bool selectTrack (const int nr)
+	{
+		if (!file) return false;
+
+		fseek (file, dataStart, SEEK_SET);
+		int count = 0;
+		char id[4];
+		uint32_t size;
+		while (readChunkHeader (id, &size))
+		{
+			if (memcmp (id, "MTrk", 4) == 0)
+			{
+				if (count == nr)
+				{
+					trackEnd = ftell (file) + long (size);
+					runningStatus = 0;
+					tick = 0;
+					return true;
+				}
+				++count;
+			}
+
+			// Skip other tracks and unknown chunks
+			fseek (file, size, SEEK_CUR);
+		}
+
+		return false;
+	}
+
+	/*
+	 * Reads the next channel message of the selected track.
+	 * @return	False at the end of the track
+	 */
+	bool next (SMFEvent& event)
+	{
+		if (!file) return false;
+
+		while (ftell (file) < trackEnd)
+		{
+			tick += readVarLen ();
+			int status = getc (file);
+			if (status == EOF) return false;
+
+			// Meta event
+			if (status == 0xFF)
+			{
+				const int type = getc (file);
+				const uint32_t length = readVarLen ();
+				if (type == 0x2F) return false;		// End of track
+				fseek (file, length, SEEK_CUR);
+				continue;
+			}
+
+			// SysEx
+			if ((status == 0xF0) || (status == 0xF7))
+			{
+				const uint32_t length = readVarLen ();
+				fseek (file, length, SEEK_CUR);
+				runningStatus = 0;
+				continue;
+			}
+
+			// Running status: Status byte omitted, already read first data byte
+			int data1;
+			if (status < 0x80)
+			{
+				if (runningStatus == 0) return false;	// Corrupt track
+				data1 = status;
+				status = runningStatus;
+			}
+			else
+			{
+				runningStatus = status;
+				data1 = getc (file);
+			}
+
+			event.tick = tick;
+			event.msg[0] = status;
+			event.msg[1] = data1 & 0x7F;
+			event.msg[2] = 0;
+			event.size = 2;
+			const int type = status & 0xF0;
+			if ((type != 0xC0) && (type != 0xD0))
+			{
+				event.msg[2] = getc (file) & 0x7F;
+				event.size = 3;
+			}
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	bool readChunkHeader (char* id, uint32_t* size)
+	{
+		if (fread (id, 1, 4, file) != 4) return false;
+		*size = readInt (4);
+		return !feof (file);
+	}
+
+	uint32_t readInt (const int nrBytes)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < nrBytes; ++i) value = (value << 8) | (getc (file) & 0xFF);
+		return value;
+	}
+
+	uint32_t readVarLen ()
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			const int c = getc (file);
+			if (c == EOF) break;
+			value = (value << 7) | (c & 0x7F);
+			if (!(c & 0x80)) break;
+		}
+		return value;
+	}
+
+	FILE* file;
+	int format;
+	int nrTracks;
+	int division;
+	long dataStart;
+	long trackEnd;
+	int runningStatus;
+	uint32_t tick;
+};
+
+#endif /* SMFREADER_HPP_ */
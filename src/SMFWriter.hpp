@@ -0,0 +1,156 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SMFWRITER_HPP_
+#define SMFWRITER_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+ * Writes a single track (format 0) Standard MIDI File. Events are streamed
+ * to disk as they come in, only the track length is patched on close.
+ */
+class SMFWriter
+{
+public:
+	SMFWriter () : file (nullptr), trackStart (0), lastTick (0) {}
+
+	~SMFWriter () {close ();}
+
+	/*
+	 * Creates the file and writes the file header.
+	 * @param path		File path
+	 * @param division	Ticks per quarter note
+	 */
+	bool open (const std::string& path, const uint16_t division)
+	{
+		close ();
+		file = fopen (path.c_str (), "wb");
+		if (!file)
+		{
+			fprintf (stderr, "BSEQuencer: Can't write %s.\n", path.c_str ());
+			return false;
+		}
+
+		const uint8_t header[] =
+		{
+			'M', 'T', 'h', 'd', 0, 0, 0, 6,
+			0, 0,						// Format 0
+			0, 1,						// 1 track
+			uint8_t (division >> 8), uint8_t (division & 0xFF),
+			'M', 'T', 'r', 'k', 0, 0, 0, 0			// Length set on close
+		};
+		fwrite (header, 1, sizeof (header), file);
+		trackStart = ftell (file);
+		lastTick = 0;
+		return true;
+	}
+
+	void writeTrackName (const uint32_t tick, const std::string& name)
+	{
+		writeMeta (tick, 0x03, (const uint8_t*) name.c_str (), name.size ());
+	}
+
+	void writeTempo (const uint32_t tick, const double bpm)
+	{
+		const uint32_t usPerQuarter = 60000000.0 / bpm;
+		const uint8_t data[3] = {uint8_t (usPerQuarter >> 16), uint8_t (usPerQuarter >> 8), uint8_t (usPerQuarter)};
+		writeMeta (tick, 0x51, data, 3);
+	}
+
+	void writeTimeSignature (const uint32_t tick, const int beatsPerBar)
+	{
+		const uint8_t data[4] = {uint8_t (beatsPerBar), 2, 24, 8};	// n/4
+		writeMeta (tick, 0x58, data, 4);
+	}
+
+	/*
+	 * Writes a MIDI channel message. Ticks must not decrease, otherwise the
+	 * message is written at the tick of the previous event.
+	 */
+	void writeMidi (const uint32_t tick, const uint8_t* msg, const uint32_t size)
+	{
+		if (!file) return;
+		writeDelta (tick);
+		fwrite (msg, 1, size, file);
+	}
+
+	/*
+	 * Writes the end of track and patches the track length.
+	 */
+	bool close ()
+	{
+		if (!file) return false;
+
+		const uint8_t eot[3] = {0xFF, 0x2F, 0x00};
+		writeDelta (lastTick);
+		fwrite (eot, 1, 3, file);
+
+		const long trackEnd = ftell (file);
+		const uint32_t length = trackEnd - trackStart;
+		const uint8_t bytes[4] = {uint8_t (length >> 24), uint8_t (length >> 16), uint8_t (length >> 8), uint8_t (length)};
+		fseek (file, trackStart - 4, SEEK_SET);
+		fwrite (bytes, 1, 4, file);
+
+		const bool ok = (ferror (file) == 0);
+		fclose (file);
+		file = nullptr;
+		return ok;
+	}
+
+private:
+	void writeMeta (const uint32_t tick, const uint8_t type, const uint8_t* data, const uint32_t size)
+	{
+		if (!file) return;
+		writeDelta (tick);
+		fputc (0xFF, file);
+		fputc (type, file);
+		writeVarLen (size);
+		fwrite (data, 1, size, file);
+	}
+
+	void writeDelta (const uint32_t tick)
+	{
+		const uint32_t t = (tick > lastTick ? tick : lastTick);
+		writeVarLen (t - lastTick);
+		lastTick = t;
+	}
+
+	void writeVarLen (uint32_t value)
+	{
+		uint8_t bytes[5];
+		int nr = 0;
+		do
+		{
+			bytes[nr] = (value & 0x7F) | (nr ? 0x80 : 0);
+			value >>= 7;
+			++nr;
+		} while (value);
+		while (nr) fputc (bytes[--nr], file);
+	}
+
+	FILE* file;
+	long trackStart;
+	uint32_t lastTick;
+};
+
+#endif /* SMFWRITER_HPP_ */
@@ -32,6 +32,7 @@
 #include "BWidgets/PopupListBox.hpp"
 #include "BWidgets/TextButton.hpp"
 #include "BWidgets/ImageIcon.hpp"
+#include "BWidgets/ImageCache.hpp"
 
 #ifdef LOCALEFILE
 #include LOCALEFILE
@@ -90,7 +91,7 @@ protected:
 
 	double sz;
 
-	cairo_surface_t* bgSurface;
+	std::string bgFile;
 
 	BColors::ColorSet txColors = {{{0.167, 0.37, 0.80, 1.0}, {0.33, 0.5, 0.85, 1.0}, {0.0, 0.0, 0.25, 1.0}, {0.0, 0.0, 0.0, 0.0}}};
 	BColors::ColorSet bgColors = {{{0.15, 0.15, 0.15, 1.0}, {0.3, 0.3, 0.3, 1.0}, {0.05, 0.05, 0.05, 1.0}, {0.0, 0.0, 0.0, 1.0}}};
@@ -168,8 +169,10 @@ ScaleEditor::ScaleEditor(const double x, const double y, const double width, con
 	setFocusable (true);	// Only to block underlying pads callback
 	setStacking (BWidgets::STACKING_CATCH);
 
-	bgSurface = cairo_image_surface_create_from_png ((pluginPath + "ScaleEditor.png").c_str());
+	bgFile = pluginPath + "ScaleEditor.png";
+	cairo_surface_t* bgSurface = BWidgets::ImageCache::load (bgFile);
 	scaleEditorBg.loadFillFromCairoSurface(bgSurface);
+	cairo_surface_destroy (bgSurface);
 
 	scaleNameLabel.setEditable (true);
 	scaleNameLabel.setCallbackFunction(BEvents::BUTTON_PRESS_EVENT, labelClickCallback);
@@ -288,13 +291,8 @@ void ScaleEditor::szScaleEditor ()
 	lfLabelFont.setFontSize (12 * sz);
 
 	// Scale background
-	cairo_surface_t* surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 360 * sz, 760 * sz);
-	cairo_t* cr = cairo_create (surface);
-	cairo_scale (cr, sz, sz);
-	cairo_set_source_surface(cr, bgSurface, 0, 0);
-	cairo_paint(cr);
+	cairo_surface_t* surface = BWidgets::ImageCache::load (bgFile, sz);
 	scaleEditorBg.loadFillFromCairoSurface(surface);
-	cairo_destroy (cr);
 	cairo_surface_destroy (surface);
 
 	nameLabel.moveTo (20 * sz, 60 * sz); nameLabel.resize (80 * sz, 20 * sz);
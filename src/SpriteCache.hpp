@@ -0,0 +1,95 @@
+/* B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SPRITECACHE_HPP_
+#define SPRITECACHE_HPP_
+
+#include <cairo/cairo.h>
+#include <cstdint>
+#include <map>
+
+#define SPRITECACHE_MAX_SIZE 512
+
+/*
+ * Cache of pre-rendered images (sprites) identified by a key. Sprites are
+ * rendered once on demand and then blitted. The whole cache is cleared if
+ * it exceeds SPRITECACHE_MAX_SIZE sprites and on changes which affect all
+ * sprites (e.g., theme or scale).
+ */
+class SpriteCache
+{
+public:
+	SpriteCache () : sprites () {}
+
+	SpriteCache (const SpriteCache& that) = delete;
+
+	~SpriteCache () {clear ();}
+
+	SpriteCache& operator= (const SpriteCache& that) = delete;
+
+	/*
+	 * Gets a sprite.
+	 * @param key	Sprite key
+	 * @return	Cairo image surface or nullptr if not rendered yet
+	 */
+	cairo_surface_t* find (const uint64_t key) const
+	{
+		std::map<uint64_t, cairo_surface_t*>::const_iterator it = sprites.find (key);
+		return (it != sprites.end () ? it->second : nullptr);
+	}
+
+	/*
+	 * Creates a new empty (transparent) sprite to be rendered by the
+	 * caller.
+	 * @param key		Sprite key
+	 * @param width		Sprite width
+	 * @param height	Sprite height
+	 * @return		Cairo image surface or nullptr on error
+	 */
+	cairo_surface_t* add (const uint64_t key, const int width, const int height)
+	{
+		if (sprites.size () >= SPRITECACHE_MAX_SIZE) clear ();
+
+		cairo_surface_t* surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+		if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS)
+		{
+			cairo_surface_destroy (surface);
+			return nullptr;
+		}
+
+		cairo_surface_t*& sprite = sprites[key];
+		if (sprite) cairo_surface_destroy (sprite);
+		sprite = surface;
+		return surface;
+	}
+
+	void clear ()
+	{
+		for (std::map<uint64_t, cairo_surface_t*>::value_type& s : sprites) cairo_surface_destroy (s.second);
+		sprites.clear ();
+	}
+
+	size_t size () const {return sprites.size ();}
+
+private:
+	std::map<uint64_t, cairo_surface_t*> sprites;
+};
+
+#endif /* SPRITECACHE_HPP_ */
@@ -0,0 +1,204 @@
+/*  B.SEQuencer
+ * MIDI Step Sequencer LV2 Plugin
+ *
+ * Copyright (C) 2018, 2019 by Sven Jähnichen
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef TOOLHOST_HPP_
+#define TOOLHOST_HPP_
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
+#include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/state/state.h>
+#include "definitions.h"
+#include "ports.h"
+
+/*
+ * Minimal LV2 host environment for the command line tools (not used by the
+ * plugin): URID map, .ttl plugin / preset parser and state restore. Only
+ * the subset of Turtle written by LV2 hosts for B.SEQuencer presets is
+ * supported.
+ */
+class ToolHost
+{
+public:
+	ToolHost () :
+		name (), controllers {0}, defaults {0}, ports (), state (), urids (),
+		map {this, mapUri}, mapFeature {LV2_URID__map, &map}, features {&mapFeature, nullptr}
+	{}
+
+	/*
+	 * Reads index and default value of all control ports from the plugin
+	 * .ttl and sets the controllers to their defaults.
+	 */
+	bool readPlugin (const std::string& path)
+	{
+		std::string text;
+		if (!readFile (path, text)) return false;
+
+		size_t pos = 0;
+		while ((pos = text.find ("lv2:ControlPort", pos)) != std::string::npos)
+		{
+			size_t end = text.find ("] ,", pos);
+			if (end == std::string::npos) end = text.find ("] .", pos);
+			float index = -1;
+			float value = 0.0f;
+			const std::string symbol = getQuoted (text, "lv2:symbol", pos, end);
+			if (getNumber (text, "lv2:index", pos, end, &index) && (!symbol.empty ()))
+			{
+				const int knob = int (index) - KNOBS;
+				getNumber (text, "lv2:default", pos, end, &value);
+				if ((knob >= 0) && (knob < KNOBS_SIZE))
+				{
+					ports[symbol] = knob;
+					defaults[knob] = value;
+					controllers[knob] = value;
+				}
+			}
+			pos = (end == std::string::npos ? text.size () : end);
+		}
+
+		return true;
+	}
+
+	/*
+	 * Reads label, control port values and state of a preset .ttl. Port
+	 * values not contained in the preset are set to their defaults.
+	 */
+	bool readPreset (const std::string& path)
+	{
+		std::string text;
+		if (!readFile (path, text)) return false;
+
+		name = getQuoted (text, "rdfs:label", 0);
+		for (int i = 0; i < KNOBS_SIZE; ++i) controllers[i] = defaults[i];
+
+		size_t pos = 0;
+		while ((pos = text.find ("lv2:symbol", pos)) != std::string::npos)
+		{
+			const std::string symbol = getQuoted (text, "lv2:symbol", pos);
+			const size_t end = text.find ("]", pos);
+			float value;
+			std::map<std::string, int>::const_iterator it = ports.find (symbol);
+			if ((it != ports.end ()) && getNumber (text, "pset:value", pos, end, &value)) controllers[it->second] = value;
+			pos = (end == std::string::npos ? text.size () : end);
+		}
+
+		// State: <BSEQUENCER_URI#KEY> """data"""
+		state.clear ();
+		pos = 0;
+		const std::string prefix = "<" BSEQUENCER_URI "#STATE";
+		while ((pos = text.find (prefix, pos)) != std::string::npos)
+		{
+			const size_t keyEnd = text.find ('>', pos);
+			const size_t start = text.find ("\"\"\"", keyEnd);
+			const size_t stop = text.find ("\"\"\"", start + 3);
+			if ((keyEnd == std::string::npos) || (start == std::string::npos) || (stop == std::string::npos)) break;
+			state[mapUri (this, text.substr (pos + 1, keyEnd - pos - 1).c_str ())] = text.substr (start + 3, stop - start - 3);
+			pos = stop + 3;
+		}
+
+		return true;
+	}
+
+	/*
+	 * Restores the state read by readPreset into a plugin instance.
+	 */
+	template <class Plugin>
+	LV2_State_Status restore (Plugin& plugin)
+	{
+		return plugin.state_restore (retrieveState, this, 0, features);
+	}
+
+	LV2_URID map_uri (const char* uri) {return mapUri (this, uri);}
+
+	std::string name;
+	float controllers[KNOBS_SIZE];
+	float defaults[KNOBS_SIZE];
+	std::map<std::string, int> ports;
+	std::map<LV2_URID, std::string> state;
+	std::map<std::string, LV2_URID> urids;
+	LV2_URID_Map map;
+	LV2_Feature mapFeature;
+	const LV2_Feature* features[2];
+
+private:
+	static LV2_URID mapUri (LV2_URID_Map_Handle handle, const char* uri)
+	{
+		ToolHost* host = (ToolHost*) handle;
+		std::map<std::string, LV2_URID>::iterator it = host->urids.find (uri);
+		if (it != host->urids.end ()) return it->second;
+		const LV2_URID urid = host->urids.size () + 1;
+		host->urids[uri] = urid;
+		return urid;
+	}
+
+	static const void* retrieveState (LV2_State_Handle handle, uint32_t key, size_t* size, uint32_t* type, uint32_t* flags)
+	{
+		ToolHost* host = (ToolHost*) handle;
+		std::map<LV2_URID, std::string>::iterator it = host->state.find (key);
+		if (it == host->state.end ()) return nullptr;
+		*size = it->second.size () + 1;
+		*type = mapUri (host, LV2_ATOM__String);
+		*flags = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+		return it->second.c_str ();
+	}
+
+	static bool readFile (const std::string& path, std::string& text)
+	{
+		std::ifstream file (path);
+		if (!file)
+		{
+			fprintf (stderr, "BSEQuencer: Can't open %s.\n", path.c_str ());
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << file.rdbuf ();
+		text = buffer.str ();
+		return true;
+	}
+
+	// Returns the quoted string following key at or after pos
+	static std::string getQuoted (const std::string& text, const std::string& key, size_t pos, size_t end = std::string::npos)
+	{
+		size_t keyPos = text.find (key, pos);
+		if ((keyPos == std::string::npos) || (keyPos >= end)) return "";
+		size_t start = text.find ('"', keyPos + key.size ());
+		if (start == std::string::npos) return "";
+		size_t stop = text.find ('"', start + 1);
+		if (stop == std::string::npos) return "";
+		return text.substr (start + 1, stop - start - 1);
+	}
+
+	// Returns the number following key at or after pos
+	static bool getNumber (const std::string& text, const std::string& key, size_t pos, size_t end, float* value)
+	{
+		size_t keyPos = text.find (key, pos);
+		if ((keyPos == std::string::npos) || (keyPos >= end)) return false;
+		*value = atof (text.c_str () + keyPos + key.size ());
+		return true;
+	}
+};
+
+#endif /* TOOLHOST_HPP_ */
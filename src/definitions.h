@@ -32,7 +32,31 @@
 #define AUTOPLAY_KEY 128
 #define ALL_CH 0xFF
 #define HALT_STEP 1000
+#define TICKS_PER_STEP 12
+#define MAX_ROW_MULTIPLIER 4
+#define MAX_ROW_DIVIDER 8
+#define NR_PATTERNS 16
+#define NO_PATTERN -1
+#define NR_GROOVES 5
+#define MAX_RATCHETS 8
+#define MAX_CONDITION_LOOPS 8
+#define NR_CONDITIONS 42
+#define COND_LOOP(a, b) ((b) * ((b) - 1) / 2 - 1 + (a))	// Condition index of "play in loop a of b loops"
+#define COND_BIT(cond) (uint64_t (1) << ((cond) - 1))
+#define NO_AUTOMATION_VALUE -1.0f
+#define MIN_AUTOMATION_RATE 10
+#define MAX_AUTOMATION_RATE 1000
+#define MAX_BANK_PRESETS 128
+#define PADMESSAGE_BYTES_PER_CYCLE 4096	// Default max. pad notification payload sent to the GUI per cycle
+#define PADMESSAGE_BYTES_PER_CYCLE_OPTION BSEQUENCER_URI "#padMessageBytesPerCycle"
+enum PadSyncIndex
+{
+	PAD_SYNC_BEGIN		= 0,
+	PAD_SYNC_COMPLETE	= 1
+};
+
 #define BSEQUENCER_URI "https://www.jahnichen.de/plugins/lv2/BSEQuencer"
+#define BSEQUENCER_MULTIOUT_URI "https://www.jahnichen.de/plugins/lv2/BSEQuencerMultiOut"
 #define BSEQUENCER_GUI_URI "https://www.jahnichen.de/plugins/lv2/BSEQuencer#gui"
 
 #ifndef LIMIT
@@ -56,6 +80,58 @@ typedef enum {
 	ON_KEY_CONTINUE	= 1
 } OnKeyIndex;
 
+typedef enum {
+	SWITCH_STEP	= 0,
+	SWITCH_BAR	= 1,
+	SWITCH_CUT	= 2
+} PatternSwitchIndex;
+
+typedef enum {
+	SELECT_OFF		= 0,
+	SELECT_PROGRAM		= 1,
+	SELECT_KEYS		= 2,
+	SELECT_PROGRAM_KEYS	= 3,
+	SELECT_PRESET		= 4,	// Program change selects a bank preset
+	SELECT_PRESET_KEYS	= 5
+} PatternSelectIndex;
+
+#define SELECT_BY_PROGRAM(select) (((select) == SELECT_PROGRAM) || ((select) == SELECT_PROGRAM_KEYS))
+#define SELECT_BY_KEYS(select) (((select) == SELECT_KEYS) || ((select) == SELECT_PROGRAM_KEYS) || ((select) == SELECT_PRESET_KEYS))
+#define SELECT_BY_PRESET(select) (((select) == SELECT_PRESET) || ((select) == SELECT_PRESET_KEYS))
+
+typedef enum {
+	GROOVE_OFF	= 0,
+	GROOVE_SHUFFLE	= 1,
+	GROOVE_LAID_BACK= 2,
+	GROOVE_PUSH	= 3,
+	GROOVE_USER	= 4
+} GrooveIndex;
+
+// Pad conditions: COND_NONE, COND_LOOP (1, 2) ... COND_LOOP (8, 8), followed by
+// the special conditions
+typedef enum {
+	COND_NONE	= 0,
+	COND_FIRST	= 36,
+	COND_NOT_FIRST	= 37,
+	COND_FILL	= 38,
+	COND_NOT_FILL	= 39,
+	COND_PRE	= 40,
+	COND_NOT_PRE	= 41
+} ConditionIndex;
+
+typedef enum {
+	AUTOMATION_OFF		= 0,
+	AUTOMATION_CC		= 1,
+	AUTOMATION_PITCH_BEND	= 2,
+	AUTOMATION_AFTERTOUCH	= 3
+} AutomationIndex;
+
+typedef enum {
+	INTERPOLATION_STEP	= 0,
+	INTERPOLATION_LINEAR	= 1,
+	INTERPOLATION_EXP	= 2
+} InterpolationIndex;
+
 typedef enum {
 	Chromatic	= 1,
 	Major		= 2,
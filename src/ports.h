@@ -37,7 +37,31 @@ typedef enum {
 	NOTE_OFFSET		= 3,
 	CH_SIZE			= 4,
 
-	KNOBS_SIZE		= CH + 4 * CH_SIZE
+	PATTERN			= CH + 4 * CH_SIZE,
+	PATTERN_SWITCH		= PATTERN + 1,
+	PATTERN_SELECT		= PATTERN + 2,
+	PATTERN_KEYS		= PATTERN + 3,
+
+	RECORD			= PATTERN_KEYS + 1,
+
+	SWING			= RECORD + 1,
+	GROOVE			= RECORD + 2,
+
+	SELECTION_RATCHET	= GROOVE + 1,
+	SELECTION_RATCHET_CURVE	= GROOVE + 2,
+	SELECTION_CONDITION	= GROOVE + 3,
+
+	FILL			= SELECTION_CONDITION + 1,
+
+	PRESET			= FILL + 1,
+
+	KNOBS_SIZE		= PRESET + 1,
+
+	// Plugin to GUI communication
+	NOTIFY			= KNOBS + KNOBS_SIZE,
+
+	// MultiOut variant only: One MIDI output port for each sequencer channel
+	MIDI_OUT		= NOTIFY + 1
 } PortIndex;
 
 #endif /* PORTS_H_ */
@@ -9,6 +9,7 @@
 #include <lv2/lv2plug.in/ns/ext/time/time.h>
 #include <lv2/lv2plug.in/ns/ext/midi/midi.h>
 #include <lv2/lv2plug.in/ns/ext/state/state.h>
+#include <lv2/lv2plug.in/ns/ext/patch/patch.h>
 
 typedef struct
 {
@@ -22,7 +23,12 @@ typedef struct
 	LV2_URID atom_Vector;
 	LV2_URID atom_Long;
 	LV2_URID atom_String;
+	LV2_URID atom_Path;
+	LV2_URID atom_URID;
 	LV2_URID midi_Event;
+	LV2_URID patch_Set;
+	LV2_URID patch_property;
+	LV2_URID patch_value;
 	LV2_URID time_Position;
 	LV2_URID time_bar;
 	LV2_URID time_barBeat;
@@ -34,12 +40,28 @@ typedef struct
 	LV2_URID ui_off;
 	LV2_URID state_pad;
 	LV2_URID state_scales;
+	LV2_URID state_rows;
+	LV2_URID state_patterns;
+	LV2_URID state_groove;
+	LV2_URID state_automation;
+	LV2_URID bankFile;
 	LV2_URID notify_padEvent;
 	LV2_URID notify_pad;
+	LV2_URID notify_padSyncEvent;
+	LV2_URID notify_padSync;
+	LV2_URID notify_rowEvent;
+	LV2_URID notify_row;
+	LV2_URID notify_chainEvent;
+	LV2_URID notify_chain;
+	LV2_URID notify_automationEvent;
+	LV2_URID notify_automation;
+	LV2_URID notify_controllersEvent;
+	LV2_URID notify_controllers;
 	LV2_URID notify_statusEvent;
 	LV2_URID notify_cursors;
 	LV2_URID notify_notes;
 	LV2_URID notify_channels;
+	LV2_URID notify_pattern;
 	LV2_URID notify_scaleMapsEvent;
 	LV2_URID notify_scaleID;
 	LV2_URID notify_scaleName;
@@ -60,7 +82,12 @@ void getURIs (LV2_URID_Map* m, BSEQuencerURIs* uris)
 	uris->atom_Vector = m->map(m->handle, LV2_ATOM__Vector);
 	uris->atom_Long = m->map (m->handle, LV2_ATOM__Long);
 	uris->atom_String = m->map (m->handle, LV2_ATOM__String);
+	uris->atom_Path = m->map (m->handle, LV2_ATOM__Path);
+	uris->atom_URID = m->map (m->handle, LV2_ATOM__URID);
 	uris->midi_Event = m->map(m->handle, LV2_MIDI__MidiEvent);
+	uris->patch_Set = m->map(m->handle, LV2_PATCH__Set);
+	uris->patch_property = m->map(m->handle, LV2_PATCH__property);
+	uris->patch_value = m->map(m->handle, LV2_PATCH__value);
 	uris->time_Position = m->map(m->handle, LV2_TIME__Position);
 	uris->time_bar = m->map(m->handle, LV2_TIME__bar);
 	uris->time_barBeat = m->map(m->handle, LV2_TIME__barBeat);
@@ -72,12 +99,28 @@ void getURIs (LV2_URID_Map* m, BSEQuencerURIs* uris)
 	uris->ui_off = m->map(m->handle, BSEQUENCER_URI "#UIoff");
 	uris->state_pad = m->map(m->handle, BSEQUENCER_URI "#STATEpad");
 	uris->state_scales = m->map(m->handle, BSEQUENCER_URI "#STATEscales");
+	uris->state_rows = m->map(m->handle, BSEQUENCER_URI "#STATErows");
+	uris->state_patterns = m->map(m->handle, BSEQUENCER_URI "#STATEpatterns");
+	uris->state_groove = m->map(m->handle, BSEQUENCER_URI "#STATEgroove");
+	uris->state_automation = m->map(m->handle, BSEQUENCER_URI "#STATEautomation");
+	uris->bankFile = m->map(m->handle, BSEQUENCER_URI "#bankFile");
 	uris->notify_padEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYpadEvent");
 	uris->notify_pad = m->map(m->handle, BSEQUENCER_URI "#NOTIFYpad");
+	uris->notify_padSyncEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYpadSyncEvent");
+	uris->notify_padSync = m->map(m->handle, BSEQUENCER_URI "#NOTIFYpadSync");
+	uris->notify_rowEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYrowEvent");
+	uris->notify_row = m->map(m->handle, BSEQUENCER_URI "#NOTIFYrow");
+	uris->notify_chainEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYchainEvent");
+	uris->notify_chain = m->map(m->handle, BSEQUENCER_URI "#NOTIFYchain");
+	uris->notify_automationEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYautomationEvent");
+	uris->notify_automation = m->map(m->handle, BSEQUENCER_URI "#NOTIFYautomation");
+	uris->notify_controllersEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYcontrollersEvent");
+	uris->notify_controllers = m->map(m->handle, BSEQUENCER_URI "#NOTIFYcontrollers");
 	uris->notify_statusEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYstatusEvent");
 	uris->notify_cursors = m->map(m->handle, BSEQUENCER_URI "#NOTIFYcursors");
 	uris->notify_notes = m->map(m->handle, BSEQUENCER_URI "#NOTIFYnotes");
 	uris->notify_channels = m->map(m->handle, BSEQUENCER_URI "#NOTIFYchannels");
+	uris->notify_pattern = m->map(m->handle, BSEQUENCER_URI "#NOTIFYpattern");
 	uris->notify_scaleMapsEvent = m->map(m->handle, BSEQUENCER_URI "#NOTIFYscaleMapsEvent");
 	uris->notify_scaleID = m->map(m->handle, BSEQUENCER_URI "#NOTIFYscaleID");
 	uris->notify_scaleName = m->map(m->handle, BSEQUENCER_URI "#NOTIFYscaleName");